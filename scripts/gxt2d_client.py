@@ -0,0 +1,115 @@
+import sys
+import time
+import socket
+import struct
+
+# Looks up hashes or labels in a running gxt2d, see src/gxt/daemon.h for the protocol.
+#
+#   python gxt2d_client.py <socket> <language> [0xHASH | LABEL ...]
+#   python gxt2d_client.py <socket> <language> /bench:<rounds> [0xHASH | LABEL ...]
+#
+# Integers are in host byte order, the daemon only listens on a local socket.
+
+OP_LANGUAGES = 1
+OP_LOOKUP_HASH = 2
+OP_LOOKUP_LABEL = 3
+
+STATUS_OK = 0
+NOT_FOUND = 0xFFFFFFFF
+
+def receive_exactly(sock, size):
+    data = b''
+    while len(data) < size:
+        chunk = sock.recv(size - len(data))
+        if not chunk:
+            raise ConnectionError('gxt2d closed the connection')
+        data += chunk
+    return data
+
+def request(sock, op, payload=b''):
+    sock.sendall(struct.pack('=IB', len(payload) + 1, op) + payload)
+    length, = struct.unpack('=I', receive_exactly(sock, 4))
+    response = receive_exactly(sock, length)
+    if response[0] != STATUS_OK:
+        raise RuntimeError(f'gxt2d answered with status {response[0]}')
+    return response[1:]
+
+def get_languages(sock):
+    response = request(sock, OP_LANGUAGES)
+    count, = struct.unpack_from('=H', response, 0)
+    languages = []
+    offset = 2
+    for _ in range(count):
+        length, = struct.unpack_from('=H', response, offset)
+        languages.append(response[offset + 2:offset + 2 + length].decode('utf-8'))
+        offset += 2 + length
+    return languages
+
+def lookup(sock, language, keys):
+    # Hashes and labels go out as separate batches, the answers come back in the order of the keys
+    hashes = [key for key in keys if key.lower().startswith('0x')]
+    labels = [key for key in keys if not key.lower().startswith('0x')]
+
+    texts = {}
+    if hashes:
+        payload = struct.pack('=I', len(hashes)) + b''.join(struct.pack('=HI', language, int(key, 16)) for key in hashes)
+        texts.update(zip(hashes, read_texts(request(sock, OP_LOOKUP_HASH, payload))))
+    if labels:
+        payload = struct.pack('=I', len(labels))
+        for label in labels:
+            encoded = label.encode('utf-8')
+            payload += struct.pack('=HH', language, len(encoded)) + encoded
+        texts.update(zip(labels, read_texts(request(sock, OP_LOOKUP_LABEL, payload))))
+    return [texts[key] for key in keys]
+
+def read_texts(response):
+    count, = struct.unpack_from('=I', response, 0)
+    texts = []
+    offset = 4
+    for _ in range(count):
+        length, = struct.unpack_from('=I', response, offset)
+        offset += 4
+        if length == NOT_FOUND:
+            texts.append(None)
+            continue
+        texts.append(response[offset:offset + length].decode('utf-8', 'replace'))
+        offset += length
+    return texts
+
+def main():
+    if len(sys.argv) < 3:
+        print(f'Usage: {sys.argv[0]} <socket> <language> [/bench:<rounds>] [0xHASH | LABEL ...]')
+        return 1
+
+    rounds = 0
+    keys = []
+    for arg in sys.argv[3:]:
+        if arg.startswith('/bench:'):
+            rounds = int(arg[7:])
+        else:
+            keys.append(arg)
+
+    with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as sock:
+        sock.connect(sys.argv[1])
+
+        languages = get_languages(sock)
+        if sys.argv[2] not in languages:
+            print(f'Error: {sys.argv[2]} is not served, available: {" ".join(languages)}')
+            return 1
+        language = languages.index(sys.argv[2])
+
+        if rounds > 0:
+            # Round trips of the whole batch, the time includes this client
+            start = time.perf_counter()
+            for _ in range(rounds):
+                lookup(sock, language, keys)
+            elapsed = time.perf_counter() - start
+            print(f'{rounds} batches of {len(keys)} keys, {elapsed * 1e6 / rounds:.1f} us per batch')
+            return 0
+
+        for key, text in zip(keys, lookup(sock, language, keys)):
+            print(f'{key}\t{text if text is not None else "<not found>"}')
+    return 0
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,451 @@
+//
+//	core/gxt2core.cpp
+//
+
+// Project
+#include "gxt2core.h"
+#include "gxt/gxt2.h"
+#include "gxt/convert.h"
+#include "gxt/merge.h"
+#include "data/stringhash.h"
+#include "main/main.h"
+
+// C/C++
+#include <new>
+#include <string>
+#include <cstdlib>
+#include <stdexcept>
+
+struct gxt2_table
+{
+	CMemoryFile m_Table;
+};
+
+struct gxt2_iterator
+{
+	CFile::Map::const_iterator m_Current;
+	CFile::Map::const_iterator m_End;
+};
+
+// The C enums are passed straight through to the C++ side
+static_assert(static_cast<int>(GXT2_FORMAT_GXT2) == CMemoryFile::FORMAT_GXT2 && static_cast<int>(GXT2_FORMAT_LABELS) == CMemoryFile::FORMAT_LABELS);
+static_assert(static_cast<int>(GXT2_ENDIAN_LITTLE) == CFile::_LITTLE_ENDIAN && static_cast<int>(GXT2_ENDIAN_BIG) == CFile::_BIG_ENDIAN);
+
+namespace
+{
+	thread_local std::string g_LastError;
+
+	// Exceptions must never cross the C boundary
+	template<typename Func>
+	gxt2_result Guard(gxt2_result failure, Func&& func)
+	{
+		try
+		{
+			return func();
+		}
+		catch (const std::invalid_argument& e)
+		{
+			g_LastError = e.what();
+			return GXT2_ERROR_INVALID_ARGUMENT;
+		}
+		catch (const std::bad_alloc&)
+		{
+			g_LastError = "Out of memory.";
+			return GXT2_ERROR_INTERNAL;
+		}
+		catch (const std::exception& e)
+		{
+			g_LastError = e.what();
+			return failure;
+		}
+		catch (...)
+		{
+			g_LastError = "Unknown error.";
+			return GXT2_ERROR_INTERNAL;
+		}
+	}
+
+	gxt2_result Fail(gxt2_result result, const char* szMessage)
+	{
+		g_LastError = szMessage;
+		return result;
+	}
+
+	// Anything else would reach the GXT2 writer and leave out the magic
+	bool IsValidEndian(gxt2_endian endian)
+	{
+		return endian == GXT2_ENDIAN_LITTLE || endian == GXT2_ENDIAN_BIG;
+	}
+
+	int ResolveFormat(const char* szPath, gxt2_format format)
+	{
+		return (format == GXT2_FORMAT_AUTO) ? CMemoryFile::GetFormatFromExtension(szPath) : format;
+	}
+
+	CFile* CreateCodec(const char* szPath, int format, bool bWrite, int endian)
+	{
+		switch (format)
+		{
+		case CMemoryFile::FORMAT_GXT2:
+			return GXT_NEW CGxt2File(szPath, bWrite ? CFile::FLAGS_WRITE_COMPILED : CFile::FLAGS_READ_COMPILED, endian);
+		case CMemoryFile::FORMAT_TXT:
+			return GXT_NEW CTextFile(szPath, bWrite ? CFile::FLAGS_WRITE_DECOMPILED : CFile::FLAGS_READ_DECOMPILED);
+		case CMemoryFile::FORMAT_JSON:
+			return GXT_NEW CJsonFile(szPath, bWrite ? CFile::FLAGS_WRITE_DECOMPILED : CFile::FLAGS_READ_DECOMPILED);
+		case CMemoryFile::FORMAT_CSV:
+			return GXT_NEW CCsvFile(szPath, bWrite ? CFile::FLAGS_WRITE_DECOMPILED : CFile::FLAGS_READ_DECOMPILED);
+		case CMemoryFile::FORMAT_OXT:
+			return GXT_NEW COxtFile(szPath, bWrite ? CFile::FLAGS_WRITE_DECOMPILED : CFile::FLAGS_READ_DECOMPILED);
+		case CMemoryFile::FORMAT_LABELS:
+			return GXT_NEW CHashDatabase(szPath, bWrite ? CFile::FLAGS_WRITE_DECOMPILED : CFile::FLAGS_READ_DECOMPILED);
+		default:
+			throw std::invalid_argument("Unknown file format.");
+		}
+	}
+
+	// Lets a codec serialize the table without copying or sharing it,
+	// the aliasing shared_ptr owns nothing.
+	CFile::SharedMap ViewData(const gxt2_table* pTable)
+	{
+		return CFile::SharedMap(CFile::SharedMap(), &pTable->m_Table.GetDataConst());
+	}
+}
+
+unsigned int gxt2_api_version(void)
+{
+	return GXT2_API_VERSION;
+}
+
+const char* gxt2_last_error(void)
+{
+	return g_LastError.c_str();
+}
+
+void gxt2_free(void* pData)
+{
+	free(pData);
+}
+
+//---------------- Hashing ----------------
+//
+uint32_t gxt2_hash(const char* szString)
+{
+	return szString ? rage::atStringHash(szString) : 0;
+}
+
+uint32_t gxt2_hash_partial(const char* szString)
+{
+	return szString ? rage::atPartialStringHash(szString) : 0;
+}
+
+uint32_t gxt2_hash_finalize(uint32_t uHash)
+{
+	return rage::atFinalizeHash(uHash);
+}
+
+//---------------- Tables ----------------
+//
+gxt2_result gxt2_table_create(gxt2_table** ppTable)
+{
+	if (!ppTable)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No table pointer given.");
+	}
+
+	return Guard(GXT2_ERROR_INTERNAL, [&]()
+	{
+		*ppTable = GXT_NEW gxt2_table;
+		return GXT2_OK;
+	});
+}
+
+gxt2_result gxt2_table_open(const char* szPath, gxt2_format format, gxt2_table** ppTable)
+{
+	if (!szPath || !ppTable)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No path or table pointer given.");
+	}
+	*ppTable = nullptr;
+
+	CFile* pFile = nullptr;
+	gxt2_result result = Guard(GXT2_ERROR_OPEN, [&]()
+	{
+		pFile = CreateCodec(szPath, ResolveFormat(szPath, format), false, CFile::_LITTLE_ENDIAN);
+		return GXT2_OK;
+	});
+
+	if (result == GXT2_OK)
+	{
+		result = Guard(GXT2_ERROR_READ, [&]()
+		{
+			if (!pFile->ReadEntries())
+			{
+				return Fail(GXT2_ERROR_READ, "Failed to read content.");
+			}
+
+			gxt2_table* pTable = GXT_NEW gxt2_table;
+			pTable->m_Table.SetEndian(pFile->GetEndian());
+			pTable->m_Table.SetData(pFile->TakeData());
+			*ppTable = pTable;
+			return GXT2_OK;
+		});
+	}
+
+	delete pFile;
+	return result;
+}
+
+gxt2_result gxt2_table_decode(const void* pData, size_t size, gxt2_format format, gxt2_table** ppTable)
+{
+	if ((!pData && size) || !ppTable || format == GXT2_FORMAT_AUTO)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No data, format or table pointer given.");
+	}
+	*ppTable = nullptr;
+
+	return Guard(GXT2_ERROR_READ, [&]()
+	{
+		CMemoryFile memoryFile(format, std::span<const char>(static_cast<const char*>(pData), size));
+		if (!memoryFile.ReadEntries())
+		{
+			return Fail(GXT2_ERROR_READ, "Failed to read content.");
+		}
+
+		gxt2_table* pTable = GXT_NEW gxt2_table;
+		pTable->m_Table.SetEndian(memoryFile.GetEndian());
+		pTable->m_Table.SetData(memoryFile.TakeData());
+		*ppTable = pTable;
+		return GXT2_OK;
+	});
+}
+
+void gxt2_table_free(gxt2_table* pTable)
+{
+	delete pTable;
+}
+
+size_t gxt2_table_size(const gxt2_table* pTable)
+{
+	return pTable ? pTable->m_Table.GetDataConst().size() : 0;
+}
+
+gxt2_endian gxt2_table_endian(const gxt2_table* pTable)
+{
+	return (pTable && pTable->m_Table.IsBigEndian()) ? GXT2_ENDIAN_BIG : GXT2_ENDIAN_LITTLE;
+}
+
+void gxt2_table_set_endian(gxt2_table* pTable, gxt2_endian endian)
+{
+	if (pTable && IsValidEndian(endian))
+	{
+		pTable->m_Table.SetEndian(endian);
+	}
+}
+
+const char* gxt2_table_find(const gxt2_table* pTable, uint32_t uHash)
+{
+	if (!pTable)
+	{
+		return nullptr;
+	}
+
+	const CFile::Map& entries = pTable->m_Table.GetDataConst();
+	if (auto it = entries.find(uHash); it != entries.end())
+	{
+		return it->second.c_str();
+	}
+	return nullptr;
+}
+
+gxt2_result gxt2_table_set(gxt2_table* pTable, uint32_t uHash, const char* szText)
+{
+	if (!pTable || !szText)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No table or text given.");
+	}
+
+	return Guard(GXT2_ERROR_INTERNAL, [&]()
+	{
+		pTable->m_Table.GetData().insert_or_assign(uHash, szText);
+		return GXT2_OK;
+	});
+}
+
+gxt2_result gxt2_table_remove(gxt2_table* pTable, uint32_t uHash)
+{
+	if (!pTable)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No table given.");
+	}
+
+	if (pTable->m_Table.GetData().erase(uHash) == 0)
+	{
+		return Fail(GXT2_ERROR_NOT_FOUND, "Hash not found.");
+	}
+	return GXT2_OK;
+}
+
+gxt2_result gxt2_table_merge(gxt2_table* pTarget, const gxt2_table* pSource)
+{
+	if (!pTarget || !pSource)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No target or source table given.");
+	}
+
+	return Guard(GXT2_ERROR_INTERNAL, [&]()
+	{
+		pTarget->m_Table.SetData(pSource->m_Table.GetDataConst());
+		return GXT2_OK;
+	});
+}
+
+gxt2_result gxt2_table_save(const gxt2_table* pTable, const char* szPath, gxt2_format format)
+{
+	if (!pTable || !szPath)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No table or path given.");
+	}
+
+	CFile* pFile = nullptr;
+	gxt2_result result = Guard(GXT2_ERROR_OPEN, [&]()
+	{
+		pFile = CreateCodec(szPath, ResolveFormat(szPath, format), true, pTable->m_Table.GetEndian());
+		return GXT2_OK;
+	});
+
+	if (result == GXT2_OK)
+	{
+		result = Guard(GXT2_ERROR_WRITE, [&]()
+		{
+			pFile->SetData(ViewData(pTable));
+			return pFile->WriteEntries() ? GXT2_OK : Fail(GXT2_ERROR_WRITE, "Failed to save content.");
+		});
+	}
+
+	delete pFile;
+	return result;
+}
+
+gxt2_result gxt2_table_encode(const gxt2_table* pTable, gxt2_format format, void** ppData, size_t* pSize)
+{
+	if (!pTable || !ppData || !pSize || format == GXT2_FORMAT_AUTO)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No table, format or output given.");
+	}
+	*ppData = nullptr;
+	*pSize = 0;
+
+	return Guard(GXT2_ERROR_WRITE, [&]()
+	{
+		std::string szOutput;
+
+		CMemoryFile memoryFile(format, szOutput, pTable->m_Table.GetEndian());
+		memoryFile.SetData(ViewData(pTable));
+		if (!memoryFile.WriteEntries())
+		{
+			return Fail(GXT2_ERROR_WRITE, "Failed to save content.");
+		}
+
+		// Handed to C callers, so it has to come from malloc
+		void* pData = malloc(szOutput.size() ? szOutput.size() : 1);
+		if (!pData)
+		{
+			return Fail(GXT2_ERROR_INTERNAL, "Out of memory.");
+		}
+		memcpy(pData, szOutput.data(), szOutput.size());
+
+		*ppData = pData;
+		*pSize = szOutput.size();
+		return GXT2_OK;
+	});
+}
+
+//---------------- Iteration ----------------
+//
+gxt2_result gxt2_iterator_create(const gxt2_table* pTable, gxt2_iterator** ppIterator)
+{
+	if (!pTable || !ppIterator)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No table or iterator pointer given.");
+	}
+
+	return Guard(GXT2_ERROR_INTERNAL, [&]()
+	{
+		const CFile::Map& entries = pTable->m_Table.GetDataConst();
+		*ppIterator = GXT_NEW gxt2_iterator{ entries.begin(), entries.end() };
+		return GXT2_OK;
+	});
+}
+
+int gxt2_iterator_next(gxt2_iterator* pIterator, uint32_t* pHash, const char** pText)
+{
+	if (!pIterator || pIterator->m_Current == pIterator->m_End)
+	{
+		return 0;
+	}
+
+	if (pHash)
+	{
+		*pHash = pIterator->m_Current->first;
+	}
+	if (pText)
+	{
+		*pText = pIterator->m_Current->second.c_str();
+	}
+	++pIterator->m_Current;
+	return 1;
+}
+
+void gxt2_iterator_free(gxt2_iterator* pIterator)
+{
+	delete pIterator;
+}
+
+//---------------- Files ----------------
+//
+gxt2_result gxt2_convert(const char* szInput, const char* szOutput, gxt2_endian endian)
+{
+	if (!szInput || !szOutput)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No input or output given.");
+	}
+	if (!IsValidEndian(endian))
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "Unknown byte order given.");
+	}
+
+	// A missing input or an output that cannot be created is an open failure, not a write one
+	CConverter* pConverter = nullptr;
+	gxt2_result result = Guard(GXT2_ERROR_OPEN, [&]()
+	{
+		pConverter = GXT_NEW CConverter(szInput, false);
+		pConverter->AddOutput(szOutput, endian);
+		return GXT2_OK;
+	});
+
+	if (result == GXT2_OK)
+	{
+		result = Guard(GXT2_ERROR_WRITE, [&]()
+		{
+			pConverter->Convert();
+			return GXT2_OK;
+		});
+	}
+
+	delete pConverter;
+	return result;
+}
+
+gxt2_result gxt2_merge(const char* szFile1, const char* szFile2, const char* szOutput)
+{
+	if (!szFile1 || !szFile2 || !szOutput)
+	{
+		return Fail(GXT2_ERROR_INVALID_ARGUMENT, "No inputs or output given.");
+	}
+
+	return Guard(GXT2_ERROR_OPEN, [&]()
+	{
+		CMerger gxtMerger(szFile1, szFile2, szOutput);
+		return gxtMerger.Run() ? GXT2_OK : Fail(GXT2_ERROR_READ, "Failed to merge content.");
+	});
+}
@@ -0,0 +1,121 @@
+//
+//	core/gxt2core.h
+//
+
+#ifndef _GXT2CORE_H_
+#define _GXT2CORE_H_
+
+// C/C++
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(GXT2_CORE_SHARED)
+	#if defined(_WIN32)
+		#if defined(GXT2_CORE_EXPORTS)
+			#define GXT2_API __declspec(dllexport)
+		#else
+			#define GXT2_API __declspec(dllimport)
+		#endif // GXT2_CORE_EXPORTS
+	#else
+		#define GXT2_API __attribute__((visibility("default")))
+	#endif // _WIN32
+#else
+	#define GXT2_API
+#endif // GXT2_CORE_SHARED
+
+// Bumped whenever a function is added, existing signatures never change
+#define GXT2_API_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+typedef struct gxt2_table gxt2_table;
+typedef struct gxt2_iterator gxt2_iterator;
+
+typedef enum gxt2_result
+{
+	GXT2_OK = 0,
+	GXT2_ERROR_INVALID_ARGUMENT,
+	GXT2_ERROR_OPEN,
+	GXT2_ERROR_READ,
+	GXT2_ERROR_WRITE,
+	GXT2_ERROR_NOT_FOUND,
+	GXT2_ERROR_INTERNAL
+} gxt2_result;
+
+typedef enum gxt2_format
+{
+	GXT2_FORMAT_AUTO = 0, // from the file extension
+	GXT2_FORMAT_GXT2,
+	GXT2_FORMAT_TXT,
+	GXT2_FORMAT_JSON,
+	GXT2_FORMAT_CSV,
+	GXT2_FORMAT_OXT,
+	GXT2_FORMAT_LABELS
+} gxt2_format;
+
+typedef enum gxt2_endian
+{
+	GXT2_ENDIAN_LITTLE = 1,
+	GXT2_ENDIAN_BIG
+} gxt2_endian;
+
+GXT2_API unsigned int gxt2_api_version(void);
+
+// Message of the last failed call on the calling thread, never NULL
+GXT2_API const char* gxt2_last_error(void);
+
+// Releases buffers returned by gxt2_table_encode()
+GXT2_API void gxt2_free(void* pData);
+
+//---------------- Hashing ----------------
+//
+GXT2_API uint32_t gxt2_hash(const char* szString);
+GXT2_API uint32_t gxt2_hash_partial(const char* szString);
+GXT2_API uint32_t gxt2_hash_finalize(uint32_t uHash);
+
+//---------------- Tables ----------------
+//
+GXT2_API gxt2_result gxt2_table_create(gxt2_table** ppTable);
+GXT2_API gxt2_result gxt2_table_open(const char* szPath, gxt2_format format, gxt2_table** ppTable);
+GXT2_API gxt2_result gxt2_table_decode(const void* pData, size_t size, gxt2_format format, gxt2_table** ppTable);
+GXT2_API void gxt2_table_free(gxt2_table* pTable);
+
+GXT2_API size_t gxt2_table_size(const gxt2_table* pTable);
+GXT2_API gxt2_endian gxt2_table_endian(const gxt2_table* pTable);
+// Anything but GXT2_ENDIAN_LITTLE or GXT2_ENDIAN_BIG leaves the table as it is
+GXT2_API void gxt2_table_set_endian(gxt2_table* pTable, gxt2_endian endian);
+
+// The returned text belongs to the table and stays valid until the entry
+// is changed or removed, NULL if the hash is not in the table.
+GXT2_API const char* gxt2_table_find(const gxt2_table* pTable, uint32_t uHash);
+GXT2_API gxt2_result gxt2_table_set(gxt2_table* pTable, uint32_t uHash, const char* szText);
+GXT2_API gxt2_result gxt2_table_remove(gxt2_table* pTable, uint32_t uHash);
+
+// Entries of pSource override the ones already in pTarget
+GXT2_API gxt2_result gxt2_table_merge(gxt2_table* pTarget, const gxt2_table* pSource);
+
+GXT2_API gxt2_result gxt2_table_save(const gxt2_table* pTable, const char* szPath, gxt2_format format);
+// *ppData must be released with gxt2_free()
+GXT2_API gxt2_result gxt2_table_encode(const gxt2_table* pTable, gxt2_format format, void** ppData, size_t* pSize);
+
+//---------------- Iteration ----------------
+//
+// Walks the entries in ascending hash order, the table must not be
+// modified while an iterator is alive.
+GXT2_API gxt2_result gxt2_iterator_create(const gxt2_table* pTable, gxt2_iterator** ppIterator);
+GXT2_API int gxt2_iterator_next(gxt2_iterator* pIterator, uint32_t* pHash, const char** pText);
+GXT2_API void gxt2_iterator_free(gxt2_iterator* pIterator);
+
+//---------------- Files ----------------
+//
+// Same as gxt2conv and gxt2merge, without spawning them
+GXT2_API gxt2_result gxt2_convert(const char* szInput, const char* szOutput, gxt2_endian endian);
+GXT2_API gxt2_result gxt2_merge(const char* szFile1, const char* szFile2, const char* szOutput);
+
+#ifdef __cplusplus
+}
+#endif // __cplusplus
+
+#endif // !_GXT2CORE_H_
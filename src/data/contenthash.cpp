@@ -0,0 +1,113 @@
+//
+//	data/contenthash.cpp
+//
+
+#include "contenthash.h"
+
+// C/C++
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+	constexpr uint64_t PRIME64_1 = 0x9E3779B185EBCA87ull;
+	constexpr uint64_t PRIME64_2 = 0xC2B2AE3D27D4EB4Full;
+	constexpr uint64_t PRIME64_3 = 0x165667B19E3779F9ull;
+	constexpr uint64_t PRIME64_4 = 0x85EBCA77C2B2AE63ull;
+	constexpr uint64_t PRIME64_5 = 0x27D4EB2F165667C5ull;
+
+	uint64_t RotateLeft(uint64_t uValue, int shift)
+	{
+		return (uValue << shift) | (uValue >> (64 - shift));
+	}
+
+	// Input is read as little endian like the reference implementation, the
+	// fingerprints stay comparable between machines sharing a cache
+	uint64_t Read64(const unsigned char* pData)
+	{
+		uint64_t uValue = 0;
+		for (int i = 7; i >= 0; i--)
+		{
+			uValue = (uValue << 8) | pData[i];
+		}
+		return uValue;
+	}
+
+	uint32_t Read32(const unsigned char* pData)
+	{
+		return static_cast<uint32_t>(pData[0]) | (static_cast<uint32_t>(pData[1]) << 8) | (static_cast<uint32_t>(pData[2]) << 16) | (static_cast<uint32_t>(pData[3]) << 24);
+	}
+
+	uint64_t Round(uint64_t uAccumulator, uint64_t uInput)
+	{
+		uAccumulator += uInput * PRIME64_2;
+		uAccumulator = RotateLeft(uAccumulator, 31);
+		return uAccumulator * PRIME64_1;
+	}
+
+	uint64_t MergeRound(uint64_t uAccumulator, uint64_t uValue)
+	{
+		uAccumulator ^= Round(0, uValue);
+		return uAccumulator * PRIME64_1 + PRIME64_4;
+	}
+}
+
+unsigned long long HashContent(std::span<const char> data, unsigned long long uSeed /*= 0*/)
+{
+	const unsigned char* pData = reinterpret_cast<const unsigned char*>(data.data());
+	const unsigned char* pEnd = pData + data.size();
+	uint64_t uHash = 0;
+
+	if (data.size() >= 32)
+	{
+		// Four independent lanes, the multiplies of one round overlap with the next
+		uint64_t v1 = uSeed + PRIME64_1 + PRIME64_2;
+		uint64_t v2 = uSeed + PRIME64_2;
+		uint64_t v3 = uSeed;
+		uint64_t v4 = uSeed - PRIME64_1;
+
+		for (const unsigned char* pLimit = pEnd - 32; pData <= pLimit; pData += 32)
+		{
+			v1 = Round(v1, Read64(pData));
+			v2 = Round(v2, Read64(pData + 8));
+			v3 = Round(v3, Read64(pData + 16));
+			v4 = Round(v4, Read64(pData + 24));
+		}
+
+		uHash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		uHash = MergeRound(uHash, v1);
+		uHash = MergeRound(uHash, v2);
+		uHash = MergeRound(uHash, v3);
+		uHash = MergeRound(uHash, v4);
+	}
+	else
+	{
+		uHash = uSeed + PRIME64_5;
+	}
+
+	uHash += static_cast<uint64_t>(data.size());
+
+	for (; pData + 8 <= pEnd; pData += 8)
+	{
+		uHash ^= Round(0, Read64(pData));
+		uHash = RotateLeft(uHash, 27) * PRIME64_1 + PRIME64_4;
+	}
+	if (pData + 4 <= pEnd)
+	{
+		uHash ^= static_cast<uint64_t>(Read32(pData)) * PRIME64_1;
+		uHash = RotateLeft(uHash, 23) * PRIME64_2 + PRIME64_3;
+		pData += 4;
+	}
+	for (; pData < pEnd; pData++)
+	{
+		uHash ^= (*pData) * PRIME64_5;
+		uHash = RotateLeft(uHash, 11) * PRIME64_1;
+	}
+
+	uHash ^= uHash >> 33;
+	uHash *= PRIME64_2;
+	uHash ^= uHash >> 29;
+	uHash *= PRIME64_3;
+	uHash ^= uHash >> 32;
+	return uHash;
+}
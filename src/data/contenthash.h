@@ -0,0 +1,15 @@
+//
+//	data/contenthash.h
+//
+
+#ifndef _CONTENTHASH_H_
+#define _CONTENTHASH_H_
+
+// C/C++
+#include <span>
+
+// XXH64 of a block of memory, fast enough to fingerprint whole files on
+// every run. Not meant for atStringHash lookups, see stringhash.h for those.
+unsigned long long HashContent(std::span<const char> data, unsigned long long uSeed = 0);
+
+#endif // !_CONTENTHASH_H_
@@ -0,0 +1,130 @@
+//
+//	data/hashset.cpp
+//
+
+// Project
+#include "hashset.h"
+
+CHashSet::CHashSet()
+{
+	Clear();
+} // ::CHashSet()
+
+void CHashSet::Clear()
+{
+	m_Size = 0;
+	m_HasZero = false;
+	m_BucketBits = 4;
+	m_BucketMask = (static_cast<size_t>(1) << m_BucketBits) - 1;
+	m_Slots.assign((m_BucketMask + 1) * BUCKET_SIZE, 0);
+} // void ::Clear()
+
+void CHashSet::Reserve(size_t count)
+{
+	// Keep the load factor at or below 50%
+	size_t numBuckets = m_BucketMask + 1;
+	while (numBuckets * BUCKET_SIZE < count * 2)
+	{
+		numBuckets <<= 1;
+	}
+	if (numBuckets != m_BucketMask + 1)
+	{
+		Rehash(numBuckets);
+	}
+} // void ::Reserve(size_t count)
+
+void CHashSet::Insert(unsigned int uHash)
+{
+	if (uHash == 0)
+	{
+		m_Size += m_HasZero ? 0 : 1;
+		m_HasZero = true;
+		return;
+	}
+	if (Contains(uHash))
+	{
+		return;
+	}
+
+	Reserve(m_Size + 1);
+
+	for (size_t uBucket = GetBucket(uHash);; uBucket = (uBucket + 1) & m_BucketMask)
+	{
+		unsigned int* pSlots = &m_Slots[uBucket * BUCKET_SIZE];
+		for (unsigned int i = 0; i < BUCKET_SIZE; i++)
+		{
+			if (pSlots[i] == 0)
+			{
+				pSlots[i] = uHash;
+				m_Size++;
+				return;
+			}
+		}
+	}
+} // void ::Insert(unsigned int uHash)
+
+bool CHashSet::Contains(unsigned int uHash) const
+{
+	if (uHash == 0)
+	{
+		return m_HasZero;
+	}
+
+	for (size_t uBucket = GetBucket(uHash);; uBucket = (uBucket + 1) & m_BucketMask)
+	{
+		const unsigned int* pSlots = &m_Slots[uBucket * BUCKET_SIZE];
+
+		unsigned int uMatch = 0;
+		unsigned int uEmpty = 0;
+		for (unsigned int i = 0; i < BUCKET_SIZE; i++)
+		{
+			uMatch |= (pSlots[i] == uHash);
+			uEmpty |= (pSlots[i] == 0);
+		}
+
+		if (uMatch)
+		{
+			return true;
+		}
+		if (uEmpty)
+		{
+			return false;
+		}
+	}
+} // bool ::Contains(unsigned int uHash) const
+
+size_t CHashSet::GetBucket(unsigned int uHash) const
+{
+	// Fibonacci hashing, spreads neighbouring hashes over the whole table
+	return static_cast<size_t>((uHash * 0x9E3779B1u) >> (32 - m_BucketBits)) & m_BucketMask;
+} // size_t ::GetBucket(unsigned int uHash) const
+
+void CHashSet::Rehash(size_t numBuckets)
+{
+	std::vector<unsigned int> vOldSlots;
+	vOldSlots.swap(m_Slots);
+
+	m_BucketBits = 0;
+	while ((static_cast<size_t>(1) << m_BucketBits) < numBuckets)
+	{
+		m_BucketBits++;
+	}
+	m_BucketMask = numBuckets - 1;
+	m_Slots.assign(numBuckets * BUCKET_SIZE, 0);
+
+	const bool bHasZero = m_HasZero;
+	m_Size = 0;
+	m_HasZero = false;
+
+	for (const unsigned int uHash : vOldSlots)
+	{
+		if (uHash != 0)
+		{
+			Insert(uHash);
+		}
+	}
+	if (bHasZero)
+	{
+		Insert(0);
+	}
+} // void ::Rehash(size_t numBuckets)
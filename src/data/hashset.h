@@ -0,0 +1,40 @@
+//
+//	data/hashset.h
+//
+
+#ifndef _HASHSET_H_
+#define _HASHSET_H_
+
+// C/C++
+#include <vector>
+#include <cstddef>
+
+// Open addressing set of 32-bit hashes. Slots are grouped into buckets of
+// eight so a lookup compares a whole bucket at once without branching per
+// slot, which compilers turn into a couple of vector compares.
+class CHashSet
+{
+public:
+	static constexpr unsigned int BUCKET_SIZE = 8;
+
+	CHashSet();
+
+	void Clear();
+	void Reserve(size_t count);
+	void Insert(unsigned int uHash);
+	bool Contains(unsigned int uHash) const;
+
+	size_t GetSize() const { return m_Size; }
+	bool IsEmpty() const { return m_Size == 0; }
+private:
+	size_t GetBucket(unsigned int uHash) const;
+	void Rehash(size_t numBuckets);
+private:
+	std::vector<unsigned int> m_Slots; // 0 marks an empty slot
+	size_t m_BucketMask;
+	unsigned int m_BucketBits;
+	size_t m_Size;
+	bool m_HasZero;
+};
+
+#endif // !_HASHSET_H_
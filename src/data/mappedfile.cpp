@@ -0,0 +1,117 @@
+//
+//	data/mappedfile.cpp
+//
+
+// Project
+#include "mappedfile.h"
+
+// C/C++
+#include <stdexcept>
+
+#if _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <Windows.h>
+#else
+	// POSIX
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+#if _WIN32
+CMappedFile::CMappedFile(const std::string& fileName) :
+	m_Data(nullptr),
+	m_Size(0),
+	m_File(INVALID_HANDLE_VALUE),
+	m_Mapping(nullptr)
+{
+	m_File = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+	{
+		throw std::runtime_error("Failed to open " + fileName + "!");
+	}
+
+	LARGE_INTEGER size = {};
+	if (!GetFileSizeEx(m_File, &size))
+	{
+		CloseHandle(m_File);
+		throw std::runtime_error("Failed to query the size of " + fileName + "!");
+	}
+	m_Size = static_cast<size_t>(size.QuadPart);
+
+	// Empty files cannot be mapped, they are an empty span instead
+	if (m_Size == 0)
+	{
+		return;
+	}
+
+	m_Mapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	m_Data = m_Mapping ? static_cast<const char*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+	if (!m_Data)
+	{
+		if (m_Mapping)
+		{
+			CloseHandle(m_Mapping);
+		}
+		CloseHandle(m_File);
+		throw std::runtime_error("Failed to map " + fileName + "!");
+	}
+} // ::CMappedFile(const string& fileName)
+
+CMappedFile::~CMappedFile()
+{
+	if (m_Data)
+	{
+		UnmapViewOfFile(m_Data);
+	}
+	if (m_Mapping)
+	{
+		CloseHandle(m_Mapping);
+	}
+	CloseHandle(m_File);
+} // ::~CMappedFile()
+#else
+CMappedFile::CMappedFile(const std::string& fileName) :
+	m_Data(nullptr),
+	m_Size(0)
+{
+	const int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+	{
+		throw std::runtime_error("Failed to open " + fileName + "!");
+	}
+
+	struct stat info = {};
+	if (fstat(fd, &info) != 0)
+	{
+		close(fd);
+		throw std::runtime_error("Failed to query the size of " + fileName + "!");
+	}
+	m_Size = static_cast<size_t>(info.st_size);
+
+	// Empty files cannot be mapped, they are an empty span instead
+	if (m_Size > 0)
+	{
+		void* pData = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (pData == MAP_FAILED)
+		{
+			close(fd);
+			throw std::runtime_error("Failed to map " + fileName + "!");
+		}
+		m_Data = static_cast<const char*>(pData);
+	}
+
+	// The mapping keeps the file referenced on its own
+	close(fd);
+} // ::CMappedFile(const string& fileName)
+
+CMappedFile::~CMappedFile()
+{
+	if (m_Data)
+	{
+		munmap(const_cast<char*>(m_Data), m_Size);
+	}
+} // ::~CMappedFile()
+#endif // _WIN32
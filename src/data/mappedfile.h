@@ -0,0 +1,35 @@
+//
+//	data/mappedfile.h
+//
+
+#ifndef _MAPPEDFILE_H_
+#define _MAPPEDFILE_H_
+
+// C/C++
+#include <span>
+#include <string>
+#include <cstddef>
+
+// Read-only memory mapping of a whole file. Pages are faulted in on first
+// access, so mapping many files only costs what is actually touched.
+class CMappedFile
+{
+public:
+	explicit CMappedFile(const std::string& fileName);
+	~CMappedFile();
+
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile& operator=(const CMappedFile&) = delete;
+
+	std::span<const char> GetData() const { return { m_Data, m_Size }; }
+	size_t GetSize() const { return m_Size; }
+private:
+	const char* m_Data;
+	size_t m_Size;
+#if _WIN32
+	void* m_File;
+	void* m_Mapping;
+#endif
+};
+
+#endif // !_MAPPEDFILE_H_
@@ -0,0 +1,84 @@
+//
+//	data/membuf.cpp
+//
+
+// Project
+#include "membuf.h"
+
+CSpanBuffer::CSpanBuffer(std::span<const char> data)
+{
+	// The get area is never written to, pbackfail() keeps the default
+	char* pData = const_cast<char*>(data.data());
+	setg(pData, pData, pData + data.size());
+} // ::CSpanBuffer(span<const char> data)
+
+CSpanBuffer::pos_type CSpanBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if (dir == std::ios_base::cur)
+	{
+		off += gptr() - eback();
+	}
+	else if (dir == std::ios_base::end)
+	{
+		off += egptr() - eback();
+	}
+	return seekpos(off, which);
+} // pos_type ::seekoff(off_type off, seekdir dir, openmode which)
+
+CSpanBuffer::pos_type CSpanBuffer::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	const off_type off = pos;
+
+	if (!(which & std::ios_base::in) || off < 0 || off > egptr() - eback())
+	{
+		return pos_type(off_type(-1));
+	}
+
+	setg(eback(), eback() + off, egptr());
+	return pos;
+} // pos_type ::seekpos(pos_type pos, openmode which)
+
+//-----------------------------------------------------------------------------------------
+//
+
+CGrowableBuffer::CGrowableBuffer(std::string& output) :
+	m_Output(output),
+	m_Start(output.size())
+{
+} // ::CGrowableBuffer(string& output)
+
+CGrowableBuffer::int_type CGrowableBuffer::overflow(int_type ch)
+{
+	if (!traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		m_Output.push_back(traits_type::to_char_type(ch));
+	}
+	return traits_type::not_eof(ch);
+} // int_type ::overflow(int_type ch)
+
+std::streamsize CGrowableBuffer::xsputn(const char* s, std::streamsize count)
+{
+	m_Output.append(s, static_cast<size_t>(count));
+	return count;
+} // streamsize ::xsputn(const char* s, streamsize count)
+
+CGrowableBuffer::pos_type CGrowableBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	// Only appending is supported, the put position is always the end. tellp() still reports it.
+	if (dir == std::ios_base::cur || dir == std::ios_base::end)
+	{
+		off += static_cast<off_type>(m_Output.size() - m_Start);
+	}
+	return seekpos(off, which);
+} // pos_type ::seekoff(off_type off, seekdir dir, openmode which)
+
+CGrowableBuffer::pos_type CGrowableBuffer::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	const off_type off = pos;
+
+	if (!(which & std::ios_base::out) || off != static_cast<off_type>(m_Output.size() - m_Start))
+	{
+		return pos_type(off_type(-1));
+	}
+	return pos;
+} // pos_type ::seekpos(pos_type pos, openmode which)
@@ -0,0 +1,38 @@
+//
+//	data/membuf.h
+//
+
+#ifndef _MEMBUF_H_
+#define _MEMBUF_H_
+
+// C/C++
+#include <span>
+#include <string>
+#include <streambuf>
+
+// Read-only view over bytes owned by the caller, seekable in both directions.
+class CSpanBuffer : public std::streambuf
+{
+public:
+	explicit CSpanBuffer(std::span<const char> data);
+protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+};
+
+// Appends everything written to a string owned by the caller.
+class CGrowableBuffer : public std::streambuf
+{
+public:
+	explicit CGrowableBuffer(std::string& output);
+protected:
+	int_type overflow(int_type ch) override;
+	std::streamsize xsputn(const char* s, std::streamsize count) override;
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+private:
+	std::string& m_Output;
+	size_t m_Start;
+};
+
+#endif // !_MEMBUF_H_
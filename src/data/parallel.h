@@ -0,0 +1,176 @@
+//
+//	data/parallel.h
+//
+
+#ifndef _PARALLEL_H_
+#define _PARALLEL_H_
+
+// C/C++
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <functional>
+#include <condition_variable>
+
+// Runs task(0) .. task(count - 1) on up to numThreads workers, each worker
+// takes the next index as soon as it is done with its last one. A single
+// worker runs everything on the calling thread.
+inline void RunParallel(size_t count, unsigned int numThreads, const std::function<void(size_t)>& task)
+{
+	if (numThreads == 0)
+	{
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	const size_t numWorkers = std::min<size_t>(count, numThreads);
+	if (numWorkers <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			task(i);
+		}
+		return;
+	}
+
+	std::atomic<size_t> next = 0;
+	std::vector<std::thread> vWorkers;
+	vWorkers.reserve(numWorkers);
+
+	for (size_t i = 0; i < numWorkers; i++)
+	{
+		vWorkers.emplace_back([&next, count, &task]()
+		{
+			for (size_t index = next++; index < count; index = next++)
+			{
+				task(index);
+			}
+		});
+	}
+
+	for (std::thread& worker : vWorkers)
+	{
+		worker.join();
+	}
+}
+
+// Same as RunParallel for a caller that runs many short batches in a row,
+// the workers are started by the first batch and wait for the next one
+// instead of being joined. The calling thread works on every batch too.
+// Run() is for one caller at a time and returns once every index is done.
+class CWorkerPool
+{
+public:
+	explicit CWorkerPool(unsigned int numThreads = 0) :
+		m_NumThreads(numThreads ? numThreads : std::max(1u, std::thread::hardware_concurrency())),
+		m_pTask(nullptr),
+		m_Count(0),
+		m_Next(0),
+		m_NumBusy(0),
+		m_Batch(0),
+		m_Stop(false)
+	{
+	}
+
+	~CWorkerPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_Wake.notify_all();
+
+		for (std::thread& worker : m_Workers)
+		{
+			worker.join();
+		}
+	}
+
+	CWorkerPool(const CWorkerPool&) = delete;
+	CWorkerPool& operator=(const CWorkerPool&) = delete;
+
+	void Run(size_t count, const std::function<void(size_t)>& task)
+	{
+		if (m_NumThreads <= 1 || count <= 1)
+		{
+			for (size_t i = 0; i < count; i++)
+			{
+				task(i);
+			}
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			while (m_Workers.size() + 1 < m_NumThreads)
+			{
+				m_Workers.emplace_back(&CWorkerPool::Work, this);
+			}
+
+			m_pTask = &task;
+			m_Count = count;
+			m_Next = 0;
+			m_NumBusy = m_Workers.size();
+			m_Batch++;
+		}
+		m_Wake.notify_all();
+
+		for (size_t index = m_Next++; index < count; index = m_Next++)
+		{
+			task(index);
+		}
+
+		// Every worker has to be out of the batch before the next one resets the counter
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		m_Done.wait(lock, [this]() { return m_NumBusy == 0; });
+		m_pTask = nullptr;
+	}
+private:
+	void Work()
+	{
+		std::unique_lock<std::mutex> lock(m_Mutex);
+		unsigned int seen = m_Batch - 1;
+
+		while (true)
+		{
+			m_Wake.wait(lock, [this, &seen]() { return m_Stop || m_Batch != seen; });
+			if (m_Stop)
+			{
+				return;
+			}
+
+			seen = m_Batch;
+			const std::function<void(size_t)>& task = *m_pTask;
+			const size_t count = m_Count;
+			lock.unlock();
+
+			for (size_t index = m_Next++; index < count; index = m_Next++)
+			{
+				task(index);
+			}
+
+			lock.lock();
+			if (--m_NumBusy == 0)
+			{
+				m_Done.notify_one();
+			}
+		}
+	}
+private:
+	const unsigned int m_NumThreads;	// Including the calling thread
+	std::vector<std::thread> m_Workers;
+	std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::condition_variable m_Done;
+
+	const std::function<void(size_t)>* m_pTask;
+	size_t m_Count;
+	std::atomic<size_t> m_Next;
+	size_t m_NumBusy;					// Workers still in the batch
+	unsigned int m_Batch;				// Bumped by every batch
+	bool m_Stop;
+};
+
+#endif // !_PARALLEL_H_
@@ -0,0 +1,108 @@
+//
+//	data/spscqueue.h
+//
+
+#ifndef _SPSCQUEUE_H_
+#define _SPSCQUEUE_H_
+
+// C/C++
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+// Bounded lock-free queue between exactly one producer and one consumer.
+// Both sides block with atomic waits when the ring is full or empty, the
+// closed flag lives in the top bit of both counters so Close() wakes them.
+template<typename T>
+class CSpscQueue
+{
+public:
+	explicit CSpscQueue(size_t capacity) :
+		m_Head(0),
+		m_Tail(0)
+	{
+		size_t size = 1;
+		while (size < capacity)
+		{
+			size <<= 1;
+		}
+		m_Items.resize(size);
+		m_Mask = size - 1;
+	}
+
+	CSpscQueue(const CSpscQueue&) = delete;
+	CSpscQueue& operator=(const CSpscQueue&) = delete;
+
+	// Blocks while the queue is full, returns false once it has been closed
+	bool Push(T&& item)
+	{
+		const size_t uTail = m_Tail.load(std::memory_order_relaxed);
+		if (uTail & CLOSED)
+		{
+			return false;
+		}
+
+		for (;;)
+		{
+			const size_t uHead = m_Head.load(std::memory_order_acquire);
+			if (uHead & CLOSED)
+			{
+				return false;
+			}
+			if (uTail - uHead <= m_Mask)
+			{
+				break;
+			}
+			m_Head.wait(uHead, std::memory_order_acquire);
+		}
+
+		m_Items[uTail & m_Mask] = std::move(item);
+		m_Tail.fetch_add(1, std::memory_order_release);
+		m_Tail.notify_one();
+		return true;
+	}
+
+	// Blocks while the queue is empty, returns false once it is closed and drained
+	bool Pop(T& item)
+	{
+		const size_t uHead = m_Head.load(std::memory_order_relaxed) & ~CLOSED;
+
+		for (;;)
+		{
+			const size_t uTail = m_Tail.load(std::memory_order_acquire);
+			if ((uTail & ~CLOSED) != uHead)
+			{
+				break;
+			}
+			if (uTail & CLOSED)
+			{
+				return false;
+			}
+			m_Tail.wait(uTail, std::memory_order_acquire);
+		}
+
+		item = std::move(m_Items[uHead & m_Mask]);
+		m_Head.fetch_add(1, std::memory_order_release);
+		m_Head.notify_one();
+		return true;
+	}
+
+	// Either side may close, the producer to signal the end of the stream
+	// and the consumer to abort a producer blocked on a full queue.
+	void Close()
+	{
+		m_Tail.fetch_or(CLOSED, std::memory_order_acq_rel);
+		m_Head.fetch_or(CLOSED, std::memory_order_acq_rel);
+		m_Tail.notify_all();
+		m_Head.notify_all();
+	}
+private:
+	static constexpr size_t CLOSED = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+
+	std::vector<T> m_Items;
+	size_t m_Mask;
+	alignas(64) std::atomic<size_t> m_Head;
+	alignas(64) std::atomic<size_t> m_Tail;
+};
+
+#endif // !_SPSCQUEUE_H_
@@ -4,6 +4,30 @@
 
 #include "stringhash.h"
 
+// C/C++
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define RAGE_HASH_SIMD 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif
+
+// MSVC takes the intrinsics without switches, GCC and Clang need them enabled per function
+#if RAGE_HASH_SIMD && (defined(__GNUC__) || defined(__clang__))
+#define RAGE_TARGET_AVX2 __attribute__((target("avx2")))
+#define RAGE_TARGET_AVX512 __attribute__((target("avx2,avx512f")))
+#else
+#define RAGE_TARGET_AVX2
+#define RAGE_TARGET_AVX512
+#endif
+
 namespace rage
 {
 	constexpr unsigned char g_NormalizeCaseAndSlash[256] =
@@ -32,18 +56,21 @@ namespace rage
 		0xFC, 0xFD, 0xFE, 0xFF
 	};
 
-	unsigned int atFinalizeHash(unsigned int hash)
+	constexpr bool MatchesLiteralNormalization()
 	{
-		hash += (hash << 3);
-		hash ^= (hash >> 11);
-		hash += (hash << 15);
-		return hash;
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			if (atNormalizeCaseAndSlash(static_cast<unsigned char>(i)) != g_NormalizeCaseAndSlash[i])
+			{
+				return false;
+			}
+		}
+		return true;
 	}
+	static_assert(MatchesLiteralNormalization(), "atLiteralStringHash would disagree with atStringHash");
 
-	unsigned int atPartialStringHash(const char* string)
+	unsigned int atPartialStringHash(const char* string, unsigned int hash /*= 0*/)
 	{
-		unsigned hash = 0;
-
 		while (*string)
 		{
 			hash += (char)g_NormalizeCaseAndSlash[(unsigned char)*string++];
@@ -57,4 +84,242 @@ namespace rage
 	{
 		return atFinalizeHash(atPartialStringHash(string));
 	}
+
+#if RAGE_HASH_SIMD
+namespace
+{
+	// The table only differs from identity in rows 0x40 and 0x50 (A-Z and the backslash), the
+	// lanes look up the difference in those two rows by the low nibble and add it
+	constexpr bool IsIdentityOutsideRows45()
+	{
+		for (unsigned int i = 0; i < 256; i++)
+		{
+			if ((i >> 4) != 4 && (i >> 4) != 5 && g_NormalizeCaseAndSlash[i] != i)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	static_assert(IsIdentityOutsideRows45(), "g_NormalizeCaseAndSlash changed outside of the shuffled rows");
+
+	constexpr char GetNormalizeDelta(unsigned int i)
+	{
+		return static_cast<char>(g_NormalizeCaseAndSlash[i] - i);
+	}
+
+	enum eHashLanes
+	{
+		HASH_LANES_SCALAR = 1,
+		HASH_LANES_AVX2 = 8,
+		HASH_LANES_AVX512 = 16,
+	};
+
+	eHashLanes GetHashLanes()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 1);
+		if (!(info[2] & (1 << 27)) || !(info[2] & (1 << 28)))
+		{
+			return HASH_LANES_SCALAR;
+		}
+
+		// The OS has to save the ymm and zmm registers too
+		const unsigned long long xcr0 = _xgetbv(0);
+		__cpuidex(info, 7, 0);
+		if ((info[1] & (1 << 16)) && (xcr0 & 0xE6) == 0xE6)
+		{
+			return HASH_LANES_AVX512;
+		}
+		return ((info[1] & (1 << 5)) && (xcr0 & 0x06) == 0x06) ? HASH_LANES_AVX2 : HASH_LANES_SCALAR;
+#else
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			return HASH_LANES_AVX512;
+		}
+		return __builtin_cpu_supports("avx2") ? HASH_LANES_AVX2 : HASH_LANES_SCALAR;
+#endif // _MSC_VER
+	}
+
+	// Normalizes 16 bytes at once, the difference to identity is looked up by the low nibble
+	RAGE_TARGET_AVX2 __m128i NormalizeCaseAndSlash(__m128i bytes)
+	{
+		const __m128i row4 = _mm_setr_epi8(
+			GetNormalizeDelta(0x40), GetNormalizeDelta(0x41), GetNormalizeDelta(0x42), GetNormalizeDelta(0x43),
+			GetNormalizeDelta(0x44), GetNormalizeDelta(0x45), GetNormalizeDelta(0x46), GetNormalizeDelta(0x47),
+			GetNormalizeDelta(0x48), GetNormalizeDelta(0x49), GetNormalizeDelta(0x4A), GetNormalizeDelta(0x4B),
+			GetNormalizeDelta(0x4C), GetNormalizeDelta(0x4D), GetNormalizeDelta(0x4E), GetNormalizeDelta(0x4F));
+		const __m128i row5 = _mm_setr_epi8(
+			GetNormalizeDelta(0x50), GetNormalizeDelta(0x51), GetNormalizeDelta(0x52), GetNormalizeDelta(0x53),
+			GetNormalizeDelta(0x54), GetNormalizeDelta(0x55), GetNormalizeDelta(0x56), GetNormalizeDelta(0x57),
+			GetNormalizeDelta(0x58), GetNormalizeDelta(0x59), GetNormalizeDelta(0x5A), GetNormalizeDelta(0x5B),
+			GetNormalizeDelta(0x5C), GetNormalizeDelta(0x5D), GetNormalizeDelta(0x5E), GetNormalizeDelta(0x5F));
+
+		const __m128i nibble = _mm_set1_epi8(0x0F);
+		const __m128i low = _mm_and_si128(bytes, nibble);
+		const __m128i high = _mm_and_si128(_mm_srli_epi16(bytes, 4), nibble);
+
+		const __m128i delta4 = _mm_and_si128(_mm_shuffle_epi8(row4, low), _mm_cmpeq_epi8(high, _mm_set1_epi8(4)));
+		const __m128i delta5 = _mm_and_si128(_mm_shuffle_epi8(row5, low), _mm_cmpeq_epi8(high, _mm_set1_epi8(5)));
+		return _mm_add_epi8(bytes, _mm_or_si128(delta4, delta5));
+	}
+
+	// Copies the normalized strings into rows of stride bytes, one per lane. False if one of
+	// them does not fit. Nothing is read past a terminator, the block holding it is copied aside.
+	RAGE_TARGET_AVX2 bool CopyRows(const char* const* strings, size_t numLanes, unsigned char* pRows, size_t stride, int* lengths)
+	{
+		for (size_t j = 0; j < numLanes; j++)
+		{
+			const size_t length = strnlen(strings[j], stride);
+			if ((length / 16 + 1) * 16 > stride)
+			{
+				return false;
+			}
+
+			const unsigned char* string = reinterpret_cast<const unsigned char*>(strings[j]);
+			unsigned char* pRow = pRows + j * stride;
+
+			size_t i = 0;
+			for (; i + 16 <= length; i += 16)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow + i), NormalizeCaseAndSlash(_mm_loadu_si128(reinterpret_cast<const __m128i*>(string + i))));
+			}
+
+			alignas(16) unsigned char buffer[16] = {};
+			memcpy(buffer, string + i, length - i);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pRow + i), NormalizeCaseAndSlash(_mm_load_si128(reinterpret_cast<const __m128i*>(buffer))));
+
+			lengths[j] = static_cast<int>(length);
+		}
+		return true;
+	}
+
+	// Lanes take one row each, a gather fetches the next four bytes of every row
+	RAGE_TARGET_AVX2 void HashRowsAvx2(const unsigned char* pRows, size_t stride, const int* lengths, unsigned int* hashes)
+	{
+		const int rowStride = static_cast<int>(stride);
+		const __m256i rowOffsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(rowStride));
+		const __m256i lanesLength = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lengths));
+		const int maxLength = *std::max_element(lengths, lengths + HASH_LANES_AVX2);
+
+		__m256i hash = _mm256_setzero_si256();
+		for (int i = 0; i < maxLength; i += 4)
+		{
+			const __m256i bytes = _mm256_i32gather_epi32(reinterpret_cast<const int*>(pRows + i), rowOffsets, 1);
+
+			for (int k = 0; k < 4; k++)
+			{
+				// The scalar loop adds the table value as a char, it is sign extended where char is signed
+				__m256i value = _mm256_slli_epi32(bytes, 24 - 8 * k);
+				value = std::is_signed_v<char> ? _mm256_srai_epi32(value, 24) : _mm256_srli_epi32(value, 24);
+
+				__m256i next = _mm256_add_epi32(hash, value);
+				next = _mm256_add_epi32(next, _mm256_slli_epi32(next, 10));
+				next = _mm256_xor_si256(next, _mm256_srli_epi32(next, 6));
+
+				// Lanes past the end of their string keep the finished hash. Selected by masking,
+				// GCC folds blendv to a sign test on char that never holds with -funsigned-char.
+				const __m256i active = _mm256_cmpgt_epi32(lanesLength, _mm256_set1_epi32(i + k));
+				hash = _mm256_xor_si256(hash, _mm256_and_si256(_mm256_xor_si256(hash, next), active));
+			}
+		}
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(hashes), hash);
+	}
+
+	RAGE_TARGET_AVX512 void HashRowsAvx512(const unsigned char* pRows, size_t stride, const int* lengths, unsigned int* hashes)
+	{
+		const int rowStride = static_cast<int>(stride);
+		const __m512i rowOffsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(rowStride));
+		const __m512i lanesLength = _mm512_loadu_si512(lengths);
+		const int maxLength = *std::max_element(lengths, lengths + HASH_LANES_AVX512);
+
+		__m512i hash = _mm512_setzero_si512();
+		for (int i = 0; i < maxLength; i += 4)
+		{
+			const __mmask16 fetch = _mm512_cmpgt_epi32_mask(lanesLength, _mm512_set1_epi32(i));
+			const __m512i bytes = _mm512_mask_i32gather_epi32(_mm512_setzero_si512(), fetch, rowOffsets, pRows + i, 1);
+
+			for (int k = 0; k < 4; k++)
+			{
+				// Shifts zero the lanes past the end of their string, adding nothing leaves their hash as it is
+				const __mmask16 active = _mm512_cmpgt_epi32_mask(lanesLength, _mm512_set1_epi32(i + k));
+
+				__m512i value = _mm512_maskz_slli_epi32(active, bytes, 24 - 8 * k);
+				value = std::is_signed_v<char> ? _mm512_maskz_srai_epi32(active, value, 24) : _mm512_maskz_srli_epi32(active, value, 24);
+
+				hash = _mm512_add_epi32(hash, value);
+				hash = _mm512_add_epi32(hash, _mm512_maskz_slli_epi32(active, hash, 10));
+				hash = _mm512_xor_si512(hash, _mm512_maskz_srli_epi32(active, hash, 6));
+			}
+		}
+		_mm512_storeu_si512(hashes, hash);
+	}
+
+	template<size_t numLanes>
+	void HashLanes(const char* const* strings, unsigned int* hashes, std::vector<unsigned char>& vRows, size_t& stride)
+	{
+		int lengths[numLanes];
+		while (!CopyRows(strings, numLanes, vRows.data(), stride, lengths))
+		{
+			// Rows stay as long as the longest string so far
+			stride *= 2;
+			vRows.resize(stride * HASH_LANES_AVX512);
+		}
+
+		if constexpr (numLanes == HASH_LANES_AVX512)
+		{
+			HashRowsAvx512(vRows.data(), stride, lengths, hashes);
+		}
+		else
+		{
+			HashRowsAvx2(vRows.data(), stride, lengths, hashes);
+		}
+	}
+}
+#endif // RAGE_HASH_SIMD
+
+	void atPartialStringHashBatch(const char* const* strings, unsigned int* hashes, size_t count)
+	{
+		size_t i = 0;
+
+#if RAGE_HASH_SIMD
+		static const eHashLanes lanes = GetHashLanes();
+		size_t stride = 64;
+		std::vector<unsigned char> vRows(stride * HASH_LANES_AVX512);
+
+		if (lanes == HASH_LANES_AVX512)
+		{
+			for (; i + HASH_LANES_AVX512 <= count; i += HASH_LANES_AVX512)
+			{
+				HashLanes<HASH_LANES_AVX512>(strings + i, hashes + i, vRows, stride);
+			}
+		}
+
+		if (lanes >= HASH_LANES_AVX2)
+		{
+			for (; i + HASH_LANES_AVX2 <= count; i += HASH_LANES_AVX2)
+			{
+				HashLanes<HASH_LANES_AVX2>(strings + i, hashes + i, vRows, stride);
+			}
+		}
+#endif // RAGE_HASH_SIMD
+
+		// Whatever does not fill the lanes
+		for (; i < count; i++)
+		{
+			hashes[i] = atPartialStringHash(strings[i]);
+		}
+	}
+
+	void atStringHashBatch(const char* const* strings, unsigned int* hashes, size_t count)
+	{
+		atPartialStringHashBatch(strings, hashes, count);
+
+		for (size_t i = 0; i < count; i++)
+		{
+			hashes[i] = atFinalizeHash(hashes[i]);
+		}
+	}
 }
\ No newline at end of file
@@ -5,11 +5,107 @@
 #ifndef _STRINGHASH_H_
 #define _STRINGHASH_H_
 
+// C/C++
+#include <cstddef>
+#include <string_view>
+#include <initializer_list>
+
 namespace rage
 {
-	unsigned int atFinalizeHash(unsigned int hash);
-	unsigned int atPartialStringHash(const char* string);
+	// A partial hash continues from hash, so a shared prefix only needs hashing once
+	unsigned int atPartialStringHash(const char* string, unsigned int hash = 0);
 	unsigned int atStringHash(const char* string);
+
+	// Hash count strings side by side, one per SIMD lane where the CPU has AVX2 or
+	// AVX-512. Every result is identical to the single string version.
+	void atPartialStringHashBatch(const char* const* strings, unsigned int* hashes, size_t count);
+	void atStringHashBatch(const char* const* strings, unsigned int* hashes, size_t count);
+
+	constexpr unsigned int atFinalizeHash(unsigned int hash)
+	{
+		hash += (hash << 3);
+		hash ^= (hash >> 11);
+		hash += (hash << 15);
+		return hash;
+	}
+
+	// Lowercase and forward slashes, stringhash.cpp checks it against its lookup table
+	constexpr unsigned char atNormalizeCaseAndSlash(unsigned char c)
+	{
+		if (c >= 'A' && c <= 'Z')
+		{
+			return static_cast<unsigned char>(c - 'A' + 'a');
+		}
+		return (c == '\\') ? '/' : c;
+	}
+
+	// A single character of atPartialStringHash, for searches that extend a hash one character at a time
+	constexpr unsigned int atPartialCharHash(char c, unsigned int hash)
+	{
+		hash += static_cast<unsigned int>(static_cast<char>(atNormalizeCaseAndSlash(static_cast<unsigned char>(c))));
+		hash += (hash << 10);
+		hash ^= (hash >> 6);
+		return hash;
+	}
+
+	// atStringHash for the compiler, it also stops at the first NUL
+	constexpr unsigned int atLiteralStringHash(std::string_view string)
+	{
+		unsigned int hash = 0;
+
+		for (const char c : string)
+		{
+			if (!c)
+			{
+				break;
+			}
+			hash = atPartialCharHash(c, hash);
+		}
+		return atFinalizeHash(hash);
+	}
+
+	constexpr bool atIsSameLabel(std::string_view label1, std::string_view label2)
+	{
+		if (label1.size() != label2.size())
+		{
+			return false;
+		}
+
+		for (size_t i = 0; i < label1.size(); i++)
+		{
+			if (atNormalizeCaseAndSlash(static_cast<unsigned char>(label1[i])) != atNormalizeCaseAndSlash(static_cast<unsigned char>(label2[i])))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// For static_assert over the labels a tool relies on. Spellings of the same label are
+	// fine, two different labels with one hash are not.
+	consteval bool atHashesAreUnique(std::initializer_list<std::string_view> labels)
+	{
+		for (auto it1 = labels.begin(); it1 != labels.end(); ++it1)
+		{
+			for (auto it2 = it1 + 1; it2 != labels.end(); ++it2)
+			{
+				if (atLiteralStringHash(*it1) == atLiteralStringHash(*it2) && !atIsSameLabel(*it1, *it2))
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	inline namespace literals
+	{
+		// "LABEL"_gxt, hashed while compiling
+		consteval unsigned int operator""_gxt(const char* string, size_t length)
+		{
+			return atLiteralStringHash(std::string_view(string, length));
+		}
+	}
 }
 
 #endif // !_STRINGHASH_H_
\ No newline at end of file
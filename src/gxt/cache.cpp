@@ -0,0 +1,161 @@
+//
+//	gxt/cache.cpp
+//
+
+// Project
+#include "cache.h"
+#include "data/mappedfile.h"
+#include "data/contenthash.h"
+
+// C/C++
+#include <chrono>
+#include <format>
+#include <cstdlib>
+
+#if __linux__
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#elif __APPLE__
+#include <sys/clonefile.h>
+#endif
+
+namespace
+{
+	// Copy on write clone, shares the blocks but not the inode
+	bool CloneFile(const std::filesystem::path& source, const std::filesystem::path& target)
+	{
+#if __linux__
+		const int sourceFd = open(source.c_str(), O_RDONLY | O_CLOEXEC);
+		if (sourceFd < 0)
+		{
+			return false;
+		}
+
+		const int targetFd = open(target.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+		if (targetFd < 0)
+		{
+			close(sourceFd);
+			return false;
+		}
+
+		const bool bCloned = ioctl(targetFd, FICLONE, sourceFd) == 0;
+		close(targetFd);
+		close(sourceFd);
+
+		if (!bCloned)
+		{
+			unlink(target.c_str());
+		}
+		return bCloned;
+#elif __APPLE__
+		return clonefile(source.c_str(), target.c_str(), 0) == 0;
+#else
+		(void)source;
+		(void)target;
+		return false;
+#endif
+	}
+}
+
+CConversionCache::CConversionCache(const std::string& cacheDir) :
+	m_Directory(cacheDir)
+{
+	std::filesystem::create_directories(m_Directory);
+} // ::CConversionCache(const string& cacheDir)
+
+std::string CConversionCache::MakeKey(const std::vector<std::string>& inputFiles, const std::string& options)
+{
+	std::string szMaterial = std::format("gxt2 cache v{}\n{}\n", CACHE_VERSION, options);
+
+	for (const std::string& inputFile : inputFiles)
+	{
+		// The extension picks the decoder, identical bytes in another format are another table
+		const CMappedFile input(inputFile);
+		szMaterial += std::format("{} {:016X}\n", std::filesystem::path(inputFile).extension().string(), HashContent(input.GetData()));
+	}
+
+	// Two differently seeded passes, a 64-bit key alone could collide in a big shared cache
+	return std::format("{:016x}{:016x}", HashContent(szMaterial), HashContent(szMaterial, CACHE_VERSION));
+} // string ::MakeKey(const vector<string>& inputFiles, const string& options)
+
+bool CConversionCache::Fetch(const std::string& key, const std::string& outputFile) const
+{
+	const std::filesystem::path entry = GetEntryPath(key, outputFile);
+
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(entry, ec))
+	{
+		return false;
+	}
+
+	RemoveOutput(outputFile);
+	if (CloneFile(entry, outputFile))
+	{
+		return true;
+	}
+
+	// Fails across devices and on file systems without links, a copy always works
+	std::filesystem::create_hard_link(entry, outputFile, ec);
+	if (!ec)
+	{
+		return true;
+	}
+	return std::filesystem::copy_file(entry, outputFile, ec) && !ec;
+} // bool ::Fetch(const string& key, const string& outputFile) const
+
+bool CConversionCache::Store(const std::string& key, const std::string& outputFile) const
+{
+	const std::filesystem::path entry = GetEntryPath(key, outputFile);
+
+	std::error_code ec;
+	std::filesystem::create_directories(entry.parent_path(), ec);
+
+	// Never linked, the output may still be rewritten in place by a run without the cache.
+	// Jobs sharing the cache publish through a rename so nobody picks up half an entry.
+	const std::filesystem::path tempFile = entry.string() + std::format(".{}.tmp", std::chrono::steady_clock::now().time_since_epoch().count());
+	if (!CloneFile(outputFile, tempFile) && !std::filesystem::copy_file(outputFile, tempFile, ec))
+	{
+		return false;
+	}
+
+	std::filesystem::rename(tempFile, entry, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempFile, ec);
+		return false;
+	}
+	return true;
+} // bool ::Store(const string& key, const string& outputFile) const
+
+std::string CConversionCache::GetDefaultDirectory()
+{
+#ifdef _MSC_VER
+	char* szDirectory = nullptr;
+	size_t length = 0;
+	if (_dupenv_s(&szDirectory, &length, "GXT2_CACHE_DIR") != 0 || !szDirectory)
+	{
+		return "";
+	}
+	const std::string directory = szDirectory;
+	free(szDirectory);
+	return directory;
+#else
+	const char* szDirectory = std::getenv("GXT2_CACHE_DIR");
+	return szDirectory ? szDirectory : "";
+#endif // _MSC_VER
+} // string ::GetDefaultDirectory()
+
+void CConversionCache::RemoveOutput(const std::string& outputFile)
+{
+	std::error_code ec;
+	std::filesystem::remove(outputFile, ec);
+} // void ::RemoveOutput(const string& outputFile)
+
+std::filesystem::path CConversionCache::GetEntryPath(const std::string& key, const std::string& outputFile) const
+{
+	// Fanned out by the first byte, a flat directory gets slow with many thousand entries
+	return m_Directory / key.substr(0, 2) / (key + std::filesystem::path(outputFile).extension().string());
+} // path ::GetEntryPath(const string& key, const string& outputFile) const
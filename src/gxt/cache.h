@@ -0,0 +1,44 @@
+//
+//	gxt/cache.h
+//
+
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+// C/C++
+#include <string>
+#include <vector>
+#include <filesystem>
+
+// Content addressed store of converted tables. An entry is keyed by the
+// contents of every input plus the options that shape the output, so the
+// same sources convert once no matter which branch or job they come from.
+// Hits are served as reflinks where the file system supports them and as
+// hard links otherwise. CFile never truncates a file with more than one
+// link, so writing over a linked output leaves the cached copy alone.
+class CConversionCache
+{
+public:
+	explicit CConversionCache(const std::string& cacheDir);
+
+	// Inputs are hashed in order, swapping two merge inputs is a different key
+	static std::string MakeKey(const std::vector<std::string>& inputFiles, const std::string& options);
+
+	// Materializes the entry at outputFile, false on a miss
+	bool Fetch(const std::string& key, const std::string& outputFile) const;
+	bool Store(const std::string& key, const std::string& outputFile) const;
+
+	// GXT2_CACHE_DIR, empty if unset
+	static std::string GetDefaultDirectory();
+
+	// Deletes outputFile first, a hard linked output must not be truncated
+	static void RemoveOutput(const std::string& outputFile);
+
+	static constexpr unsigned int CACHE_VERSION = 1;
+private:
+	std::filesystem::path GetEntryPath(const std::string& key, const std::string& outputFile) const;
+private:
+	std::filesystem::path m_Directory;
+};
+
+#endif // !_CACHE_H_
@@ -4,15 +4,37 @@
 
 // Project
 #include "convert.h"
+#include "pipeline.h"
 #include "main/main.h"
 
-CConverter::CConverter(const std::string& filePath) :
+// C/C++
+#include <format>
+#include <future>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <exception>
+#include <filesystem>
+
+namespace
+{
+	// A pipelined output can fail halfway through, it replaces its target only once complete
+	std::string GetPartialPath(const std::string& filePath)
+	{
+		return filePath + ".tmp";
+	}
+}
+
+CConverter::CConverter(const std::string& filePath, bool bDefaultOutput /*= true*/, bool bPipelined /*= false*/) :
 	m_Input(nullptr),
-	m_Output(nullptr)
+	m_Pipelined(bPipelined)
 {
 	CreateInputInterface(filePath);
-	CreateOutputInterface(filePath);
-} // ::CConverter(const string& filePath)
+	if (bDefaultOutput)
+	{
+		CreateOutputInterface(filePath);
+	}
+} // ::CConverter(const string& filePath, bool bDefaultOutput = true, bool bPipelined = false)
 
 CConverter::~CConverter()
 {
@@ -26,29 +48,374 @@ void CConverter::Reset()
 		delete m_Input;
 		m_Input = nullptr;
 	}
-	if (m_Output)
+	for (CFile* pOutput : m_Outputs)
 	{
-		delete m_Output;
-		m_Output = nullptr;
+		delete pOutput;
 	}
+	m_Outputs.clear();
+
+	if (m_Pipelined)
+	{
+		RemovePartialOutputs();
+	}
+	m_OutputPaths.clear();
 } // void ::Reset()
 
 void CConverter::Convert()
 {
+	if (m_Pipelined)
+	{
+		ConvertPipelined();
+		return;
+	}
+
 	if (!GetInput()->ReadEntries())
 	{
 		throw std::runtime_error("Failed to read content.");
 	}
 
 	//GetInput()->Dump();
-	GetOutput()->SetData(GetInput()->GetData());
 
-	if (!GetOutput()->WriteEntries())
+	// Decode once, every output serializes the same immutable table
+	const CFile::SharedMap pEntries = GetInput()->ShareData();
+	for (CFile* pOutput : m_Outputs)
+	{
+		pOutput->SetData(pEntries);
+	}
+
+	bool bSuccess = true;
+	if (m_Outputs.size() == 1)
+	{
+		bSuccess = GetOutput()->WriteEntries();
+	}
+	else
+	{
+		std::vector<std::future<bool>> vWriters;
+		for (CFile* pOutput : m_Outputs)
+		{
+			vWriters.push_back(std::async(std::launch::async, [pOutput]() -> bool
+			{
+				return pOutput->WriteEntries();
+			}));
+		}
+		for (std::future<bool>& writer : vWriters)
+		{
+			bSuccess &= writer.get();
+		}
+	}
+
+	if (!bSuccess)
 	{
 		throw std::runtime_error("Failed to save content.");
 	}
 } // void ::Convert()
 
+void CConverter::ConvertPipelined()
+{
+	static constexpr size_t QUEUE_DEPTH = 8;
+	static constexpr size_t BATCH_SIZE = 4096;
+
+	using Batch = std::shared_ptr<const CFile::Vec>;
+
+	struct Stage
+	{
+		Stage() : m_Chunks(QUEUE_DEPTH), m_Batches(QUEUE_DEPTH), m_Buffer(m_Chunks) {}
+
+		ChunkQueue m_Chunks;
+		CSpscQueue<Batch> m_Batches;
+		CChunkWriteBuffer m_Buffer;
+		std::exception_ptr m_EncodeError;
+		std::exception_ptr m_WriteError;
+	};
+
+	ChunkQueue inputChunks(QUEUE_DEPTH);
+	CChunkReadBuffer inputBuffer(inputChunks);
+	std::exception_ptr readError, decodeError;
+	std::atomic<bool> bAborted(false);
+
+	std::vector<std::unique_ptr<Stage>> vStages;
+	for (size_t i = 0; i < m_Outputs.size(); i++)
+	{
+		vStages.push_back(std::make_unique<Stage>());
+	}
+
+	auto closeAll = [&]()
+	{
+		bAborted = true;
+		inputChunks.Close();
+		for (const std::unique_ptr<Stage>& pStage : vStages)
+		{
+			pStage->m_Batches.Close();
+			pStage->m_Chunks.Close();
+		}
+	};
+
+	std::vector<std::thread> vThreads;
+
+	// Disk -> chunks
+	vThreads.emplace_back([&]()
+	{
+		try
+		{
+			std::streambuf* pFile = GetInput()->GetFileBuffer();
+			for (;;)
+			{
+				std::string szChunk(CChunkWriteBuffer::CHUNK_SIZE, '\0');
+				const std::streamsize n = pFile->sgetn(szChunk.data(), static_cast<std::streamsize>(szChunk.size()));
+				if (n <= 0)
+				{
+					break;
+				}
+				szChunk.resize(static_cast<size_t>(n));
+				if (!inputChunks.Push(std::move(szChunk)))
+				{
+					break;
+				}
+			}
+		}
+		catch (...)
+		{
+			readError = std::current_exception();
+			closeAll();
+		}
+		inputChunks.Close();
+	});
+
+	// Chunks -> batches of entries, shared by every output
+	vThreads.emplace_back([&]()
+	{
+		try
+		{
+			GetInput()->SetStreamBuffer(&inputBuffer);
+
+			auto pushBatch = [&](CFile::Vec& vBatch) -> bool
+			{
+				const Batch pBatch = std::make_shared<const CFile::Vec>(std::move(vBatch));
+				vBatch.clear();
+				for (const std::unique_ptr<Stage>& pStage : vStages)
+				{
+					if (!pStage->m_Batches.Push(Batch(pBatch)))
+					{
+						return false;
+					}
+				}
+				return true;
+			};
+
+			CFile::Vec vBatch;
+			vBatch.reserve(BATCH_SIZE);
+
+			unsigned int uHash = 0;
+			std::string szText;
+			bool bRunning = true;
+
+			while (bRunning && GetInput()->ReadEntry(uHash, szText))
+			{
+				if (!vBatch.empty() && vBatch.back().first == uHash)
+				{
+					// Same semantics as the map, the last occurrence wins
+					vBatch.back().second = std::move(szText);
+					continue;
+				}
+				if (!vBatch.empty() && vBatch.back().first > uHash)
+				{
+					throw std::runtime_error("Pipelined conversion requires input sorted by hash, use the default or /external mode.");
+				}
+				if (vBatch.size() == BATCH_SIZE)
+				{
+					// Keep the last entry back so a duplicate can still replace it
+					CFile::Vec::value_type last = std::move(vBatch.back());
+					vBatch.pop_back();
+					bRunning = pushBatch(vBatch);
+					vBatch.push_back(std::move(last));
+				}
+				vBatch.emplace_back(uHash, std::move(szText));
+			}
+
+			if (bRunning && !vBatch.empty())
+			{
+				pushBatch(vBatch);
+			}
+		}
+		catch (...)
+		{
+			decodeError = std::current_exception();
+			closeAll();
+		}
+
+		// Let the reader go if decoding stopped early
+		inputChunks.Close();
+		for (const std::unique_ptr<Stage>& pStage : vStages)
+		{
+			pStage->m_Batches.Close();
+		}
+	});
+
+	for (size_t i = 0; i < m_Outputs.size(); i++)
+	{
+		CFile* pOutput = m_Outputs[i];
+		Stage* pStage = vStages[i].get();
+
+		// Batches -> encoded chunks
+		vThreads.emplace_back([&closeAll, &bAborted, pOutput, pStage]()
+		{
+			try
+			{
+				pOutput->SetStreamBuffer(&pStage->m_Buffer);
+
+				bool bSuccess = pOutput->WriteHeader();
+
+				Batch pBatch;
+				while (bSuccess && pStage->m_Batches.Pop(pBatch))
+				{
+					for (const CFile::Vec::value_type& entry : *pBatch)
+					{
+						if (!pOutput->WriteEntry(entry.first, entry.second))
+						{
+							bSuccess = false;
+							break;
+						}
+					}
+				}
+
+				// A failed stage must not leave a truncated but valid looking file
+				if (bSuccess && !bAborted)
+				{
+					bSuccess = pOutput->WriteFooter() && pStage->m_Buffer.Flush();
+				}
+				if (!bSuccess && !bAborted)
+				{
+					throw std::runtime_error("Failed to save content.");
+				}
+			}
+			catch (...)
+			{
+				pStage->m_EncodeError = std::current_exception();
+				closeAll();
+			}
+			pStage->m_Batches.Close();
+			pStage->m_Chunks.Close();
+		});
+
+		// Encoded chunks -> disk
+		vThreads.emplace_back([&closeAll, pOutput, pStage]()
+		{
+			try
+			{
+				std::streambuf* pFile = pOutput->GetFileBuffer();
+
+				std::string szChunk;
+				while (pStage->m_Chunks.Pop(szChunk))
+				{
+					if (pFile->sputn(szChunk.data(), static_cast<std::streamsize>(szChunk.size())) != static_cast<std::streamsize>(szChunk.size()))
+					{
+						throw std::runtime_error("Failed to save content.");
+					}
+				}
+				if (pFile->pubsync() != 0)
+				{
+					throw std::runtime_error("Failed to save content.");
+				}
+			}
+			catch (...)
+			{
+				pStage->m_WriteError = std::current_exception();
+				closeAll();
+			}
+			pStage->m_Chunks.Close();
+		});
+	}
+
+	for (std::thread& thread : vThreads)
+	{
+		thread.join();
+	}
+
+	GetInput()->SetStreamBuffer(nullptr);
+	for (CFile* pOutput : m_Outputs)
+	{
+		pOutput->SetStreamBuffer(nullptr);
+	}
+
+	// Report the stage closest to the source, later failures usually follow from it
+	std::exception_ptr error = readError ? readError : decodeError;
+	for (const std::unique_ptr<Stage>& pStage : vStages)
+	{
+		if (!error)
+		{
+			error = pStage->m_EncodeError ? pStage->m_EncodeError : pStage->m_WriteError;
+		}
+	}
+
+	for (CFile* pOutput : m_Outputs)
+	{
+		pOutput->Close();
+	}
+
+	// The targets are left as they were unless every output is complete
+	if (error)
+	{
+		RemovePartialOutputs();
+		std::rethrow_exception(error);
+	}
+
+	for (const std::string& outputPath : m_OutputPaths)
+	{
+		std::error_code ec;
+		std::filesystem::rename(GetPartialPath(outputPath), outputPath, ec);
+		if (ec)
+		{
+			throw std::runtime_error(std::format("{} could not be replaced: {}", outputPath, ec.message()));
+		}
+	}
+} // void ::ConvertPipelined()
+
+void CConverter::RemovePartialOutputs()
+{
+	std::error_code ec;
+	for (const std::string& outputPath : m_OutputPaths)
+	{
+		std::filesystem::remove(GetPartialPath(outputPath), ec);
+	}
+} // void ::RemovePartialOutputs()
+
+void CConverter::AddOutput(const std::string& filePath, int endian /*= CFile::_LITTLE_ENDIAN*/)
+{
+	const size_t n = filePath.find_last_of(".");
+	const std::string szFileExtension = (n != std::string::npos) ? filePath.substr(n) : "";
+	const std::string szOutputPath = m_Pipelined ? GetPartialPath(filePath) : filePath;
+
+	if (szFileExtension == ".gxt2" && m_Pipelined)
+	{
+		m_Outputs.push_back(GXT_NEW CGxt2Writer(szOutputPath, endian));
+	}
+	else if (szFileExtension == ".gxt2")
+	{
+		m_Outputs.push_back(GXT_NEW CGxt2File(szOutputPath, CFile::FLAGS_WRITE_COMPILED, endian));
+	}
+	else if (szFileExtension == ".txt")
+	{
+		m_Outputs.push_back(GXT_NEW CTextFile(szOutputPath, CFile::FLAGS_WRITE_DECOMPILED));
+	}
+	else if (szFileExtension == ".json")
+	{
+		m_Outputs.push_back(GXT_NEW CJsonFile(szOutputPath, CFile::FLAGS_WRITE_DECOMPILED));
+	}
+	else if (szFileExtension == ".csv")
+	{
+		m_Outputs.push_back(GXT_NEW CCsvFile(szOutputPath, CFile::FLAGS_WRITE_DECOMPILED));
+	}
+	else if (szFileExtension == ".oxt")
+	{
+		m_Outputs.push_back(GXT_NEW COxtFile(szOutputPath, CFile::FLAGS_WRITE_DECOMPILED));
+	}
+	else
+	{
+		throw std::invalid_argument("Unknown output file format.");
+	}
+	m_OutputPaths.push_back(filePath);
+} // void ::AddOutput(const string& filePath, int endian = CFile::_LITTLE_ENDIAN)
+
 void CConverter::CreateInputInterface(const std::string& filePath)
 {
 	const std::string szFileExtension = filePath.substr(filePath.find_last_of("."));
@@ -65,6 +432,14 @@ void CConverter::CreateInputInterface(const std::string& filePath)
 	{
 		m_Input = GXT_NEW CJsonFile(filePath, CFile::FLAGS_READ_DECOMPILED);
 	}
+	else if (szFileExtension == ".csv")
+	{
+		m_Input = GXT_NEW CCsvFile(filePath, CFile::FLAGS_READ_DECOMPILED);
+	}
+	else if (szFileExtension == ".oxt")
+	{
+		m_Input = GXT_NEW COxtFile(filePath, CFile::FLAGS_READ_DECOMPILED);
+	}
 	else
 	{
 		throw std::invalid_argument("Unknown input file format.");
@@ -73,29 +448,23 @@ void CConverter::CreateInputInterface(const std::string& filePath)
 
 void CConverter::CreateOutputInterface(const std::string& filePath)
 {
-	std::string szOutputPath = filePath.substr(0, filePath.find_last_of("."));
-	const std::string szInputExtension = filePath.substr(filePath.find_last_of("."));
+	AddOutput(GetDefaultOutputPath(filePath));
+} // void ::CreateOutputInterface(const string& filePath)
 
-	if (szInputExtension == ".gxt2")
-	{
-		//szOutputPath += ".txt";
-		//m_Output = GXT_NEW CTextFile(szOutputPath, CFile::FLAGS_WRITE_DECOMPILED);
+std::string CConverter::GetDefaultOutputPath(const std::string& filePath)
+{
+	const size_t n = filePath.find_last_of(".");
+	const std::string szOutputPath = filePath.substr(0, n);
+	const std::string szInputExtension = (n != std::string::npos) ? filePath.substr(n) : "";
 
-		szOutputPath += ".json";
-		m_Output = GXT_NEW CJsonFile(szOutputPath, CFile::FLAGS_WRITE_DECOMPILED);
-	}
-	else if (szInputExtension == ".txt")
-	{
-		szOutputPath += ".gxt2";
-		m_Output = GXT_NEW CGxt2File(szOutputPath, CFile::FLAGS_WRITE_COMPILED);
-	}
-	else if (szInputExtension == ".json")
+	if (szInputExtension == ".gxt2")
 	{
-		szOutputPath += ".gxt2";
-		m_Output = GXT_NEW CGxt2File(szOutputPath, CFile::FLAGS_WRITE_COMPILED);
+		//return szOutputPath + ".txt";
+		return szOutputPath + ".json";
 	}
-	else
+	else if (szInputExtension == ".txt" || szInputExtension == ".json" || szInputExtension == ".csv" || szInputExtension == ".oxt")
 	{
-		throw std::invalid_argument("Unknown output file format.");
+		return szOutputPath + ".gxt2";
 	}
-} // void ::CreateOutputInterface(const string& filePath)
\ No newline at end of file
+	throw std::invalid_argument("Unknown output file format.");
+} // string ::GetDefaultOutputPath(const string& filePath)
@@ -8,28 +8,46 @@
 // Project
 #include "gxt2.h"
 
+// C/C++
+#include <vector>
+
 class CConverter
 {
 public:
-	explicit CConverter(const std::string& filePath);
+	// Without explicit outputs the input is converted next to itself,
+	// .gxt2 to .json and text formats to .gxt2. A pipelined converter
+	// overlaps reading, decoding, encoding and writing on separate threads
+	// and expects the input to be sorted by hash.
+	explicit CConverter(const std::string& filePath, bool bDefaultOutput = true, bool bPipelined = false);
 	virtual ~CConverter();
 
 	void Reset();
 	void Convert();
 
+	void AddOutput(const std::string& filePath, int endian = CFile::_LITTLE_ENDIAN);
+
 	CFile* GetInput() { return m_Input; }
 	const CFile* GetInput() const { return m_Input; }
 
-	CFile* GetOutput() { return m_Output; }
-	const CFile* GetOutput() const { return m_Output; }
+	CFile* GetOutput(size_t index = 0) { return m_Outputs.at(index); }
+	const CFile* GetOutput(size_t index = 0) const { return m_Outputs.at(index); }
+	size_t GetNumOutputs() const { return m_Outputs.size(); }
+
+	// Where the output goes without explicit outputs, .gxt2 next to text and .json next to .gxt2
+	static std::string GetDefaultOutputPath(const std::string& filePath);
 
 private:
+	void ConvertPipelined();
+	void RemovePartialOutputs();
+
 	void CreateInputInterface(const std::string& filePath);
 	void CreateOutputInterface(const std::string& filePath);
 
 private:
 	CFile* m_Input;
-	CFile* m_Output;
+	std::vector<CFile*> m_Outputs;
+	std::vector<std::string> m_OutputPaths;	// Targets, pipelined outputs are written next to them until complete
+	bool m_Pipelined;
 };
 
-#endif // !_CONVERT_H_
\ No newline at end of file
+#endif // !_CONVERT_H_
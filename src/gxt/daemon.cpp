@@ -0,0 +1,598 @@
+//
+//	gxt/daemon.cpp
+//
+
+// Project
+#include "daemon.h"
+#include "shmtable.h"
+#include "data/stringhash.h"
+
+// C/C++
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+// POSIX
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/socket.h>
+
+#ifndef MSG_NOSIGNAL
+	#define MSG_NOSIGNAL 0
+#endif // !MSG_NOSIGNAL
+
+namespace
+{
+	// Bounds checked cursor over one request
+	class CRequestReader
+	{
+	public:
+		CRequestReader(const char* pData, size_t size) : m_Data(pData), m_Remaining(size) {}
+
+		template<typename T>
+		bool Read(T& value)
+		{
+			if (m_Remaining < sizeof(T))
+			{
+				return false;
+			}
+			memcpy(&value, m_Data, sizeof(T));
+			m_Data += sizeof(T);
+			m_Remaining -= sizeof(T);
+			return true;
+		}
+
+		bool Read(const char*& pData, size_t size)
+		{
+			if (m_Remaining < size)
+			{
+				return false;
+			}
+			pData = m_Data;
+			m_Data += size;
+			m_Remaining -= size;
+			return true;
+		}
+
+		size_t GetRemaining() const { return m_Remaining; }
+	private:
+		const char* m_Data;
+		size_t m_Remaining;
+	};
+
+	template<typename T>
+	void Append(std::string& szBuffer, T value)
+	{
+		szBuffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	void AppendText(std::string& szBuffer, const CTextTable* pTable, unsigned int uHash)
+	{
+		bool bFound = false;
+		const std::string_view szText = pTable ? pTable->Find(uHash, bFound) : std::string_view();
+
+		if (!bFound)
+		{
+			Append<unsigned int>(szBuffer, CLookupDaemon::NOT_FOUND);
+			return;
+		}
+		Append<unsigned int>(szBuffer, static_cast<unsigned int>(szText.size()));
+		szBuffer.append(szText);
+	}
+}
+
+CLookupDaemon::CLookupDaemon(const std::string& socketPath, const std::string& textDir, const std::string& labelsFile /*= ""*/) :
+	m_SocketPath(socketPath),
+	m_Running(false),
+	m_Generation(0),
+	m_Listener(-1)
+{
+	FindLanguages(textDir);
+
+	if (!labelsFile.empty())
+	{
+		m_LabelsSource.m_Name = "labels";
+		m_LabelsSource.m_Path = labelsFile;
+	}
+
+	if (!Reload())
+	{
+		throw std::runtime_error("Failed to load the text tables.");
+	}
+} // ::CLookupDaemon(const string& socketPath, const string& textDir, const string& labelsFile = "")
+
+CLookupDaemon::~CLookupDaemon()
+{
+	for (const Connection& connection : m_Connections)
+	{
+		close(connection.m_Socket);
+	}
+	m_Connections.clear();
+
+	if (m_Listener >= 0)
+	{
+		close(m_Listener);
+		unlink(m_SocketPath.c_str());
+		m_Listener = -1;
+	}
+
+	if (!m_SharedMemoryName.empty())
+	{
+		CSharedTableWriter::Unlink(m_SharedMemoryName);
+	}
+} // ::~CLookupDaemon()
+
+bool CLookupDaemon::Run(unsigned int reloadInterval)
+{
+	if (!m_SocketPath.empty() && !Listen())
+	{
+		return false;
+	}
+
+	m_Running = true;
+
+	// Files are polled on their own thread, the event loop never waits for a reload
+	std::thread reloader([this, reloadInterval]()
+	{
+		auto nextReload = std::chrono::steady_clock::now() + std::chrono::milliseconds(reloadInterval);
+		while (m_Running)
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(std::min(reloadInterval, 100u)));
+			if (std::chrono::steady_clock::now() >= nextReload)
+			{
+				Reload();
+				nextReload = std::chrono::steady_clock::now() + std::chrono::milliseconds(reloadInterval);
+			}
+		}
+	});
+
+	std::vector<pollfd> vPollFds;
+	while (m_Running)
+	{
+		vPollFds.clear();
+		for (const Connection& connection : m_Connections)
+		{
+			vPollFds.push_back({ connection.m_Socket, static_cast<short>(POLLIN | (connection.m_Output.empty() ? 0 : POLLOUT)), 0 });
+		}
+
+		if (m_Listener >= 0)
+		{
+			vPollFds.push_back({ m_Listener, POLLIN, 0 });
+		}
+
+		if (poll(vPollFds.data(), static_cast<nfds_t>(vPollFds.size()), 250) <= 0)
+		{
+			continue;
+		}
+
+		// Connections accepted now are polled in the next round
+		const size_t numConnections = m_Connections.size();
+		if (m_Listener >= 0 && (vPollFds.back().revents & POLLIN))
+		{
+			Accept();
+		}
+
+		std::vector<bool> vClosed(numConnections, false);
+		for (size_t i = 0; i < numConnections; i++)
+		{
+			const short events = vPollFds[i].revents;
+			Connection& connection = m_Connections[i];
+
+			if (events & (POLLIN | POLLHUP | POLLERR))
+			{
+				vClosed[i] = !Receive(connection);
+			}
+			if (!vClosed[i] && !connection.m_Output.empty())
+			{
+				vClosed[i] = !Send(connection);
+			}
+		}
+
+		for (size_t i = numConnections; i-- > 0;)
+		{
+			if (vClosed[i])
+			{
+				close(m_Connections[i].m_Socket);
+				m_Connections.erase(m_Connections.begin() + static_cast<std::ptrdiff_t>(i));
+			}
+		}
+	}
+
+	reloader.join();
+	return true;
+} // bool ::Run(unsigned int reloadInterval)
+
+SharedSnapshot CLookupDaemon::GetSnapshot() const
+{
+	std::lock_guard<std::mutex> lock(m_SnapshotMutex);
+	return m_Snapshot;
+} // SharedSnapshot ::GetSnapshot() const
+
+bool CLookupDaemon::Reload()
+{
+	std::lock_guard<std::mutex> lock(m_ReloadMutex);
+
+	const SharedSnapshot pPrevious = GetSnapshot();
+	bool bChanged = !pPrevious;
+	bool bSuccess = true;
+
+	auto refresh = [&](Source& source, const SharedTable& pCurrent) -> SharedTable
+	{
+		std::error_code ec;
+		const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(source.m_Path, ec);
+		if (pCurrent && (ec || writeTime == source.m_WriteTime))
+		{
+			return pCurrent;
+		}
+
+		try
+		{
+			SharedTable pTable = LoadTable(source);
+
+			// Still being written, try again on the next round
+			if (std::filesystem::last_write_time(source.m_Path, ec) != writeTime || ec)
+			{
+				if (pCurrent)
+				{
+					return pCurrent;
+				}
+			}
+
+			source.m_WriteTime = writeTime;
+			bChanged = true;
+			if (pCurrent)
+			{
+				printf("Reloaded %s (%zu entries)\n", source.m_Path.string().c_str(), pTable->GetSize());
+			}
+			return pTable;
+		}
+		catch (const std::exception& ex)
+		{
+			printf("Error: %s: %s\n", source.m_Path.string().c_str(), ex.what());
+			bSuccess &= static_cast<bool>(pCurrent);
+			return pCurrent;
+		}
+	};
+
+	std::vector<CTextSnapshot::Language> vLanguages;
+	vLanguages.reserve(m_Sources.size());
+
+	for (size_t i = 0; i < m_Sources.size(); i++)
+	{
+		const SharedTable pCurrent = pPrevious ? pPrevious->GetLanguages()[i].m_Table : nullptr;
+		vLanguages.push_back({ m_Sources[i].m_Name, refresh(m_Sources[i], pCurrent) });
+	}
+
+	SharedTable pLabels;
+	if (!m_LabelsSource.m_Path.empty())
+	{
+		pLabels = refresh(m_LabelsSource, pPrevious ? pPrevious->GetLabels() : nullptr);
+	}
+
+	if (!bSuccess)
+	{
+		return false;
+	}
+
+	if (bChanged)
+	{
+		const SharedSnapshot pSnapshot = std::make_shared<const CTextSnapshot>(std::move(vLanguages), std::move(pLabels), ++m_Generation);
+		{
+			std::lock_guard<std::mutex> snapshotLock(m_SnapshotMutex);
+			m_Snapshot = pSnapshot;
+		}
+
+		if (!m_SharedMemoryName.empty())
+		{
+			CSharedTableWriter::Publish(m_SharedMemoryName, *pSnapshot);
+		}
+	}
+	return true;
+} // bool ::Reload()
+
+bool CLookupDaemon::PublishSharedMemory(const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(m_ReloadMutex);
+
+	if (!CSharedTableWriter::Publish(name, *GetSnapshot()))
+	{
+		return false;
+	}
+	m_SharedMemoryName = name;
+	return true;
+} // bool ::PublishSharedMemory(const string& name)
+
+void CLookupDaemon::FindLanguages(const std::string& textDir)
+{
+	std::vector<std::filesystem::directory_entry> vEntries(std::filesystem::directory_iterator(textDir), {});
+	std::sort(vEntries.begin(), vEntries.end());
+
+	for (const std::filesystem::directory_entry& entry : vEntries)
+	{
+		if (entry.is_directory() && std::filesystem::exists(entry.path() / "global.gxt2"))
+		{
+			m_Sources.push_back({ entry.path().filename().string(), entry.path() / "global.gxt2", {} });
+		}
+		else if (entry.is_regular_file() && entry.path().extension() == ".gxt2")
+		{
+			m_Sources.push_back({ entry.path().stem().string(), entry.path(), {} });
+		}
+	}
+
+	if (m_Sources.empty())
+	{
+		throw std::runtime_error("No .gxt2 tables found in " + textDir);
+	}
+	if (m_Sources.size() > 0xFFFF)
+	{
+		throw std::runtime_error("Too many languages in " + textDir);
+	}
+} // void ::FindLanguages(const string& textDir)
+
+SharedTable CLookupDaemon::LoadTable(const Source& source) const
+{
+	std::unique_ptr<CFile> pFile;
+	if (source.m_Path.extension() == ".gxt2")
+	{
+		pFile = std::make_unique<CGxt2File>(source.m_Path.string(), CFile::FLAGS_READ_COMPILED);
+	}
+	else
+	{
+		pFile = std::make_unique<CHashDatabase>(source.m_Path.string(), CFile::FLAGS_READ_DECOMPILED);
+	}
+
+	if (!pFile->ReadEntries())
+	{
+		throw std::runtime_error("Failed to read content.");
+	}
+	return std::make_shared<const CTextTable>(pFile->GetDataConst());
+} // SharedTable ::LoadTable(const Source& source) const
+
+bool CLookupDaemon::Listen()
+{
+	sockaddr_un address = {};
+	address.sun_family = AF_UNIX;
+
+	if (m_SocketPath.size() >= sizeof(address.sun_path))
+	{
+		printf("Error: Socket path %s is too long.\n", m_SocketPath.c_str());
+		return false;
+	}
+	memcpy(address.sun_path, m_SocketPath.c_str(), m_SocketPath.size() + 1);
+
+	// A previous instance that did not shut down cleanly leaves its socket behind
+	std::error_code ec;
+	if (std::filesystem::is_socket(m_SocketPath, ec))
+	{
+		unlink(m_SocketPath.c_str());
+	}
+
+	m_Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (m_Listener < 0)
+	{
+		printf("Error: Could not create socket: %s\n", strerror(errno));
+		return false;
+	}
+
+	if (bind(m_Listener, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 || listen(m_Listener, SOMAXCONN) != 0)
+	{
+		printf("Error: Could not listen on %s: %s\n", m_SocketPath.c_str(), strerror(errno));
+		close(m_Listener);
+		m_Listener = -1;
+		return false;
+	}
+
+	fcntl(m_Listener, F_SETFL, fcntl(m_Listener, F_GETFL) | O_NONBLOCK);
+	return true;
+} // bool ::Listen()
+
+void CLookupDaemon::Accept()
+{
+	for (;;)
+	{
+		const int client = accept(m_Listener, nullptr, nullptr);
+		if (client < 0)
+		{
+			return;
+		}
+
+		fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+		fcntl(client, F_SETFD, FD_CLOEXEC);
+		m_Connections.push_back({ client, {}, {} });
+	}
+} // void ::Accept()
+
+bool CLookupDaemon::Receive(Connection& connection)
+{
+	char buffer[64 * 1024];
+
+	// Requests are answered after every read, the input never holds more than one partial request and a read
+	for (;;)
+	{
+		const ssize_t received = recv(connection.m_Socket, buffer, sizeof(buffer), 0);
+		if (received > 0)
+		{
+			connection.m_Input.append(buffer, static_cast<size_t>(received));
+			if (!HandleRequests(connection))
+			{
+				return false;
+			}
+			continue;
+		}
+		if (received == 0)
+		{
+			return false;
+		}
+		if (errno == EINTR)
+		{
+			continue;
+		}
+		if (errno == EAGAIN || errno == EWOULDBLOCK)
+		{
+			break;
+		}
+		return false;
+	}
+	return true;
+} // bool ::Receive(Connection& connection)
+
+bool CLookupDaemon::HandleRequests(Connection& connection)
+{
+	// Answer every complete request, a batch may span several reads
+	size_t consumed = 0;
+	while (connection.m_Input.size() - consumed >= sizeof(unsigned int))
+	{
+		unsigned int uLength = 0;
+		memcpy(&uLength, connection.m_Input.data() + consumed, sizeof(uLength));
+
+		if (uLength == 0 || uLength > MAX_MESSAGE_SIZE)
+		{
+			return false;
+		}
+		if (connection.m_Input.size() - consumed - sizeof(uLength) < uLength)
+		{
+			break;
+		}
+
+		HandleRequest(connection.m_Input.data() + consumed + sizeof(uLength), uLength, connection.m_Output);
+		consumed += sizeof(uLength) + uLength;
+
+		// Requests keep coming but the answers are never read
+		if (connection.m_Output.size() > MAX_PENDING_OUTPUT)
+		{
+			return false;
+		}
+	}
+	connection.m_Input.erase(0, consumed);
+
+	return true;
+} // bool ::HandleRequests(Connection& connection)
+
+bool CLookupDaemon::Send(Connection& connection)
+{
+	size_t sent = 0;
+	while (sent < connection.m_Output.size())
+	{
+		const ssize_t result = send(connection.m_Socket, connection.m_Output.data() + sent, connection.m_Output.size() - sent, MSG_NOSIGNAL);
+		if (result > 0)
+		{
+			sent += static_cast<size_t>(result);
+			continue;
+		}
+		if (result < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (result < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+		{
+			break;
+		}
+		return false;
+	}
+	connection.m_Output.erase(0, sent);
+
+	return true;
+} // bool ::Send(Connection& connection)
+
+void CLookupDaemon::HandleRequest(const char* pRequest, size_t size, std::string& szResponse) const
+{
+	// One snapshot per batch, a concurrent reload never blocks or tears it
+	const SharedSnapshot pSnapshot = GetSnapshot();
+
+	const size_t start = szResponse.size();
+	Append<unsigned int>(szResponse, 0);
+	Append<unsigned char>(szResponse, STATUS_OK);
+
+	CRequestReader reader(pRequest, size);
+	unsigned char uOp = 0;
+	reader.Read(uOp);
+
+	bool bValid = true;
+	unsigned char uStatus = STATUS_OK;
+
+	switch (uOp)
+	{
+	case OP_LANGUAGES:
+	{
+		Append<unsigned short>(szResponse, static_cast<unsigned short>(pSnapshot->GetLanguages().size()));
+		for (const CTextSnapshot::Language& language : pSnapshot->GetLanguages())
+		{
+			Append<unsigned short>(szResponse, static_cast<unsigned short>(language.m_Name.size()));
+			szResponse += language.m_Name;
+		}
+		break;
+	}
+	case OP_LOOKUP_HASH:
+	{
+		unsigned int uCount = 0;
+		bValid = reader.Read(uCount) && reader.GetRemaining() == static_cast<size_t>(uCount) * 6;
+
+		Append<unsigned int>(szResponse, uCount);
+		for (unsigned int i = 0; bValid && i < uCount; i++)
+		{
+			unsigned short uLanguage = 0;
+			unsigned int uHash = 0;
+			reader.Read(uLanguage);
+			reader.Read(uHash);
+			AppendText(szResponse, pSnapshot->GetTable(uLanguage), uHash);
+		}
+		break;
+	}
+	case OP_LOOKUP_LABEL:
+	{
+		unsigned int uCount = 0;
+		bValid = reader.Read(uCount) && reader.GetRemaining() >= static_cast<size_t>(uCount) * 4;
+
+		Append<unsigned int>(szResponse, uCount);
+
+		std::string szLabel;
+		for (unsigned int i = 0; bValid && i < uCount; i++)
+		{
+			unsigned short uLanguage = 0, uLength = 0;
+			const char* pLabel = nullptr;
+			bValid = reader.Read(uLanguage) && reader.Read(uLength) && reader.Read(pLabel, uLength);
+			if (bValid)
+			{
+				szLabel.assign(pLabel, uLength);
+				AppendText(szResponse, pSnapshot->GetTable(uLanguage), rage::atStringHash(szLabel.c_str()));
+			}
+		}
+		break;
+	}
+	case OP_LABEL_NAME:
+	{
+		unsigned int uCount = 0;
+		bValid = reader.Read(uCount) && reader.GetRemaining() == static_cast<size_t>(uCount) * 4;
+
+		Append<unsigned int>(szResponse, uCount);
+		for (unsigned int i = 0; bValid && i < uCount; i++)
+		{
+			unsigned int uHash = 0;
+			reader.Read(uHash);
+			AppendText(szResponse, pSnapshot->GetLabels().get(), uHash);
+		}
+		break;
+	}
+	default:
+		uStatus = STATUS_UNKNOWN_OP;
+		break;
+	}
+
+	if (!bValid)
+	{
+		uStatus = STATUS_BAD_REQUEST;
+	}
+	if (uStatus != STATUS_OK)
+	{
+		szResponse.resize(start + sizeof(unsigned int));
+		Append<unsigned char>(szResponse, uStatus);
+	}
+
+	const unsigned int uLength = static_cast<unsigned int>(szResponse.size() - start - sizeof(unsigned int));
+	memcpy(szResponse.data() + start, &uLength, sizeof(uLength));
+} // void ::HandleRequest(const char* pRequest, size_t size, string& szResponse) const
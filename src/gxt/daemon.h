@@ -0,0 +1,108 @@
+//
+//	gxt/daemon.h
+//
+
+#ifndef _DAEMON_H_
+#define _DAEMON_H_
+
+// Project
+#include "snapshot.h"
+
+// C/C++
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+// Keeps the tables of every language resident and answers batched lookups
+// over a Unix domain socket. Integers on the wire are in host byte order,
+// the socket is local only.
+//
+//   request  = u32 length, u8 op, payload[length - 1]
+//   response = u32 length, u8 status, payload[length - 1]
+//
+//   OP_LANGUAGES      -> u16 count, count * (u16 length, name)
+//   OP_LOOKUP_HASH    u32 count, count * (u16 language, u32 hash)
+//   OP_LOOKUP_LABEL   u32 count, count * (u16 language, u16 length, label)
+//   OP_LABEL_NAME     u32 count, count * (u32 hash)
+//                     -> u32 count, count * (u32 length or NOT_FOUND, text)
+//
+// Languages are addressed by their index in the OP_LANGUAGES list, which
+// is fixed when the daemon starts.
+class CLookupDaemon
+{
+public:
+	enum
+	{
+		OP_LANGUAGES = 1,
+		OP_LOOKUP_HASH,
+		OP_LOOKUP_LABEL,
+		OP_LABEL_NAME
+	};
+	enum
+	{
+		STATUS_OK = 0,
+		STATUS_BAD_REQUEST,
+		STATUS_UNKNOWN_OP
+	};
+	static constexpr unsigned int NOT_FOUND = 0xFFFFFFFF;
+	static constexpr unsigned int MAX_MESSAGE_SIZE = 16 << 20;
+	static constexpr size_t MAX_PENDING_OUTPUT = 64 << 20;		// A client that does not read its answers is dropped past this
+public:
+	// Every <textDir>/<language>/global.gxt2 becomes one language, without
+	// a socket path the daemon only publishes to shared memory.
+	CLookupDaemon(const std::string& socketPath, const std::string& textDir, const std::string& labelsFile = "");
+	virtual ~CLookupDaemon();
+
+	// Serves until Stop() is called, returns false if the socket failed
+	bool Run(unsigned int reloadInterval);
+	void Stop() { m_Running = false; }
+
+	// Re-reads files whose modification time changed and publishes a new
+	// snapshot, readers keep using the previous one until their batch ends.
+	bool Reload();
+
+	SharedSnapshot GetSnapshot() const;
+
+	// Also publishes every snapshot as a POSIX shared memory segment, see
+	// CSharedTableReader. The segment is unlinked when the daemon exits.
+	bool PublishSharedMemory(const std::string& name);
+private:
+	struct Source
+	{
+		std::string m_Name;
+		std::filesystem::path m_Path;
+		std::filesystem::file_time_type m_WriteTime;
+	};
+	struct Connection
+	{
+		int m_Socket;
+		std::string m_Input;
+		std::string m_Output;
+	};
+
+	void FindLanguages(const std::string& textDir);
+	SharedTable LoadTable(const Source& source) const;
+
+	bool Listen();
+	void Accept();
+	bool Receive(Connection& connection);
+	bool HandleRequests(Connection& connection);
+	bool Send(Connection& connection);
+	void HandleRequest(const char* pRequest, size_t size, std::string& szResponse) const;
+private:
+	std::string m_SocketPath;
+	std::string m_SharedMemoryName;
+	std::vector<Source> m_Sources;
+	Source m_LabelsSource;
+	std::vector<Connection> m_Connections;
+	mutable std::mutex m_SnapshotMutex;		// Only guards the swap, std::atomic<shared_ptr> is missing from libc++
+	SharedSnapshot m_Snapshot;
+	std::atomic<bool> m_Running;
+	std::mutex m_ReloadMutex;
+	unsigned long long m_Generation;
+	int m_Listener;
+};
+
+#endif // !_DAEMON_H_
@@ -0,0 +1,117 @@
+//
+//	gxt/extract.cpp
+//
+
+// Project
+#include "extract.h"
+#include "main/main.h"
+#include "data/stringhash.h"
+
+// C/C++
+#include <format>
+#include <filesystem>
+
+CExtractor::CExtractor(const std::string& listFile, const std::vector<std::string>& inputFiles, const std::string& outfile) :
+	m_InputFiles(inputFiles),
+	m_OutputFile(outfile),
+	m_TempFile(outfile + ".tmp"),
+	m_Output(nullptr)
+{
+	if (!LoadList(listFile))
+	{
+		throw std::runtime_error(std::format("The specified file {} could not be opened.", listFile));
+	}
+
+	// Written aside and renamed once every input is read, the output may be one of them
+	m_Output = GXT_NEW CGxt2File(m_TempFile, CFile::FLAGS_WRITE_COMPILED);
+
+	assert(m_Output);
+} // ::CExtractor()
+
+CExtractor::~CExtractor()
+{
+	Reset();
+} // ::~CExtractor()
+
+void CExtractor::Reset()
+{
+	if (m_Output)
+	{
+		delete m_Output;
+		m_Output = nullptr;
+
+		std::error_code ec;
+		std::filesystem::remove(m_TempFile, ec);
+	}
+	m_Hashes.Clear();
+} // void ::Reset()
+
+bool CExtractor::Run()
+{
+	for (const std::string& inputFile : m_InputFiles)
+	{
+		CGxt2File input(inputFile, CFile::FLAGS_READ_COMPILED);
+
+		const bool bSuccess = input.ReadEntries([this](unsigned int uHash) -> bool
+		{
+			return m_Hashes.Contains(uHash);
+		});
+
+		if (!bSuccess)
+		{
+			return false;
+		}
+
+		// Later inputs override earlier ones, same as gxt2merge
+		m_Output->SetData(input.TakeData());
+	}
+
+	if (!m_Output->WriteEntries())
+	{
+		return false;
+	}
+
+	// Closed before the rename
+	delete m_Output;
+	m_Output = nullptr;
+
+	std::error_code ec;
+	std::filesystem::rename(m_TempFile, m_OutputFile, ec);
+	if (ec)
+	{
+		std::filesystem::remove(m_TempFile, ec);
+		return false;
+	}
+	return true;
+} // bool ::Run()
+
+bool CExtractor::LoadList(const std::string& listFile)
+{
+	std::ifstream file(listFile);
+	if (!file.is_open())
+	{
+		return false;
+	}
+
+	// One label or 0x%08X hash per line, as written by labels.txt or GenerateUsedLabelList
+	std::string line;
+	while (std::getline(file, line))
+	{
+		const size_t first = line.find_first_not_of(" \t\r");
+		if (first == std::string::npos)
+		{
+			continue;
+		}
+		line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+
+		if (line.starts_with("0x") && line.size() == 10)
+		{
+			m_Hashes.Insert(strtoul(line.c_str(), NULL, 16));
+		}
+		else
+		{
+			m_Hashes.Insert(rage::atStringHash(line.c_str()));
+		}
+	}
+	return true;
+} // bool ::LoadList(const string& listFile)
@@ -0,0 +1,38 @@
+//
+//	gxt/extract.h
+//
+
+#ifndef _EXTRACT_H_
+#define _EXTRACT_H_
+
+// Project
+#include "gxt2.h"
+#include "data/hashset.h"
+
+// C/C++
+#include <vector>
+
+class CExtractor
+{
+public:
+	CExtractor(const std::string& listFile, const std::vector<std::string>& inputFiles, const std::string& outfile);
+	virtual ~CExtractor();
+
+	void Reset();
+	bool Run();
+
+	CFile* GetOutput() { return m_Output; }
+	const CFile* GetOutput() const { return m_Output; }
+
+	const CHashSet& GetHashes() const { return m_Hashes; }
+private:
+	bool LoadList(const std::string& listFile);
+private:
+	CHashSet m_Hashes;
+	std::vector<std::string> m_InputFiles;
+	std::string m_OutputFile;
+	std::string m_TempFile;
+	CFile* m_Output;			// Writes m_TempFile, nullptr once it is renamed
+};
+
+#endif // !_EXTRACT_H_
@@ -0,0 +1,286 @@
+//
+//	gxt/grep.cpp
+//
+
+// Project
+#include "grep.h"
+#include "gxt2.h"
+#include "data/parallel.h"
+
+// C/C++
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+
+namespace
+{
+	unsigned int SwapEndian(unsigned int uValue)
+	{
+		return (uValue >> 24) | ((uValue >> 8) & 0xFF00) | ((uValue << 8) & 0xFF0000) | (uValue << 24);
+	}
+
+	void ToLower(std::string& value)
+	{
+		// ASCII only, multi-byte sequences never contain bytes in 'A'..'Z'
+		for (char& c : value)
+		{
+			if (c >= 'A' && c <= 'Z')
+			{
+				c += 'a' - 'A';
+			}
+		}
+	}
+}
+
+CTableGrep::CTableGrep(const std::string& pattern, int flags /*= FLAGS_NONE*/) :
+	m_Pattern(pattern),
+	m_Flags(flags)
+{
+	if (m_Pattern.empty())
+	{
+		throw std::invalid_argument("The search pattern is empty.");
+	}
+
+	if (m_Flags & FLAGS_REGEX)
+	{
+		std::regex::flag_type regexFlags = std::regex::ECMAScript | std::regex::optimize;
+		if (m_Flags & FLAGS_IGNORE_CASE)
+		{
+			regexFlags |= std::regex::icase;
+		}
+
+		try
+		{
+			m_Regex.emplace(m_Pattern, regexFlags);
+		}
+		catch (const std::regex_error& ex)
+		{
+			throw std::invalid_argument("Invalid expression: " + std::string(ex.what()));
+		}
+	}
+	else if (m_Flags & FLAGS_IGNORE_CASE)
+	{
+		ToLower(m_Pattern);
+	}
+} // ::CTableGrep(const string& pattern, int flags)
+
+std::vector<CTableGrep::Result> CTableGrep::Search(const std::vector<std::string>& files, unsigned int numThreads /*= 0*/)
+{
+	std::vector<Result> vResults(files.size());
+	m_Tables.clear();
+	m_Tables.resize(files.size());
+
+	// Mapping and sorting the tables is spread out as well, a big tree has many files
+	RunParallel(files.size(), numThreads, [this, &files, &vResults](size_t index)
+	{
+		vResults[index].m_Path = files[index];
+		try
+		{
+			Table& table = m_Tables[index];
+			table.m_File = std::make_unique<CMappedFile>(files[index]);
+			if (!ParseTable(table.m_File->GetData(), table.m_Entries))
+			{
+				vResults[index].m_Error = "Not a valid GXT2 file.";
+				table.m_Entries.clear();
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			vResults[index].m_Error = ex.what();
+		}
+	});
+
+	// Slices end between strings and never split entries sharing a string
+	std::vector<Slice> vSlices;
+	for (size_t i = 0; i < m_Tables.size(); i++)
+	{
+		const std::vector<Entry>& vEntries = m_Tables[i].m_Entries;
+		size_t first = 0;
+
+		for (size_t entry = 1; entry < vEntries.size(); entry++)
+		{
+			if (vEntries[entry].m_Offset - vEntries[first].m_Offset >= SLICE_SIZE && vEntries[entry].m_Offset != vEntries[entry - 1].m_Offset)
+			{
+				vSlices.push_back({ i, first, entry });
+				first = entry;
+			}
+		}
+		if (first < vEntries.size())
+		{
+			vSlices.push_back({ i, first, vEntries.size() });
+		}
+	}
+
+	std::vector<std::vector<Match>> vSliceMatches(vSlices.size());
+	std::vector<std::string> vSliceErrors(vSlices.size());
+
+	RunParallel(vSlices.size(), numThreads, [this, &vSlices, &vSliceMatches, &vSliceErrors](size_t index)
+	{
+		try
+		{
+			SearchSlice(m_Tables[vSlices[index].m_Table], vSlices[index], vSliceMatches[index]);
+		}
+		catch (const std::exception& ex)
+		{
+			// std::regex gives up on pathological input with error_complexity or error_stack
+			vSliceErrors[index] = ex.what();
+		}
+	});
+
+	for (size_t i = 0; i < vSlices.size(); i++)
+	{
+		Result& result = vResults[vSlices[i].m_Table];
+		result.m_Matches.insert(result.m_Matches.end(), vSliceMatches[i].begin(), vSliceMatches[i].end());
+		if (!vSliceErrors[i].empty() && result.m_Error.empty())
+		{
+			result.m_Error = vSliceErrors[i];
+		}
+	}
+	return vResults;
+} // vector<Result> ::Search(const vector<string>& files, unsigned int numThreads)
+
+bool CTableGrep::ParseTable(std::span<const char> data, std::vector<Entry>& vEntries)
+{
+	auto ReadValue = [&data](size_t offset, bool bSwap) -> unsigned int
+	{
+		unsigned int uValue = 0;
+		memcpy(&uValue, data.data() + offset, sizeof(uValue));
+		return bSwap ? SwapEndian(uValue) : uValue;
+	};
+
+	if (data.size() < 16)
+	{
+		return false;
+	}
+
+	const unsigned int uMagic = ReadValue(0, false);
+	if (uMagic != CGxt2File::GXT2_MAGIC_LE && uMagic != CGxt2File::GXT2_MAGIC_BE)
+	{
+		return false;
+	}
+
+	const bool bSwap = uMagic == CGxt2File::GXT2_MAGIC_BE;
+	const size_t numEntries = ReadValue(4, bSwap);
+	const size_t heapStart = 8 + numEntries * 8 + 8;
+	if (heapStart > data.size())
+	{
+		return false;
+	}
+
+	vEntries.resize(numEntries);
+	for (size_t i = 0; i < numEntries; i++)
+	{
+		vEntries[i].m_Hash = ReadValue(8 + i * 8, bSwap);
+		vEntries[i].m_Offset = ReadValue(12 + i * 8, bSwap);
+
+		if (vEntries[i].m_Offset < heapStart || vEntries[i].m_Offset >= data.size())
+		{
+			return false;
+		}
+	}
+
+	std::sort(vEntries.begin(), vEntries.end(), [](const Entry& a, const Entry& b) -> bool
+	{
+		return a.m_Offset != b.m_Offset ? a.m_Offset < b.m_Offset : a.m_Hash < b.m_Hash;
+	});
+	return true;
+} // bool ::ParseTable(span<const char> data, vector<Entry>& vEntries)
+
+std::string_view CTableGrep::GetText(const Table& table, size_t entry) const
+{
+	const std::span<const char> data = table.m_File->GetData();
+	const char* szText = data.data() + table.m_Entries[entry].m_Offset;
+	const size_t maxLength = data.size() - table.m_Entries[entry].m_Offset;
+
+	// The last string of a damaged file may run into the end of the file
+	const char* szEnd = static_cast<const char*>(memchr(szText, '\0', maxLength));
+	return std::string_view(szText, szEnd ? static_cast<size_t>(szEnd - szText) : maxLength);
+} // string_view ::GetText(const Table& table, size_t entry) const
+
+void CTableGrep::SearchSlice(const Table& table, const Slice& slice, std::vector<Match>& vMatches) const
+{
+	if (m_Regex)
+	{
+		SearchEntries(table, slice, vMatches);
+		return;
+	}
+
+	const std::string_view szLast = GetText(table, slice.m_Last - 1);
+	const char* pBegin = table.m_File->GetData().data() + table.m_Entries[slice.m_First].m_Offset;
+	std::string_view szRegion(pBegin, static_cast<size_t>(szLast.data() + szLast.size() - pBegin));
+
+	// Case folding works on a private copy, the mapping is read-only
+	thread_local std::string szLowered;
+	if (m_Flags & FLAGS_IGNORE_CASE)
+	{
+		szLowered.assign(szRegion);
+		ToLower(szLowered);
+		szRegion = szLowered;
+	}
+
+	const unsigned int uRegionStart = table.m_Entries[slice.m_First].m_Offset;
+	const auto itFirst = table.m_Entries.begin() + static_cast<ptrdiff_t>(slice.m_First);
+	const auto itLast = table.m_Entries.begin() + static_cast<ptrdiff_t>(slice.m_Last);
+
+	// A match never spans a terminator, the pattern has none. find() scans with memchr first.
+	size_t pos = szRegion.find(m_Pattern);
+	while (pos != std::string_view::npos)
+	{
+		const unsigned int uOffset = uRegionStart + static_cast<unsigned int>(pos);
+		const auto it = std::upper_bound(itFirst, itLast, uOffset, [](unsigned int uValue, const Entry& entry) -> bool
+		{
+			return uValue < entry.m_Offset;
+		});
+
+		const size_t entry = static_cast<size_t>(it - table.m_Entries.begin()) - 1;
+		const std::string_view szText = GetText(table, entry);
+		const size_t textEnd = table.m_Entries[entry].m_Offset + szText.size();
+
+		if (uOffset + m_Pattern.size() <= textEnd)
+		{
+			// One match per string is enough, continue behind its terminator
+			AddMatches(table, entry, vMatches);
+			pos = textEnd + 1 - uRegionStart;
+		}
+		else
+		{
+			// Bytes no entry points at, e.g. orphaned strings left behind by an editor
+			pos++;
+		}
+
+		pos = pos < szRegion.size() ? szRegion.find(m_Pattern, pos) : std::string_view::npos;
+	}
+} // void ::SearchSlice(const Table& table, const Slice& slice, vector<Match>& vMatches) const
+
+void CTableGrep::SearchEntries(const Table& table, const Slice& slice, std::vector<Match>& vMatches) const
+{
+	for (size_t entry = slice.m_First; entry < slice.m_Last; entry++)
+	{
+		if (entry > slice.m_First && table.m_Entries[entry].m_Offset == table.m_Entries[entry - 1].m_Offset)
+		{
+			continue;
+		}
+
+		const std::string_view szText = GetText(table, entry);
+		if (std::regex_search(szText.data(), szText.data() + szText.size(), *m_Regex))
+		{
+			AddMatches(table, entry, vMatches);
+		}
+	}
+} // void ::SearchEntries(const Table& table, const Slice& slice, vector<Match>& vMatches) const
+
+void CTableGrep::AddMatches(const Table& table, size_t entry, std::vector<Match>& vMatches) const
+{
+	const unsigned int uOffset = table.m_Entries[entry].m_Offset;
+	while (entry > 0 && table.m_Entries[entry - 1].m_Offset == uOffset)
+	{
+		entry--;
+	}
+
+	// Every hash sharing the string is reported, pooled strings are common in patched files
+	const std::string_view szText = GetText(table, entry);
+	for (; entry < table.m_Entries.size() && table.m_Entries[entry].m_Offset == uOffset; entry++)
+	{
+		vMatches.push_back({ table.m_Entries[entry].m_Hash, szText });
+	}
+} // void ::AddMatches(const Table& table, size_t entry, vector<Match>& vMatches) const
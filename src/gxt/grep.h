@@ -0,0 +1,87 @@
+//
+//	gxt/grep.h
+//
+
+#ifndef _GREP_H_
+#define _GREP_H_
+
+// Project
+#include "data/mappedfile.h"
+
+// C/C++
+#include <span>
+#include <regex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <optional>
+#include <string_view>
+
+// Full-text search over compiled tables. The files are mapped and their
+// string heaps searched in place, a match offset is mapped back to its hash
+// through the entry table sorted by offset. Work is split into slices of
+// whole strings and spread over a pool of threads.
+class CTableGrep
+{
+public:
+	enum eFlags
+	{
+		FLAGS_NONE = 0,
+		FLAGS_IGNORE_CASE = 1 << 0,
+		FLAGS_REGEX = 1 << 1,
+	};
+
+	struct Match
+	{
+		unsigned int m_Hash;
+		std::string_view m_Text;	// Points into the mapping, valid as long as the grep
+	};
+
+	struct Result
+	{
+		std::string m_Path;
+		std::vector<Match> m_Matches;
+		std::string m_Error;
+	};
+public:
+	// Throws std::invalid_argument for an empty pattern or a malformed expression
+	CTableGrep(const std::string& pattern, int flags = FLAGS_NONE);
+
+	// Results come back in the order of the input files, matches in heap order
+	std::vector<Result> Search(const std::vector<std::string>& files, unsigned int numThreads = 0);
+
+	static constexpr size_t SLICE_SIZE = 256 * 1024;
+private:
+	struct Entry
+	{
+		unsigned int m_Offset;
+		unsigned int m_Hash;
+	};
+
+	struct Table
+	{
+		std::unique_ptr<CMappedFile> m_File;
+		std::vector<Entry> m_Entries;	// Sorted by offset
+	};
+
+	struct Slice
+	{
+		size_t m_Table;
+		size_t m_First;
+		size_t m_Last;
+	};
+
+	static bool ParseTable(std::span<const char> data, std::vector<Entry>& vEntries);
+
+	std::string_view GetText(const Table& table, size_t entry) const;
+	void SearchSlice(const Table& table, const Slice& slice, std::vector<Match>& vMatches) const;
+	void SearchEntries(const Table& table, const Slice& slice, std::vector<Match>& vMatches) const;
+	void AddMatches(const Table& table, size_t entry, std::vector<Match>& vMatches) const;
+private:
+	std::string m_Pattern;
+	int m_Flags;
+	std::optional<std::regex> m_Regex;
+	std::vector<Table> m_Tables;
+};
+
+#endif // !_GREP_H_
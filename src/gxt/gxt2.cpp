@@ -6,22 +6,38 @@
 #include "gxt2.h"
 #include "main/main.h"
 #include "data/stringhash.h"
+#include "data/membuf.h"
 
 // C/C++
 #include <ios>
+#include <vector>
+#include <algorithm>
 #include <format>
 #include <fstream>
+#include <filesystem>
 
 CFile::CFile()
+	: m_File(&m_FileBuffer), m_Endian(_LITTLE_ENDIAN)
 {
 	Reset();
 } // ::CFile()
 
 CFile::CFile(const std::string& fileName, int openFlags /*= FLAGS_DEFAULT*/, int endian /*= _LITTLE_ENDIAN*/)
-	: m_Endian(endian)
+	: m_File(&m_FileBuffer), m_Endian(endian)
 {
 	Reset();
-	m_File.open(fileName, static_cast<std::ios_base::openmode>(openFlags));
+
+	// A hard link may come from the conversion cache, truncating it would rewrite the cached copy too
+	if ((openFlags & std::ios_base::out) && !(openFlags & std::ios_base::in))
+	{
+		std::error_code ec;
+		if (std::filesystem::hard_link_count(fileName, ec) > 1 && !ec)
+		{
+			std::filesystem::remove(fileName, ec);
+		}
+	}
+
+	m_FileBuffer.open(fileName, static_cast<std::ios_base::openmode>(openFlags));
 
 	if (!IsOpen())
 	{
@@ -29,29 +45,48 @@ CFile::CFile(const std::string& fileName, int openFlags /*= FLAGS_DEFAULT*/, int
 	}
 } // ::CFile(const string& fileName, int openFlags = FLAGS_DEFAULT, int endian = _LITTLE_ENDIAN)
 
+CFile::CFile(std::streambuf* pBuffer, int endian /*= _LITTLE_ENDIAN*/)
+	: m_File(pBuffer), m_Endian(endian)
+{
+	Reset();
+} // ::CFile(streambuf* pBuffer, int endian = _LITTLE_ENDIAN)
+
 CFile::~CFile()
 {
-	if (IsOpen())
+	if (m_FileBuffer.is_open())
 	{
-		m_File.close();
+		m_FileBuffer.close();
 	}
 	Reset();
 } // ::~CFile()
 
 CFile& CFile::operator=(const CFile& other)
 {
-	this->m_Entries = other.m_Entries;
+	this->m_Entries = other.GetDataConst();
+	this->m_Shared.reset();
 	return *this;
 } // CFile& ::operator=(const CFile& other)
 
+CFile& CFile::operator=(CFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		this->m_Entries = std::move(other.m_Entries);
+		this->m_Shared = std::move(other.m_Shared);
+		other.Reset();
+	}
+	return *this;
+} // CFile& ::operator=(CFile&& other)
+
 void CFile::Reset()
 {
 	m_Entries.clear();
+	m_Shared.reset();
 } // void ::Reset()
 
 void CFile::Dump() const
 {
-	for (const auto& [uHash, szTextEntry] : m_Entries)
+	for (const auto& [uHash, szTextEntry] : GetDataConst())
 	{
 		std::cout << std::format("0x{:08X} = {}", uHash, szTextEntry) << std::endl;
 	}
@@ -59,14 +94,51 @@ void CFile::Dump() const
 
 bool CFile::IsOpen() const
 {
-	return m_File.is_open();
+	// Memory buffers are always open, only files can fail to
+	return m_File.rdbuf() && (m_File.rdbuf() != &m_FileBuffer || m_FileBuffer.is_open());
 } // bool ::IsOpen() const
 
 void CFile::Close()
 {
-	m_File.close();
+	m_FileBuffer.close();
 } // bool ::Close() const
 
+bool CFile::ReadEntries()
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	// Reads go into the private map, a shared table is copied out first
+	GetData();
+
+	unsigned int uHash = 0;
+	std::string szText;
+
+	while (ReadEntry(uHash, szText))
+	{
+		m_Entries.insert_or_assign(uHash, std::move(szText));
+	}
+	return true;
+} // bool ::ReadEntries()
+
+bool CFile::WriteEntries()
+{
+	return WriteRange(GetDataConst());
+} // bool ::WriteEntries()
+
+CEntryRange CFile::ReadRange()
+{
+	return CEntryRange(this);
+} // CEntryRange ::ReadRange()
+
+void CFile::SetStreamBuffer(std::streambuf* pBuffer)
+{
+	// Rebinding the stream leaves the file buffer itself open
+	m_File.rdbuf(pBuffer ? pBuffer : &m_FileBuffer);
+} // void ::SetStreamBuffer(streambuf* pBuffer)
+
 void CFile::Head()
 {
 	m_File.seekg(0, std::ios::beg);
@@ -89,21 +161,62 @@ unsigned int CFile::GetPosition()
 
 CFile::Map& CFile::GetData()
 {
+	// Writing to a shared table, take a private copy first
+	if (m_Shared)
+	{
+		m_Entries = *m_Shared;
+		m_Shared.reset();
+	}
 	return m_Entries;
 } // CFile::Map& ::GetData()
 
 const CFile::Map& CFile::GetData() const
 {
-	return m_Entries;
+	return GetDataConst();
 } // const CFile::Map& ::GetData() const
 
 const CFile::Map& CFile::GetDataConst() const
 {
-	return m_Entries;
+	return m_Shared ? *m_Shared : m_Entries;
 } // const CFile::Map& ::GetDataConst() const
 
+CFile::SharedMap CFile::ShareData()
+{
+	if (!m_Shared)
+	{
+		m_Shared = std::make_shared<const Map>(std::move(m_Entries));
+		m_Entries.clear();
+	}
+	return m_Shared;
+} // CFile::SharedMap ::ShareData()
+
+void CFile::SetData(const SharedMap& data)
+{
+	m_Entries.clear();
+	m_Shared = data;
+} // void ::SetData(const SharedMap& data)
+
+CFile::Map CFile::TakeData()
+{
+	// Nothing to steal from a table other files still hold on to
+	Map data = m_Shared ? *m_Shared : std::move(m_Entries);
+	Reset();
+	return data;
+} // CFile::Map ::TakeData()
+
+void CFile::SetData(Map&& data)
+{
+	GetData();
+
+	// Splices the nodes that are not overridden, no string is copied
+	data.merge(m_Entries);
+	m_Entries = std::move(data);
+} // void ::SetData(Map&& data)
+
 void CFile::SetData(const Map& data)
 {
+	GetData();
+
 	//m_Entries = data;
 	for (const auto& [key, value] : data)
 	{
@@ -136,84 +249,193 @@ void CFile::DoSwapEndian(unsigned int& x) const
 //-----------------------------------------------------------------------------------------
 //
 
-CMemoryFile::CMemoryFile() : CFile()
+CMemoryFile::CMemoryFile() : CFile(),
+	m_Buffer(nullptr),
+	m_Codec(nullptr)
 {
 } // ::CMemoryFile()
 
+CMemoryFile::CMemoryFile(int format, std::span<const char> data) : CFile(),
+	m_Buffer(GXT_NEW CSpanBuffer(data)),
+	m_Codec(nullptr)
+{
+	SetStreamBuffer(m_Buffer);
+	CreateCodec(format);
+} // ::CMemoryFile(int format, span<const char> data)
+
+CMemoryFile::CMemoryFile(int format, std::string& output, int endian /*= _LITTLE_ENDIAN*/) : CFile(),
+	m_Buffer(GXT_NEW CGrowableBuffer(output)),
+	m_Codec(nullptr)
+{
+	SetStreamBuffer(m_Buffer);
+	SetEndian(endian);
+	CreateCodec(format);
+} // ::CMemoryFile(int format, string& output, int endian = _LITTLE_ENDIAN)
+
+CMemoryFile::~CMemoryFile()
+{
+	// The codec still refers to the buffer
+	if (m_Codec)
+	{
+		delete m_Codec;
+		m_Codec = nullptr;
+	}
+	if (m_Buffer)
+	{
+		delete m_Buffer;
+		m_Buffer = nullptr;
+	}
+} // ::~CMemoryFile()
+
 bool CMemoryFile::ReadEntries()
 {
-	assert(false /*, "CMemoryFile::WriteEntries() should not be called!"*/);
-	return false;
+	assert(m_Codec /*, "CMemoryFile::ReadEntries() needs a format to decode!"*/);
+	if (!m_Codec || !m_Codec->ReadEntries())
+	{
+		return false;
+	}
+
+	SetEndian(m_Codec->GetEndian());
+	SetData(m_Codec->TakeData());
+	return true;
 } // bool ::ReadEntries()
 
 bool CMemoryFile::WriteEntries()
 {
-	assert(false /*, "CMemoryFile::WriteEntries() should not be called!"*/);
-	return false;
-} // bool ::WriteEntries()
+	assert(m_Codec /*, "CMemoryFile::WriteEntries() needs a format to encode!"*/);
+	if (!m_Codec)
+	{
+		return false;
+	}
 
-//-----------------------------------------------------------------------------------------
-//
+	// The codec serializes our table in place, nothing is copied
+	m_Codec->SetEndian(GetEndian());
+	m_Codec->SetData(ShareData());
 
-CGxt2File::CGxt2File(const std::string& fileName, int openFlags /*= FLAGS_READ_COMPILED*/, int endian /*= _LITTLE_ENDIAN*/) :
-	CFile(fileName, openFlags, endian)
+	const bool bSuccess = m_Codec->WriteEntries();
+	m_Codec->Reset();
+	return bSuccess;
+} // bool ::WriteEntries()
+
+bool CMemoryFile::ReadEntry(unsigned int& uHash, std::string& szText)
 {
-} // ::CGxt2File(const string& fileName, int openFlags = FLAGS_READ_COMPILED, int endian = _LITTLE_ENDIAN)
+	return m_Codec && m_Codec->ReadEntry(uHash, szText);
+} // bool ::ReadEntry(unsigned int& uHash, string& szText)
 
-bool CGxt2File::ReadEntries()
+bool CMemoryFile::WriteHeader()
 {
-	if (!IsOpen())
+	if (!m_Codec)
 	{
 		return false;
 	}
 
-	unsigned int uMagic = 0, uNumEntries = 0, uDataLength = 0;
+	m_Codec->SetEndian(GetEndian());
+	return m_Codec->WriteHeader();
+} // bool ::WriteHeader()
 
-	Head();
-	Read(&uMagic);
-	Read(&uNumEntries);
+bool CMemoryFile::WriteEntry(unsigned int uHash, std::string_view szText)
+{
+	return m_Codec && m_Codec->WriteEntry(uHash, szText);
+} // bool ::WriteEntry(unsigned int uHash, string_view szText)
 
-	if (uMagic == CGxt2File::GXT2_MAGIC_LE)
+bool CMemoryFile::WriteFooter()
+{
+	return m_Codec && m_Codec->WriteFooter();
+} // bool ::WriteFooter()
+
+int CMemoryFile::GetFormatFromExtension(const std::string& fileName)
+{
+	const size_t n = fileName.find_last_of(".");
+	const std::string szFileExtension = (n != std::string::npos) ? fileName.substr(n) : "";
+
+	if (szFileExtension == ".gxt2")
 	{
-		SetLittleEndian();
+		return FORMAT_GXT2;
 	}
-	else if (uMagic == CGxt2File::GXT2_MAGIC_BE)
+	else if (szFileExtension == ".txt")
 	{
-		SetBigEndian();
+		return FORMAT_TXT;
 	}
-	else
+	else if (szFileExtension == ".json")
 	{
-		std::cerr << "Error: Not GXT2 file format." << std::endl;
-		return false;
+		return FORMAT_JSON;
 	}
+	else if (szFileExtension == ".csv")
+	{
+		return FORMAT_CSV;
+	}
+	else if (szFileExtension == ".oxt")
+	{
+		return FORMAT_OXT;
+	}
+	return FORMAT_NONE;
+} // int ::GetFormatFromExtension(const string& fileName)
 
-	DoSwapEndian(uNumEntries);
-
-	Entry* pEntries = GXT_NEW Entry[uNumEntries];
-	for (unsigned int uEntry = 0; uEntry < uNumEntries; uEntry++)
+void CMemoryFile::CreateCodec(int format)
+{
+	switch (format)
 	{
-		Read(&pEntries[uEntry].m_Hash);
-		Read(&pEntries[uEntry].m_Offset);
-		DoSwapEndian(pEntries[uEntry].m_Hash);
-		DoSwapEndian(pEntries[uEntry].m_Offset);
+	case FORMAT_GXT2:
+		m_Codec = GXT_NEW CGxt2File(m_Buffer, GetEndian());
+		break;
+	case FORMAT_TXT:
+		m_Codec = GXT_NEW CTextFile(m_Buffer);
+		break;
+	case FORMAT_JSON:
+		m_Codec = GXT_NEW CJsonFile(m_Buffer);
+		break;
+	case FORMAT_CSV:
+		m_Codec = GXT_NEW CCsvFile(m_Buffer);
+		break;
+	case FORMAT_OXT:
+		m_Codec = GXT_NEW COxtFile(m_Buffer);
+		break;
+	case FORMAT_LABELS:
+		m_Codec = GXT_NEW CHashDatabase(m_Buffer);
+		break;
+	default:
+		delete m_Buffer;
+		m_Buffer = nullptr;
+		throw std::invalid_argument("Unknown memory file format.");
 	}
+} // void ::CreateCodec(int format)
 
-	Read(&uMagic);
-	Read(&uDataLength);
-	DoSwapEndian(uMagic);
-	DoSwapEndian(uDataLength);
+//-----------------------------------------------------------------------------------------
+//
 
-	if (uMagic != CGxt2File::GXT2_MAGIC_LE && uMagic != CGxt2File::GXT2_MAGIC_BE)
+CGxt2File::CGxt2File(const std::string& fileName, int openFlags /*= FLAGS_READ_COMPILED*/, int endian /*= _LITTLE_ENDIAN*/) :
+	CFile(fileName, openFlags, endian),
+	m_NextEntry(0),
+	m_HasTable(false)
+{
+} // ::CGxt2File(const string& fileName, int openFlags = FLAGS_READ_COMPILED, int endian = _LITTLE_ENDIAN)
+
+CGxt2File::CGxt2File(std::streambuf* pBuffer, int endian /*= _LITTLE_ENDIAN*/) :
+	CFile(pBuffer, endian),
+	m_NextEntry(0),
+	m_HasTable(false)
+{
+} // ::CGxt2File(streambuf* pBuffer, int endian = _LITTLE_ENDIAN)
+
+bool CGxt2File::ReadEntries()
+{
+	std::vector<Entry> vEntries;
+	unsigned int uDataLength = 0;
+
+	if (!ReadTable(vEntries, uDataLength))
 	{
-		std::cerr << "Expected GXT2 Magic, your file might be corrupted!" << std::endl;
-#if _DEBUG
-		__debugbreak();
-#endif
+		return false;
 	}
 
+	const unsigned int uNumEntries = static_cast<unsigned int>(vEntries.size());
+	const Entry* pEntries = vEntries.data();
+
 	const unsigned int uHeapStart = GetPosition();
 	const unsigned int uHeapLength = uDataLength - uHeapStart;
 
+	// Reads go into the private map, a shared table is copied out first
+	GetData();
+
 	char* pStringHeap = GXT_NEW char[uHeapLength];
 	Read(pStringHeap, uHeapLength);
 
@@ -242,7 +464,6 @@ bool CGxt2File::ReadEntries()
 #endif
 	}
 
-	delete[] pEntries;
 	delete[] pStringHeap;
 
 #if _DEBUG && 0
@@ -252,6 +473,187 @@ bool CGxt2File::ReadEntries()
 	return true;
 } // bool ::ReadEntries()
 
+bool CGxt2File::ReadEntries(const std::function<bool(unsigned int uHash)>& filter)
+{
+	std::vector<Entry> vEntries;
+	unsigned int uDataLength = 0;
+
+	if (!ReadTable(vEntries, uDataLength))
+	{
+		return false;
+	}
+
+	std::erase_if(vEntries, [&filter](const Entry& entry) -> bool
+	{
+		return !filter(entry.m_Hash);
+	});
+
+	// Walk the heap front to back, neighbouring strings need no seek
+	std::sort(vEntries.begin(), vEntries.end(), [](const Entry& a, const Entry& b) -> bool
+	{
+		return a.m_Offset < b.m_Offset;
+	});
+
+	// Reads go into the private map, a shared table is copied out first
+	GetData();
+
+	std::string szTextEntry;
+	for (const Entry& entry : vEntries)
+	{
+		if (entry.m_Offset >= uDataLength)
+		{
+			std::cerr << std::format("Error: Entry 0x{:08X} points outside of the string heap.", entry.m_Hash) << std::endl;
+			return false;
+		}
+		if (GetPosition() != entry.m_Offset)
+		{
+			Seek(static_cast<int>(entry.m_Offset));
+		}
+		std::getline(m_File, szTextEntry, '\0');
+		m_Entries[entry.m_Hash] = szTextEntry;
+	}
+	return true;
+} // bool ::ReadEntries(const function<bool(unsigned int uHash)>& filter)
+
+bool CGxt2File::ReadHashes(std::vector<unsigned int>& vHashes)
+{
+	std::vector<Entry> vEntries;
+	unsigned int uDataLength = 0;
+
+	if (!ReadTable(vEntries, uDataLength))
+	{
+		return false;
+	}
+
+	vHashes.clear();
+	vHashes.reserve(vEntries.size());
+	for (const Entry& entry : vEntries)
+	{
+		vHashes.push_back(entry.m_Hash);
+	}
+	return true;
+} // bool ::ReadHashes(vector<unsigned int>& vHashes)
+
+bool CGxt2File::ReadEntry(unsigned int& uHash, std::string& szText)
+{
+	if (!m_HasTable)
+	{
+		unsigned int uDataLength = 0;
+		if (!ReadTable(m_Table, uDataLength))
+		{
+			return false;
+		}
+		m_NextEntry = 0;
+		m_HasTable = true;
+	}
+
+	if (m_NextEntry >= m_Table.size())
+	{
+		return false;
+	}
+
+	// Strings are usually stored in table order, only seek if they are not
+	const Entry& entry = m_Table[m_NextEntry++];
+	if (GetPosition() != entry.m_Offset)
+	{
+		Seek(static_cast<int>(entry.m_Offset));
+	}
+
+	uHash = entry.m_Hash;
+	return static_cast<bool>(std::getline(m_File, szText, '\0'));
+} // bool ::ReadEntry(unsigned int& uHash, string& szText)
+
+bool CGxt2File::ReadTable(std::vector<Entry>& vEntries, unsigned int& uDataLength)
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	unsigned int uMagic = 0, uNumEntries = 0;
+
+	Head();
+	Read(&uMagic);
+	Read(&uNumEntries);
+
+	if (uMagic == CGxt2File::GXT2_MAGIC_LE)
+	{
+		SetLittleEndian();
+	}
+	else if (uMagic == CGxt2File::GXT2_MAGIC_BE)
+	{
+		SetBigEndian();
+	}
+	else
+	{
+		std::cerr << "Error: Not GXT2 file format." << std::endl;
+		return false;
+	}
+
+	DoSwapEndian(uNumEntries);
+
+	// The count is not trusted with the allocation, the table and the heap header have to fit in the file.
+	// Pipelined input cannot tell its size, its table grows a batch at a time until the stream runs dry.
+	std::streambuf* pBuffer = m_File.rdbuf();
+	const std::streamoff position = pBuffer->pubseekoff(0, std::ios::cur, std::ios::in);
+	const std::streamoff fileSize = pBuffer->pubseekoff(0, std::ios::end, std::ios::in);
+	pBuffer->pubseekpos(position, std::ios::in);
+
+	const uint64_t uHeapStart = 16 + static_cast<uint64_t>(uNumEntries) * sizeof(Entry);
+	if (fileSize >= 0 && uHeapStart > static_cast<uint64_t>(fileSize))
+	{
+		std::cerr << "Error: The entry count does not fit in the file." << std::endl;
+		return false;
+	}
+
+	constexpr size_t READ_BATCH_SIZE = 64 * 1024;
+	vEntries.clear();
+	while (vEntries.size() < uNumEntries && m_File)
+	{
+		const size_t first = vEntries.size();
+		const size_t count = std::min<size_t>(uNumEntries - first, READ_BATCH_SIZE);
+		vEntries.resize(first + count);
+		Read(vEntries.data() + first, static_cast<unsigned int>(count * sizeof(Entry)));
+	}
+
+	Read(&uMagic);
+	Read(&uDataLength);
+	if (!m_File)
+	{
+		std::cerr << "Error: The file ends inside the entry table." << std::endl;
+		return false;
+	}
+	DoSwapEndian(uMagic);
+	DoSwapEndian(uDataLength);
+
+	if (uMagic != CGxt2File::GXT2_MAGIC_LE && uMagic != CGxt2File::GXT2_MAGIC_BE)
+	{
+		std::cerr << "Expected GXT2 Magic, your file might be corrupted!" << std::endl;
+#if _DEBUG
+		__debugbreak();
+#endif
+	}
+
+	// Every string has to start inside the heap, readers index it without further checks
+	if (uDataLength < uHeapStart || (fileSize >= 0 && uDataLength > static_cast<uint64_t>(fileSize)))
+	{
+		std::cerr << "Error: The string heap does not fit in the file." << std::endl;
+		return false;
+	}
+	for (Entry& entry : vEntries)
+	{
+		DoSwapEndian(entry.m_Hash);
+		DoSwapEndian(entry.m_Offset);
+
+		if (entry.m_Offset < uHeapStart || entry.m_Offset >= uDataLength)
+		{
+			std::cerr << std::format("Error: Entry 0x{:08X} points outside of the string heap.", entry.m_Hash) << std::endl;
+			return false;
+		}
+	}
+	return true;
+} // bool ::ReadTable(vector<Entry>& vEntries, unsigned int& uDataLength)
+
 bool CGxt2File::WriteEntries()
 {
 	if (!IsOpen())
@@ -259,7 +661,7 @@ bool CGxt2File::WriteEntries()
 		return false;
 	}
 
-	unsigned int uCount = static_cast<unsigned int>(m_Entries.size());
+	unsigned int uCount = static_cast<unsigned int>(GetDataConst().size());
 	unsigned int uOffset = (uCount * 2 + 4) * 4;
 
 	if (IsLittleEndian())
@@ -274,7 +676,7 @@ bool CGxt2File::WriteEntries()
 	DoSwapEndian(uCount);
 	Write(&uCount);
 
-	for (const auto& [uHash, szTextEntry] : m_Entries)
+	for (const auto& [uHash, szTextEntry] : GetDataConst())
 	{
 		unsigned int uHashSwapped = uHash;
 		unsigned int uOffsetSwapped = uOffset;
@@ -298,7 +700,7 @@ bool CGxt2File::WriteEntries()
 	DoSwapEndian(uOffset);
 	Write(&uOffset);
 
-	for (const auto& [uHash, szTextEntry] : m_Entries)
+	for (const auto& [uHash, szTextEntry] : GetDataConst())
 	{
 		WriteStr(szTextEntry.c_str());
 	}
@@ -309,91 +711,276 @@ bool CGxt2File::WriteEntries()
 //-----------------------------------------------------------------------------------------
 //
 
-CTextFile::CTextFile(const std::string& fileName, int openFlags /*= FLAGS_READ_DECOMPILED*/) :
-	CFile(fileName, openFlags)
+CGxt2Writer::CGxt2Writer(const std::string& fileName, int endian /*= _LITTLE_ENDIAN*/) :
+	CFile(fileName, FLAGS_WRITE_COMPILED, endian),
+	m_TablePath(fileName + ".table.tmp"),
+	m_HeapPath(fileName + ".heap.tmp"),
+	m_Count(0),
+	m_HeapSize(0)
 {
-} // ::CTextFile(const string& fileName, int openFlags = FLAGS_READ_DECOMPILED)
+	constexpr std::ios_base::openmode tempFlags = std::fstream::in | std::fstream::out | std::fstream::trunc | std::fstream::binary;
+
+	m_Table.open(m_TablePath, tempFlags);
+	m_Heap.open(m_HeapPath, tempFlags);
 
-bool CTextFile::ReadEntries()
+	if (!m_Table.is_open() || !m_Heap.is_open())
+	{
+		RemoveTemporaryFiles();
+		throw std::runtime_error(std::format("The temporary files for {} could not be created.", fileName));
+	}
+} // ::CGxt2Writer(const string& fileName, int endian = _LITTLE_ENDIAN)
+
+CGxt2Writer::~CGxt2Writer()
+{
+	RemoveTemporaryFiles();
+} // ::~CGxt2Writer()
+
+bool CGxt2Writer::AddEntry(unsigned int uHash, std::string_view szText)
 {
 	if (!IsOpen())
 	{
 		return false;
 	}
 
-	std::string line;
-	while (std::getline(m_File, line))
-	{
-		const std::string szHash = line.substr(0, 10);
-		const std::string szText = line.substr(13);
-		const unsigned int uHash = strtoul(szHash.c_str(), NULL, 16);
+	const unsigned int uLength = static_cast<unsigned int>(szText.size()) + 1;
 
-		m_Entries[uHash] = szText;
+	// Offsets are 32-bit, the whole table has to stay addressable
+	if (static_cast<unsigned long long>(m_Count + 1) * 8 + 16 + m_HeapSize + uLength > 0xFFFFFFFFull)
+	{
+		std::cerr << "Error: Text table exceeds the 4 GB limit of the GXT2 format." << std::endl;
+		return false;
 	}
-	return true;
-} // bool ::ReadEntries()
 
-bool CTextFile::WriteEntries()
+	m_Table.write(reinterpret_cast<const char*>(&uHash), sizeof(uHash));
+	m_Table.write(reinterpret_cast<const char*>(&m_HeapSize), sizeof(m_HeapSize));
+	m_Heap.write(szText.data(), static_cast<std::streamsize>(szText.size()));
+	m_Heap.put('\0');
+
+	m_HeapSize += uLength;
+	m_Count++;
+
+	return m_Table.good() && m_Heap.good();
+} // bool ::AddEntry(unsigned int uHash, string_view szText)
+
+bool CGxt2Writer::Finish()
 {
 	if (!IsOpen())
 	{
 		return false;
 	}
 
-	for (const auto& [uHash, szTextEntry] : m_Entries)
+	const unsigned int uHeapStart = (m_Count * 2 + 4) * 4;
+	unsigned int uCount = m_Count;
+	unsigned int uDataLength = uHeapStart + m_HeapSize;
+
+	if (IsLittleEndian())
 	{
-		m_File << std::format("0x{:08X} = {}", uHash, szTextEntry) << std::endl;
+		Write(&CGxt2File::GXT2_MAGIC_LE);
+	}
+	else if (IsBigEndian())
+	{
+		Write(&CGxt2File::GXT2_MAGIC_BE);
+	}
+
+	DoSwapEndian(uCount);
+	Write(&uCount);
+
+	// Rebase the heap offsets while copying the table over
+	std::vector<unsigned int> vChunk(2 * 4096);
+
+	m_Table.flush();
+	m_Table.seekg(0, std::ios::beg);
+
+	for (unsigned int uRemaining = m_Count; uRemaining > 0;)
+	{
+		const unsigned int uBatch = std::min(uRemaining, static_cast<unsigned int>(vChunk.size() / 2));
+		m_Table.read(reinterpret_cast<char*>(vChunk.data()), static_cast<std::streamsize>(uBatch) * 8);
+
+		for (unsigned int i = 0; i < uBatch; i++)
+		{
+			vChunk[i * 2 + 1] += uHeapStart;
+			DoSwapEndian(vChunk[i * 2 + 0]);
+			DoSwapEndian(vChunk[i * 2 + 1]);
+		}
+		Write(vChunk.data(), uBatch * 8);
+		uRemaining -= uBatch;
 	}
+
+	if (IsLittleEndian())
+	{
+		Write(&CGxt2File::GXT2_MAGIC_LE);
+	}
+	else if (IsBigEndian())
+	{
+		Write(&CGxt2File::GXT2_MAGIC_BE);
+	}
+	DoSwapEndian(uDataLength);
+	Write(&uDataLength);
+
+	if (m_HeapSize > 0)
+	{
+		m_Heap.flush();
+		m_Heap.seekg(0, std::ios::beg);
+		m_File << m_Heap.rdbuf();
+	}
+
+	m_File.flush();
+	const bool bSuccess = m_Table.good() && m_Heap.good() && m_File.good();
+
+	RemoveTemporaryFiles();
+
+	return bSuccess;
+} // bool ::Finish()
+
+void CGxt2Writer::RemoveTemporaryFiles()
+{
+	std::error_code ec;
+
+	if (m_Table.is_open())
+	{
+		m_Table.close();
+	}
+	if (m_Heap.is_open())
+	{
+		m_Heap.close();
+	}
+	std::filesystem::remove(m_TablePath, ec);
+	std::filesystem::remove(m_HeapPath, ec);
+} // void ::RemoveTemporaryFiles()
+
+//-----------------------------------------------------------------------------------------
+//
+
+CTextFile::CTextFile(const std::string& fileName, int openFlags /*= FLAGS_READ_DECOMPILED*/) :
+	CFile(fileName, openFlags)
+{
+} // ::CTextFile(const string& fileName, int openFlags = FLAGS_READ_DECOMPILED)
+
+CTextFile::CTextFile(std::streambuf* pBuffer) :
+	CFile(pBuffer)
+{
+} // ::CTextFile(streambuf* pBuffer)
+
+bool CTextFile::ReadEntry(unsigned int& uHash, std::string& szText)
+{
+	std::string line;
+	if (!IsOpen() || !std::getline(m_File, line))
+	{
+		return false;
+	}
+
+	const std::string szHash = line.substr(0, 10);
+	uHash = strtoul(szHash.c_str(), NULL, 16);
+	szText = line.substr(13);
+
 	return true;
-} // bool ::WriteEntries()
+} // bool ::ReadEntry(unsigned int& uHash, string& szText)
+
+bool CTextFile::WriteEntry(unsigned int uHash, std::string_view szText)
+{
+	m_File << std::format("0x{:08X} = {}", uHash, szText) << '\n';
+	return m_File.good();
+} // bool ::WriteEntry(unsigned int uHash, string_view szText)
 
 //-----------------------------------------------------------------------------------------
 //
 
 CJsonFile::CJsonFile(const std::string& fileName, int openFlags /*= FLAGS_READ_DECOMPILED*/) :
 	CFile(fileName, openFlags),
-	m_Data()
+	m_NumWritten(0),
+	m_InObject(false)
 {
 } // ::CJsonFile(const string& fileName, int openFlags = FLAGS_READ_DECOMPILED)
 
-bool CJsonFile::ReadEntries()
+CJsonFile::CJsonFile(std::streambuf* pBuffer) :
+	CFile(pBuffer),
+	m_NumWritten(0),
+	m_InObject(false)
+{
+} // ::CJsonFile(streambuf* pBuffer)
+
+bool CJsonFile::ReadEntry(unsigned int& uHash, std::string& szText)
 {
 	if (!IsOpen())
 	{
 		return false;
 	}
 
-	m_Data.clear();
-	m_File >> m_Data;
-
-	for (const auto& [key, val] : m_Data.items())
+	// Walk the top level object ourselves and only let the parser decode
+	// one key and value at a time, so the document is never held in memory.
+	if (!m_InObject && m_File.peek() == 0xEF)
 	{
-		const unsigned int uHash = strtoul(key.c_str(), NULL, 16);
-		m_Entries[uHash] = val.get<std::string>();
+		// UTF-8 byte order mark, as written by most Windows editors
+		char bom[3] = {};
+		if (!m_File.read(bom, sizeof(bom)) || bom[1] != '\xBB' || bom[2] != '\xBF')
+		{
+			throw std::runtime_error("Expected a JSON object.");
+		}
 	}
-	return true;
-} // bool ::ReadEntries()
 
-bool CJsonFile::WriteEntries()
-{
-	if (!IsOpen())
+	char cToken = 0;
+	if (!(m_File >> cToken))
 	{
 		return false;
 	}
 
-	m_Data.clear();
+	if (!m_InObject)
+	{
+		if (cToken != '{')
+		{
+			throw std::runtime_error("Expected a JSON object.");
+		}
+		m_InObject = true;
 
-	for (const auto& [uHash, szTextEntry] : m_Entries)
+		if (!(m_File >> cToken) || cToken == '}')
+		{
+			return false;
+		}
+		m_File.unget();
+	}
+	else if (cToken == '}')
+	{
+		return false;
+	}
+	else if (cToken != ',')
 	{
-		const std::string szHash = std::format("0x{:08X}", uHash);
+		throw std::runtime_error(std::format("Unexpected '{}' in JSON object.", cToken));
+	}
+
+	nlohmann::json key, value;
+	m_File >> key;
 
-		m_Data[szHash] = szTextEntry;
+	if (!(m_File >> cToken) || cToken != ':')
+	{
+		throw std::runtime_error("Expected ':' in JSON object.");
 	}
+	m_File >> value;
 
-	m_File << m_Data.dump(1, '\t');
+	uHash = strtoul(key.get<std::string>().c_str(), NULL, 16);
+	szText = value.get<std::string>();
 
 	return true;
-} // bool ::WriteEntries()
+} // bool ::ReadEntry(unsigned int& uHash, string& szText)
+
+bool CJsonFile::WriteHeader()
+{
+	m_NumWritten = 0;
+	return true;
+} // bool ::WriteHeader()
+
+bool CJsonFile::WriteEntry(unsigned int uHash, std::string_view szText)
+{
+	// Same layout as json::dump(1, '\t') without building the whole document
+	m_File << (m_NumWritten++ == 0 ? "{\n\t" : ",\n\t");
+	m_File << std::format("\"0x{:08X}\": ", uHash) << nlohmann::json(nlohmann::json::string_t(szText)).dump();
+	return m_File.good();
+} // bool ::WriteEntry(unsigned int uHash, string_view szText)
+
+bool CJsonFile::WriteFooter()
+{
+	m_File << (m_NumWritten == 0 ? "{}" : "\n}");
+	return m_File.good();
+} // bool ::WriteFooter()
 
 //-----------------------------------------------------------------------------------------
 //
@@ -403,48 +990,104 @@ CCsvFile::CCsvFile(const std::string& fileName, int openFlags /*= FLAGS_READ_DEC
 {
 } // ::CCsvFile(const string& fileName, int openFlags = FLAGS_READ_DECOMPILED)
 
-bool CCsvFile::ReadEntries()
+CCsvFile::CCsvFile(std::streambuf* pBuffer) :
+	CFile(pBuffer)
+{
+} // ::CCsvFile(streambuf* pBuffer)
+
+bool CCsvFile::ReadEntry(unsigned int& uHash, std::string& szText)
+{
+	std::string line;
+	if (!IsOpen() || !std::getline(m_File, line))
+	{
+		return false;
+	}
+
+	const std::string szHash = line.substr(0, 10);
+	uHash = strtoul(szHash.c_str(), NULL, 16);
+	szText = line.substr(11);
+
+	return true;
+} // bool ::ReadEntry(unsigned int& uHash, string& szText)
+
+bool CCsvFile::WriteEntry(unsigned int uHash, std::string_view szText)
+{
+	m_File << std::format("0x{:08X},{}", uHash, szText) << '\n';
+	return m_File.good();
+} // bool ::WriteEntry(unsigned int uHash, string_view szText)
+
+//-----------------------------------------------------------------------------------------
+//
+
+COxtFile::COxtFile(const std::string& fileName, int openFlags /*= FLAGS_READ_DECOMPILED*/) :
+	CFile(fileName, openFlags)
+{
+} // ::COxtFile(const string& fileName, int openFlags = FLAGS_READ_DECOMPILED)
+
+COxtFile::COxtFile(std::streambuf* pBuffer) :
+	CFile(pBuffer)
+{
+} // ::COxtFile(streambuf* pBuffer)
+
+bool COxtFile::ReadEntries()
 {
 	if (!IsOpen())
 	{
 		return false;
 	}
 
-	std::string line;
-	while (std::getline(m_File, line))
+	// Labels are hashed in one batch, the entries are still inserted in file order
+	std::vector<std::pair<std::string, std::string>> vEntries;
+	std::string szKey, szText;
+	while (ReadKey(szKey, szText))
 	{
-		const std::string szHash = line.substr(0, 10);
-		const std::string szText = line.substr(11);
-		const unsigned int uHash = strtoul(szHash.c_str(), NULL, 16);
+		vEntries.emplace_back(std::move(szKey), std::move(szText));
+	}
+
+	std::vector<const char*> vLabels;
+	for (const auto& entry : vEntries)
+	{
+		if (!entry.first.starts_with("0x"))
+		{
+			vLabels.push_back(entry.first.c_str());
+		}
+	}
+
+	std::vector<unsigned int> vHashes(vLabels.size());
+	rage::atStringHashBatch(vLabels.data(), vHashes.data(), vLabels.size());
 
-		m_Entries[uHash] = szText;
+	// Reads go into the private map, a shared table is copied out first
+	GetData();
+
+	auto itHash = vHashes.begin();
+	for (auto& [szEntryKey, szEntryText] : vEntries)
+	{
+		const unsigned int uHash = szEntryKey.starts_with("0x") ? strtoul(szEntryKey.c_str(), NULL, 16) : *itHash++;
+		m_Entries.insert_or_assign(uHash, std::move(szEntryText));
 	}
 	return true;
 } // bool ::ReadEntries()
 
-bool CCsvFile::WriteEntries()
+bool COxtFile::ReadEntry(unsigned int& uHash, std::string& szText)
 {
-	if (!IsOpen())
+	std::string szKey;
+	if (!ReadKey(szKey, szText))
 	{
 		return false;
 	}
 
-	for (const auto& [uHash, szTextEntry] : m_Entries)
+	if (szKey.starts_with("0x"))
 	{
-		m_File << format("0x{:08X},{}", uHash, szTextEntry) << std::endl;
+		uHash = strtoul(szKey.c_str(), NULL, 16);
+	}
+	else
+	{
+		uHash = rage::atStringHash(szKey.c_str());
 	}
 	return true;
-} // bool ::WriteEntries()
+} // bool ::ReadEntry(unsigned int& uHash, string& szText)
 
-//-----------------------------------------------------------------------------------------
-//
-
-COxtFile::COxtFile(const std::string& fileName, int openFlags /*= FLAGS_READ_DECOMPILED*/) :
-	CFile(fileName, openFlags)
-{
-} // ::COxtFile(const string& fileName, int openFlags = FLAGS_READ_DECOMPILED)
-
-bool COxtFile::ReadEntries()
+bool COxtFile::ReadKey(std::string& szKey, std::string& szText)
 {
 	if (!IsOpen())
 	{
@@ -461,39 +1104,31 @@ bool COxtFile::ReadEntries()
 		const size_t n2 = line.find_first_of('=');
 		if (n1 != std::string::npos && n2 != std::string::npos)
 		{
-			const std::string szHash = line.substr(n1 + 1, n2 - 2);
-			const std::string szText = line.substr(n2 + 2);
-
-			if (szHash.starts_with("0x"))
-			{
-				const unsigned int uHash = strtoul(szHash.c_str(), NULL, 16);
-				m_Entries[uHash] = szText;
-			}
-			else
-			{
-				m_Entries[rage::atStringHash(szHash.c_str())] = szText;
-			}
+			szKey = line.substr(n1 + 1, n2 - 2);
+			szText = line.substr(n2 + 2);
+			return true;
 		}
 	}
-	return true;
-} // bool ::ReadEntries()
+	return false;
+} // bool ::ReadKey(string& szKey, string& szText)
 
-bool COxtFile::WriteEntries()
+bool COxtFile::WriteHeader()
 {
-	if (!IsOpen())
-	{
-		return false;
-	}
+	m_File << "Version 2 30" << '\n' << "{" << '\n';
+	return m_File.good();
+} // bool ::WriteHeader()
 
-	m_File << "Version 2 30" << std::endl << "{" << std::endl;
-	for (const auto& [uHash, szTextEntry] : m_Entries)
-	{
-		m_File << std::format("\t0x{:08X} = {}", uHash, szTextEntry) << std::endl;
-	}
-	m_File << "}" << std::endl;
+bool COxtFile::WriteEntry(unsigned int uHash, std::string_view szText)
+{
+	m_File << std::format("\t0x{:08X} = {}", uHash, szText) << '\n';
+	return m_File.good();
+} // bool ::WriteEntry(unsigned int uHash, string_view szText)
 
-	return true;
-} // bool ::WriteEntries()
+bool COxtFile::WriteFooter()
+{
+	m_File << "}" << std::endl;
+	return m_File.good();
+} // bool ::WriteFooter()
 
 //-----------------------------------------------------------------------------------------
 //
@@ -503,6 +1138,11 @@ CHashDatabase::CHashDatabase(const std::string& fileName, int openFlags /*= FLAG
 {
 } // ::CHashDatabase(const string& fileName)
 
+CHashDatabase::CHashDatabase(std::streambuf* pBuffer) :
+	CFile(pBuffer)
+{
+} // ::CHashDatabase(streambuf* pBuffer)
+
 bool CHashDatabase::ReadEntries()
 {
 	if (!IsOpen())
@@ -510,39 +1150,45 @@ bool CHashDatabase::ReadEntries()
 		return false;
 	}
 
+	// Hashed all at once, several labels go through the SIMD lanes side by side
+	std::vector<std::string> vLines;
 	std::string line;
 	while (std::getline(m_File, line))
 	{
-		const unsigned int uHash = rage::atStringHash(line.c_str());
+		vLines.push_back(std::move(line));
+	}
+
+	std::vector<const char*> vLabels(vLines.size());
+	std::vector<unsigned int> vHashes(vLines.size());
+	std::transform(vLines.begin(), vLines.end(), vLabels.begin(), [](const std::string& label) { return label.c_str(); });
+	rage::atStringHashBatch(vLabels.data(), vHashes.data(), vLabels.size());
+
+	// Reads go into the private map, a shared table is copied out first
+	GetData();
+
+	for (size_t i = 0; i < vLines.size(); i++)
+	{
+		const unsigned int uHash = vHashes[i];
 
 #if _DEBUG
 		if (auto it = m_Entries.find(uHash); it != m_Entries.end())
 		{
-			if (it->second != line)
+			if (it->second != vLines[i])
 			{
-				std::cout << std::format("[{}] Warning: Duplicate Hash Entry (0x{:08X}) found!\n\tprv = {}\n\tcur = {}", __FUNCTION__, uHash, it->second, line) << std::endl;
+				std::cout << std::format("[{}] Warning: Duplicate Hash Entry (0x{:08X}) found!\n\tprv = {}\n\tcur = {}", __FUNCTION__, uHash, it->second, vLines[i]) << std::endl;
 			}
 		}
 		else
 #endif
 		{
-			m_Entries[uHash] = line;
+			m_Entries[uHash] = std::move(vLines[i]);
 		}
 	}
 	return true;
 } // bool ::ReadEntries()
 
-bool CHashDatabase::WriteEntries()
+bool CHashDatabase::WriteEntry(unsigned int /*uHash*/, std::string_view szName)
 {
-	if (!IsOpen())
-	{
-		return false;
-	}
-
-	for (const auto& [uHash, szName] : m_Entries)
-	{
-		m_File << szName << std::endl;
-	}
-
-	return true;
-} // bool ::WriteEntries()
\ No newline at end of file
+	m_File << szName << '\n';
+	return m_File.good();
+} // bool ::WriteEntry(unsigned int uHash, string_view szName)
\ No newline at end of file
@@ -7,11 +7,17 @@
 
 // C/C++
 #include <map>
+#include <memory>
+#include <span>
 #include <vector>
 #include <string>
+#include <ranges>
 #include <cstring>
+#include <iterator>
+#include <string_view>
 #include <fstream>
 #include <iostream>
+#include <functional>
 
 // vendor
 #include <nlohmann/json_fwd.hpp>
@@ -36,6 +42,9 @@ public:
 		FLAGS_WRITE_COMPILED = (std::fstream::out | std::fstream::binary),
 		FLAGS_WRITE_DECOMPILED = (std::fstream::out),
 
+		// patching in place
+		FLAGS_PATCH_COMPILED = (std::fstream::in | std::fstream::out | std::fstream::binary),
+
 		// default
 		FLAGS_DEFAULT = (std::fstream::in | std::fstream::out)
 	};
@@ -48,14 +57,18 @@ public:
 	};
 	using Map = std::map<unsigned int, std::string, std::less<unsigned int>>;
 	using Vec = std::vector<std::pair<unsigned int, std::string>>;
+	using SharedMap = std::shared_ptr<const Map>;
 protected:
 	CFile();
 public:
 	CFile(const std::string& fileName, int openFlags = FLAGS_DEFAULT, int endian = _LITTLE_ENDIAN);
+	// Runs the codec on a buffer owned by the caller instead of a file
+	explicit CFile(std::streambuf* pBuffer, int endian = _LITTLE_ENDIAN);
 	virtual ~CFile();
 
 	CFile(const CFile&) = delete;
 	CFile& operator=(const CFile& other);
+	CFile& operator=(CFile&& other) noexcept;
 
 	void Reset();
 	void Dump() const;
@@ -68,6 +81,16 @@ public:
 	void SetData(const Map& data);
 	void SetData(const Vec& data);
 
+	// Hands the table over without copying the strings, entries already
+	// present are overridden by the incoming ones like SetData(const Map&).
+	Map TakeData();
+	void SetData(Map&& data);
+
+	// Immutable table that several files can serialize at the same time,
+	// a later non-const GetData() detaches into a private copy.
+	SharedMap ShareData();
+	void SetData(const SharedMap& data);
+
 	void SetEndian(int endian) { m_Endian = endian; }
 	void SetLittleEndian() { m_Endian = _LITTLE_ENDIAN; }
 	void SetBigEndian() { m_Endian = _BIG_ENDIAN; }
@@ -78,8 +101,45 @@ public:
 	static void SwapEndian(unsigned int& x);
 	void DoSwapEndian(unsigned int& x) const;
 
-	virtual bool ReadEntries() { return false; };
-	virtual bool WriteEntries() { return false; };
+	virtual bool ReadEntries();
+	virtual bool WriteEntries();
+
+	// Pulls the next entry from the file without buffering the whole table,
+	// returns false once the end of the file has been reached.
+	virtual bool ReadEntry(unsigned int& /*uHash*/, std::string& /*szText*/) { return false; };
+
+	// Lazy single pass over the remaining entries, see CEntryRange
+	class CEntryRange ReadRange();
+
+	// Writes any range of (hash, text) pairs, e.g. a filtered ReadRange()
+	// of another file, without building a table. Hashes must ascend.
+	template<std::ranges::input_range R>
+	bool WriteRange(R&& entries)
+	{
+		if (!IsOpen() || !WriteHeader())
+		{
+			return false;
+		}
+
+		for (auto&& [uHash, szText] : entries)
+		{
+			if (!WriteEntry(uHash, szText))
+			{
+				return false;
+			}
+		}
+		return WriteFooter();
+	}
+
+	// Writes one entry at a time, entries are expected in ascending hash order.
+	virtual bool WriteHeader() { return true; };
+	virtual bool WriteEntry(unsigned int /*uHash*/, std::string_view /*szText*/) { return false; };
+	virtual bool WriteFooter() { return true; };
+
+	// Runs the codec on another stream buffer while the file itself is read
+	// or written raw elsewhere, nullptr switches back to the file.
+	std::streambuf* GetFileBuffer() { return &m_FileBuffer; }
+	void SetStreamBuffer(std::streambuf* pBuffer);
 protected:
 	void Head();
 	void End();
@@ -115,21 +175,98 @@ protected:
 		m_File.write(pData, strlen(pData) + 1);
 	}
 protected:
-	std::fstream m_File;
+	std::filebuf m_FileBuffer;
+	std::iostream m_File;
 	Map m_Entries;
+	SharedMap m_Shared;
 	int m_Endian;
 };
 
 //-----------------------------------------------------------------------------------------
 //
 
+// Input range over CFile::ReadEntry(), the text view of an entry stays
+// valid until the iterator is advanced. Composes with std::views, e.g.
+// file.ReadRange() | std::views::filter(...) passed to WriteRange().
+class CEntryRange : public std::ranges::view_interface<CEntryRange>
+{
+public:
+	using Entry = std::pair<unsigned int, std::string_view>;
+
+	class Iterator
+	{
+	public:
+		using iterator_concept = std::input_iterator_tag;
+		using value_type = Entry;
+		using difference_type = std::ptrdiff_t;
+
+		Iterator() : m_Range(nullptr) {}
+		explicit Iterator(CEntryRange* pRange) : m_Range(pRange) {}
+
+		Entry operator*() const { return { m_Range->m_Hash, m_Range->m_Text }; }
+		Iterator& operator++() { m_Range->Next(); return *this; }
+		void operator++(int) { m_Range->Next(); }
+		bool operator==(std::default_sentinel_t) const { return !m_Range || m_Range->m_AtEnd; }
+	private:
+		CEntryRange* m_Range;
+	};
+public:
+	CEntryRange() : m_File(nullptr), m_Hash(0), m_AtEnd(true) {}
+	explicit CEntryRange(CFile* pFile) : m_File(pFile), m_Hash(0), m_AtEnd(true) {}
+
+	// Pulls the first entry, a range can only be iterated once
+	Iterator begin() { Next(); return Iterator(this); }
+	std::default_sentinel_t end() const { return std::default_sentinel; }
+private:
+	void Next() { m_AtEnd = !m_File || !m_File->ReadEntry(m_Hash, m_Text); }
+private:
+	CFile* m_File;
+	unsigned int m_Hash;
+	std::string m_Text;
+	bool m_AtEnd;
+};
+
+//-----------------------------------------------------------------------------------------
+//
+
 class CMemoryFile : public CFile
 {
 public:
+	enum
+	{
+		FORMAT_NONE,
+
+		FORMAT_GXT2,
+		FORMAT_TXT,
+		FORMAT_JSON,
+		FORMAT_CSV,
+		FORMAT_OXT,
+		FORMAT_LABELS
+	};
+public:
+	// Plain table without a backing codec
 	CMemoryFile();
+	// Decodes the given bytes, they must outlive the ReadEntries() call
+	CMemoryFile(int format, std::span<const char> data);
+	// Encodes into output, WriteEntries() appends to whatever it holds
+	CMemoryFile(int format, std::string& output, int endian = _LITTLE_ENDIAN);
+	~CMemoryFile() override;
 
 	bool ReadEntries() override;
 	bool WriteEntries() override;
+
+	// Streams through the codec, so CEntryRange and WriteRange() work too
+	bool ReadEntry(unsigned int& uHash, std::string& szText) override;
+	bool WriteHeader() override;
+	bool WriteEntry(unsigned int uHash, std::string_view szText) override;
+	bool WriteFooter() override;
+
+	static int GetFormatFromExtension(const std::string& fileName);
+private:
+	void CreateCodec(int format);
+private:
+	std::streambuf* m_Buffer;
+	CFile* m_Codec;
 };
 
 //-----------------------------------------------------------------------------------------
@@ -145,12 +282,55 @@ private:
 	};
 public:
 	CGxt2File(const std::string& fileName, int openFlags = FLAGS_READ_COMPILED, int endian = _LITTLE_ENDIAN);
+	explicit CGxt2File(std::streambuf* pBuffer, int endian = _LITTLE_ENDIAN);
 
 	bool ReadEntries() override;
 	bool WriteEntries() override;
+	bool ReadEntry(unsigned int& uHash, std::string& szText) override;
+
+	// Only the strings of entries accepted by the filter are read from the heap
+	bool ReadEntries(const std::function<bool(unsigned int uHash)>& filter);
+
+	// Only the offset table is read, the string heap is never touched
+	bool ReadHashes(std::vector<unsigned int>& vHashes);
 
 	static constexpr unsigned int GXT2_MAGIC_LE = MAKE_MAGIC('G', 'X', 'T', '2');
 	static constexpr unsigned int GXT2_MAGIC_BE = MAKE_MAGIC('2', 'T', 'X', 'G');
+private:
+	bool ReadTable(std::vector<Entry>& vEntries, unsigned int& uDataLength);
+private:
+	std::vector<Entry> m_Table;
+	size_t m_NextEntry;
+	bool m_HasTable;
+};
+
+//-----------------------------------------------------------------------------------------
+//
+
+class CGxt2Writer : public CFile
+{
+public:
+	CGxt2Writer(const std::string& fileName, int endian = _LITTLE_ENDIAN);
+	~CGxt2Writer() override;
+
+	bool WriteEntry(unsigned int uHash, std::string_view szText) override { return AddEntry(uHash, szText); }
+	bool WriteFooter() override { return Finish(); }
+
+	// Entries must be passed in ascending hash order, the offset table and
+	// the string heap are spilled to temporary files until Finish() is called.
+	bool AddEntry(unsigned int uHash, std::string_view szText);
+	bool Finish();
+
+	unsigned int GetCount() const { return m_Count; }
+private:
+	void RemoveTemporaryFiles();
+private:
+	std::fstream m_Table;
+	std::fstream m_Heap;
+	std::string m_TablePath;
+	std::string m_HeapPath;
+	unsigned int m_Count;
+	unsigned int m_HeapSize;
 };
 
 //-----------------------------------------------------------------------------------------
@@ -160,9 +340,10 @@ class CTextFile : public CFile
 {
 public:
 	CTextFile(const std::string& fileName, int openFlags = FLAGS_READ_DECOMPILED);
+	explicit CTextFile(std::streambuf* pBuffer);
 
-	bool ReadEntries() override;
-	bool WriteEntries() override;
+	bool ReadEntry(unsigned int& uHash, std::string& szText) override;
+	bool WriteEntry(unsigned int uHash, std::string_view szText) override;
 };
 
 //-----------------------------------------------------------------------------------------
@@ -172,11 +353,15 @@ class CJsonFile : public CFile
 {
 public:
 	CJsonFile(const std::string& fileName, int openFlags = FLAGS_READ_DECOMPILED);
+	explicit CJsonFile(std::streambuf* pBuffer);
 
-	bool ReadEntries() override;
-	bool WriteEntries() override;
+	bool ReadEntry(unsigned int& uHash, std::string& szText) override;
+	bool WriteHeader() override;
+	bool WriteEntry(unsigned int uHash, std::string_view szText) override;
+	bool WriteFooter() override;
 private:
-	nlohmann::json m_Data;
+	unsigned int m_NumWritten;
+	bool m_InObject;
 };
 
 //-----------------------------------------------------------------------------------------
@@ -186,9 +371,10 @@ class CCsvFile : public CFile
 {
 public:
 	CCsvFile(const std::string& fileName, int openFlags = FLAGS_READ_DECOMPILED);
+	explicit CCsvFile(std::streambuf* pBuffer);
 
-	bool ReadEntries() override;
-	bool WriteEntries() override;
+	bool ReadEntry(unsigned int& uHash, std::string& szText) override;
+	bool WriteEntry(unsigned int uHash, std::string_view szText) override;
 };
 
 //-----------------------------------------------------------------------------------------
@@ -198,9 +384,16 @@ class COxtFile : public CFile
 {
 public:
 	COxtFile(const std::string& fileName, int openFlags = FLAGS_READ_DECOMPILED);
+	explicit COxtFile(std::streambuf* pBuffer);
 
 	bool ReadEntries() override;
-	bool WriteEntries() override;
+	bool ReadEntry(unsigned int& uHash, std::string& szText) override;
+	bool WriteHeader() override;
+	bool WriteEntry(unsigned int uHash, std::string_view szText) override;
+	bool WriteFooter() override;
+private:
+	// Next entry with its label or 0x%08X hash as written
+	bool ReadKey(std::string& szKey, std::string& szText);
 };
 
 //-----------------------------------------------------------------------------------------
@@ -210,9 +403,10 @@ class CHashDatabase : public CFile
 {
 public:
 	CHashDatabase(const std::string& fileName, int openFlags = FLAGS_READ_DECOMPILED);
+	explicit CHashDatabase(std::streambuf* pBuffer);
 
 	bool ReadEntries() override;
-	bool WriteEntries() override;
+	bool WriteEntry(unsigned int uHash, std::string_view szName) override;
 };
 
 #endif // !_GXT2_H_
\ No newline at end of file
@@ -0,0 +1,526 @@
+//
+//	gxt/labeldb.cpp
+//
+
+// Project
+#include "labeldb.h"
+#include "data/stringhash.h"
+
+// C/C++
+#include <vector>
+#include <format>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+	void WriteVarint(std::string& out, size_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		out.push_back(static_cast<char>(value));
+	}
+
+	bool ReadVarint(const unsigned char*& pData, const unsigned char* pEnd, size_t& value)
+	{
+		value = 0;
+		for (unsigned int shift = 0; pData < pEnd && shift < 35; shift += 7)
+		{
+			const unsigned char byte = *pData++;
+			value |= static_cast<size_t>(byte & 0x7F) << shift;
+			if (!(byte & 0x80))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Roughly eight hashes per bucket, more bits stop paying off once a bucket fits a cache line
+	unsigned int GetIndexBits(size_t numLabels)
+	{
+		unsigned int bits = 0;
+		while (bits < CLabelDatabase::MAX_INDEX_BITS && (static_cast<size_t>(8) << bits) < numLabels)
+		{
+			bits++;
+		}
+		return bits;
+	}
+
+	unsigned int GetBucket(unsigned int uHash, unsigned int indexBits)
+	{
+		return indexBits ? uHash >> (32 - indexBits) : 0;
+	}
+
+	// Names compare the way the hash sees them, with case and slashes folded
+	int CompareFolded(std::string_view a, std::string_view b)
+	{
+		const size_t length = std::min(a.size(), b.size());
+		for (size_t i = 0; i < length; i++)
+		{
+			const unsigned char ca = rage::atNormalizeCaseAndSlash(static_cast<unsigned char>(a[i]));
+			const unsigned char cb = rage::atNormalizeCaseAndSlash(static_cast<unsigned char>(b[i]));
+			if (ca != cb)
+			{
+				return (ca < cb) ? -1 : 1;
+			}
+		}
+		return (a.size() < b.size()) ? -1 : (a.size() > b.size()) ? 1 : 0;
+	}
+
+	bool StartsWithFolded(std::string_view value, std::string_view prefix)
+	{
+		return value.size() >= prefix.size() && CompareFolded(value.substr(0, prefix.size()), prefix) == 0;
+	}
+}
+
+CLabelDatabase::CLabelDatabase() :
+	m_Header(nullptr),
+	m_Index(nullptr),
+	m_Hashes(nullptr),
+	m_Names(nullptr),
+	m_Blocks(nullptr),
+	m_Parts(nullptr),
+	m_Data(nullptr),
+	m_DataEnd(nullptr)
+{
+} // ::CLabelDatabase()
+
+bool CLabelDatabase::OpenOrCompile(const std::string& labelsFile, const std::string& cacheDir /*= ""*/)
+{
+	Close();
+
+	unsigned long long sourceSize = 0;
+	long long sourceTime = 0;
+	if (!GetSourceStamp(labelsFile, sourceSize, sourceTime))
+	{
+		return false;
+	}
+
+	const std::string fileName = GetCompiledPath(labelsFile, cacheDir);
+	if (Open(fileName) && m_Header->m_SourceSize == sourceSize && m_Header->m_SourceTime == sourceTime)
+	{
+		return true;
+	}
+
+	// The old mapping has to go before the file can be replaced
+	Close();
+	return Compile(labelsFile, fileName) && Open(fileName);
+} // bool ::OpenOrCompile(const string& labelsFile, const string& cacheDir)
+
+bool CLabelDatabase::Open(const std::string& fileName)
+{
+	Close();
+
+	std::error_code ec;
+	if (!std::filesystem::is_regular_file(fileName, ec))
+	{
+		return false;
+	}
+
+	try
+	{
+		m_File = std::make_unique<CMappedFile>(fileName);
+	}
+	catch (const std::exception&)
+	{
+		return false;
+	}
+
+	const std::span<const char> data = m_File->GetData();
+	const Header* pHeader = reinterpret_cast<const Header*>(data.data());
+	if (data.size() < sizeof(Header) || pHeader->m_Magic != LABELDB_MAGIC || pHeader->m_Version != LABELDB_VERSION ||
+		pHeader->m_DataLength != data.size() || pHeader->m_IndexBits > MAX_INDEX_BITS)
+	{
+		Close();
+		return false;
+	}
+
+	// Every section has to lie inside the file, in order
+	const size_t numLabels = pHeader->m_NumLabels;
+	const size_t numBlocks = (numLabels + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	const size_t indexEnd = pHeader->m_IndexOffset + ((static_cast<size_t>(1) << pHeader->m_IndexBits) + 1) * sizeof(unsigned int);
+	const size_t hashesEnd = pHeader->m_HashesOffset + numLabels * sizeof(unsigned int);
+	const size_t namesEnd = pHeader->m_NamesOffset + numLabels * sizeof(unsigned int);
+	const size_t blocksEnd = pHeader->m_BlocksOffset + numBlocks * sizeof(unsigned int);
+	const size_t partsEnd = pHeader->m_PartsOffset + static_cast<size_t>(pHeader->m_NumParts) * sizeof(unsigned int);
+
+	if (pHeader->m_IndexOffset < sizeof(Header) || pHeader->m_IndexOffset % sizeof(unsigned int) ||
+		pHeader->m_HashesOffset < indexEnd || pHeader->m_HashesOffset % sizeof(unsigned int) ||
+		pHeader->m_NamesOffset < hashesEnd || pHeader->m_NamesOffset % sizeof(unsigned int) ||
+		pHeader->m_BlocksOffset < namesEnd || pHeader->m_BlocksOffset % sizeof(unsigned int) ||
+		pHeader->m_PartsOffset < blocksEnd || pHeader->m_PartsOffset % sizeof(unsigned int) ||
+		pHeader->m_DataOffset < partsEnd || pHeader->m_DataOffset > data.size())
+	{
+		Close();
+		return false;
+	}
+
+	m_Header = pHeader;
+	m_Index = reinterpret_cast<const unsigned int*>(data.data() + pHeader->m_IndexOffset);
+	m_Hashes = reinterpret_cast<const unsigned int*>(data.data() + pHeader->m_HashesOffset);
+	m_Names = reinterpret_cast<const unsigned int*>(data.data() + pHeader->m_NamesOffset);
+	m_Blocks = reinterpret_cast<const unsigned int*>(data.data() + pHeader->m_BlocksOffset);
+	m_Parts = reinterpret_cast<const unsigned int*>(data.data() + pHeader->m_PartsOffset);
+	m_Data = reinterpret_cast<const unsigned char*>(data.data() + pHeader->m_DataOffset);
+	m_DataEnd = reinterpret_cast<const unsigned char*>(data.data() + data.size());
+
+	// Lookups trust the index, it is the one part that is checked in full
+	const size_t numBuckets = static_cast<size_t>(1) << pHeader->m_IndexBits;
+	for (size_t i = 0; i < numBuckets; i++)
+	{
+		if (m_Index[i] > m_Index[i + 1])
+		{
+			Close();
+			return false;
+		}
+	}
+	if (m_Index[0] != 0 || m_Index[numBuckets] != numLabels)
+	{
+		Close();
+		return false;
+	}
+	return true;
+} // bool ::Open(const string& fileName)
+
+void CLabelDatabase::Close()
+{
+	m_File.reset();
+	m_Header = nullptr;
+	m_Index = nullptr;
+	m_Hashes = nullptr;
+	m_Names = nullptr;
+	m_Blocks = nullptr;
+	m_Parts = nullptr;
+	m_Data = nullptr;
+	m_DataEnd = nullptr;
+} // void ::Close()
+
+bool CLabelDatabase::Find(unsigned int uHash, std::string& szName) const
+{
+	const unsigned int uPosition = FindPosition(uHash);
+	return uPosition < GetSize() && DecodeName(m_Names[uPosition], szName);
+} // bool ::Find(unsigned int uHash, string& szName) const
+
+bool CLabelDatabase::Contains(unsigned int uHash) const
+{
+	return FindPosition(uHash) < GetSize();
+} // bool ::Contains(unsigned int uHash) const
+
+std::vector<std::string> CLabelDatabase::Complete(std::string_view text, size_t maxCount) const
+{
+	std::vector<std::string> vNames;
+	if (!m_Header || text.empty() || maxCount == 0)
+	{
+		return vNames;
+	}
+
+	CompletePrefix(text, maxCount, vNames);
+	if (vNames.size() < maxCount)
+	{
+		CompleteParts(text, maxCount, vNames);
+	}
+	return vNames;
+} // vector<string> ::Complete(string_view text, size_t maxCount) const
+
+unsigned int CLabelDatabase::FindPosition(unsigned int uHash) const
+{
+	if (!m_Header)
+	{
+		return 0;
+	}
+
+	const unsigned int uBucket = GetBucket(uHash, m_Header->m_IndexBits);
+	const unsigned int* pFirst = m_Hashes + m_Index[uBucket];
+	const unsigned int* pLast = m_Hashes + m_Index[uBucket + 1];
+	const unsigned int* pFound = std::lower_bound(pFirst, pLast, uHash);
+
+	return (pFound != pLast && *pFound == uHash) ? static_cast<unsigned int>(pFound - m_Hashes) : m_Header->m_NumLabels;
+} // unsigned int ::FindPosition(unsigned int uHash) const
+
+const unsigned char* CLabelDatabase::DecodeNext(const unsigned char* pData, std::string& szName) const
+{
+	size_t shared = 0, length = 0;
+	if (pData < m_Data || pData >= m_DataEnd ||
+		!ReadVarint(pData, m_DataEnd, shared) || !ReadVarint(pData, m_DataEnd, length) ||
+		shared > szName.size() || length > static_cast<size_t>(m_DataEnd - pData))
+	{
+		szName.clear();
+		return nullptr;
+	}
+
+	// Each step keeps the shared prefix of the name before it and appends the rest
+	szName.resize(shared);
+	szName.append(reinterpret_cast<const char*>(pData), length);
+	return pData + length;
+} // const unsigned char* ::DecodeNext(const unsigned char* pData, string& szName) const
+
+bool CLabelDatabase::DecodeName(unsigned int uName, std::string& szName) const
+{
+	if (uName >= GetSize())
+	{
+		return false;
+	}
+
+	const unsigned int uBlock = uName / BLOCK_SIZE;
+	const unsigned char* pData = m_Data + m_Blocks[uBlock];
+
+	szName.clear();
+	for (unsigned int i = uBlock * BLOCK_SIZE; i <= uName && pData; i++)
+	{
+		pData = DecodeNext(pData, szName);
+	}
+	return pData != nullptr;
+} // bool ::DecodeName(unsigned int uName, string& szName) const
+
+void CLabelDatabase::CompletePrefix(std::string_view text, size_t maxCount, std::vector<std::string>& vNames) const
+{
+	// The last block that starts before text is where names from text on can begin
+	const unsigned int numBlocks = (m_Header->m_NumLabels + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	unsigned int uFirst = 0, uCount = numBlocks;
+	std::string szName;
+	while (uCount > 0)
+	{
+		const unsigned int uStep = uCount / 2;
+		szName.clear();
+		if (DecodeNext(m_Data + m_Blocks[uFirst + uStep], szName) && CompareFolded(szName, text) < 0)
+		{
+			uFirst += uStep + 1;
+			uCount -= uStep + 1;
+		}
+		else
+		{
+			uCount = uStep;
+		}
+	}
+
+	const unsigned int uBlock = uFirst > 0 ? uFirst - 1 : 0;
+	const unsigned char* pData = m_Data + m_Blocks[uBlock];
+	szName.clear();
+	for (unsigned int i = uBlock * BLOCK_SIZE; i < m_Header->m_NumLabels && vNames.size() < maxCount; i++)
+	{
+		pData = DecodeNext(pData, szName);
+		if (!pData)
+		{
+			return;
+		}
+
+		if (StartsWithFolded(szName, text))
+		{
+			vNames.push_back(szName);
+		}
+		else if (CompareFolded(szName, text) > 0)
+		{
+			return;
+		}
+	}
+} // void ::CompletePrefix(string_view text, size_t maxCount, vector<string>& vNames) const
+
+void CLabelDatabase::CompleteParts(std::string_view text, size_t maxCount, std::vector<std::string>& vNames) const
+{
+	std::string szName;
+	auto getPart = [this, &szName](unsigned int uPart) -> std::string_view
+	{
+		if (!DecodeName(uPart >> 8, szName))
+		{
+			return {};
+		}
+		return std::string_view(szName).substr(std::min<size_t>(uPart & 0xFF, szName.size()));
+	};
+
+	const unsigned int* pFound = std::lower_bound(m_Parts, m_Parts + m_Header->m_NumParts, text,
+		[&getPart](unsigned int uPart, std::string_view value) { return CompareFolded(getPart(uPart), value) < 0; });
+
+	for (; pFound != m_Parts + m_Header->m_NumParts && vNames.size() < maxCount; pFound++)
+	{
+		if (!StartsWithFolded(getPart(*pFound), text))
+		{
+			return;
+		}
+
+		// A name that starts with text or has it in two places is listed once
+		if (std::find(vNames.begin(), vNames.end(), szName) == vNames.end())
+		{
+			vNames.push_back(szName);
+		}
+	}
+} // void ::CompleteParts(string_view text, size_t maxCount, vector<string>& vNames) const
+
+bool CLabelDatabase::Compile(const std::string& labelsFile, const std::string& fileName)
+{
+	Header header = {};
+	header.m_Magic = LABELDB_MAGIC;
+	header.m_Version = LABELDB_VERSION;
+
+	// Taken before reading, a list that changes meanwhile is compiled again next time
+	if (!GetSourceStamp(labelsFile, header.m_SourceSize, header.m_SourceTime))
+	{
+		return false;
+	}
+
+	// Opened first, a read-only directory fails here and the caller parses the list itself
+	const std::string tempFile = fileName + ".tmp";
+	std::ofstream output(tempFile, std::ios::binary | std::ios::trunc);
+	if (!output.is_open())
+	{
+		return false;
+	}
+
+	CHashDatabase labels(labelsFile);
+	if (!labels.ReadEntries())
+	{
+		output.close();
+		std::error_code ec;
+		std::filesystem::remove(tempFile, ec);
+		return false;
+	}
+	const CFile::Map mLabels = labels.TakeData();
+	labels.Close();
+
+	// Names in folded order, the hash column refers to them by number. Two names
+	// that only differ in case or slashes have the same hash, the order is total.
+	std::vector<std::pair<std::string_view, unsigned int>> vNames;
+	vNames.reserve(mLabels.size());
+	for (const auto& [uHash, szName] : mLabels)
+	{
+		vNames.emplace_back(szName, uHash);
+	}
+	std::sort(vNames.begin(), vNames.end(), [](const auto& a, const auto& b) { return CompareFolded(a.first, b.first) < 0; });
+
+	std::vector<unsigned int> vHashes, vNameNumbers(mLabels.size());
+	vHashes.reserve(mLabels.size());
+	for (const auto& [uHash, szName] : mLabels)
+	{
+		vHashes.push_back(uHash);
+	}
+
+	std::string data;
+	std::vector<unsigned int> vBlocks;
+	std::vector<std::pair<std::string_view, unsigned int>> vParts;
+	std::string_view previous;
+	for (size_t i = 0; i < vNames.size(); i++)
+	{
+		const auto& [szName, uHash] = vNames[i];
+		const size_t position = static_cast<size_t>(std::lower_bound(vHashes.begin(), vHashes.end(), uHash) - vHashes.begin());
+		vNameNumbers[position] = static_cast<unsigned int>(i);
+
+		size_t shared = 0;
+		if (i % BLOCK_SIZE == 0)
+		{
+			vBlocks.push_back(static_cast<unsigned int>(data.size()));
+		}
+		else
+		{
+			const size_t maxShared = std::min(previous.size(), szName.size());
+			while (shared < maxShared && previous[shared] == szName[shared])
+			{
+				shared++;
+			}
+		}
+
+		WriteVarint(data, shared);
+		WriteVarint(data, szName.size() - shared);
+		data.append(szName.substr(shared));
+		previous = szName;
+
+		// The offset of a part has a byte, the name number the rest
+		for (size_t offset = 1; offset < szName.size() && offset <= 0xFF && i < (1u << 24); offset++)
+		{
+			if (szName[offset - 1] == '_')
+			{
+				vParts.emplace_back(szName.substr(offset), static_cast<unsigned int>(i << 8 | offset));
+			}
+		}
+	}
+
+	std::sort(vParts.begin(), vParts.end(), [](const auto& a, const auto& b)
+	{
+		const int compare = CompareFolded(a.first, b.first);
+		return compare != 0 ? compare < 0 : a.second < b.second;
+	});
+
+	std::vector<unsigned int> vPartColumn(vParts.size());
+	std::transform(vParts.begin(), vParts.end(), vPartColumn.begin(), [](const auto& part) { return part.second; });
+
+	header.m_NumLabels = static_cast<unsigned int>(vHashes.size());
+	header.m_IndexBits = GetIndexBits(vHashes.size());
+
+	std::vector<unsigned int> vIndex((static_cast<size_t>(1) << header.m_IndexBits) + 1);
+	for (size_t bucket = 0; bucket < vIndex.size(); bucket++)
+	{
+		// The first hash of every bucket, the last entry ends the column
+		const unsigned long long uFirstHash = static_cast<unsigned long long>(bucket) << (32 - header.m_IndexBits);
+		vIndex[bucket] = static_cast<unsigned int>(std::lower_bound(vHashes.begin(), vHashes.end(), uFirstHash,
+			[](unsigned int uHash, unsigned long long uValue) { return uHash < uValue; }) - vHashes.begin());
+	}
+
+	header.m_IndexOffset = sizeof(Header);
+	header.m_HashesOffset = header.m_IndexOffset + static_cast<unsigned int>(vIndex.size() * sizeof(unsigned int));
+	header.m_NamesOffset = header.m_HashesOffset + static_cast<unsigned int>(vHashes.size() * sizeof(unsigned int));
+	header.m_BlocksOffset = header.m_NamesOffset + static_cast<unsigned int>(vNameNumbers.size() * sizeof(unsigned int));
+	header.m_NumParts = static_cast<unsigned int>(vPartColumn.size());
+	header.m_PartsOffset = header.m_BlocksOffset + static_cast<unsigned int>(vBlocks.size() * sizeof(unsigned int));
+	header.m_DataOffset = header.m_PartsOffset + static_cast<unsigned int>(vPartColumn.size() * sizeof(unsigned int));
+	header.m_DataLength = header.m_DataOffset + static_cast<unsigned int>(data.size());
+
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	output.write(reinterpret_cast<const char*>(vIndex.data()), static_cast<std::streamsize>(vIndex.size() * sizeof(unsigned int)));
+	output.write(reinterpret_cast<const char*>(vHashes.data()), static_cast<std::streamsize>(vHashes.size() * sizeof(unsigned int)));
+	output.write(reinterpret_cast<const char*>(vNameNumbers.data()), static_cast<std::streamsize>(vNameNumbers.size() * sizeof(unsigned int)));
+	output.write(reinterpret_cast<const char*>(vBlocks.data()), static_cast<std::streamsize>(vBlocks.size() * sizeof(unsigned int)));
+	output.write(reinterpret_cast<const char*>(vPartColumn.data()), static_cast<std::streamsize>(vPartColumn.size() * sizeof(unsigned int)));
+	output.write(data.data(), static_cast<std::streamsize>(data.size()));
+
+	// Closing flushes, a full disk shows up here
+	output.close();
+	if (!output)
+	{
+		std::error_code ec;
+		std::filesystem::remove(tempFile, ec);
+		return false;
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempFile, fileName, ec);
+	if (ec)
+	{
+		std::filesystem::remove(tempFile, ec);
+		return false;
+	}
+	return true;
+} // bool ::Compile(const string& labelsFile, const string& fileName)
+
+std::string CLabelDatabase::GetCompiledPath(const std::string& labelsFile, const std::string& cacheDir /*= ""*/)
+{
+	if (cacheDir.empty())
+	{
+		return std::filesystem::path(labelsFile).replace_extension(".bin").string();
+	}
+
+	// Lists from different places share the directory, the name tells them apart
+	std::error_code ec;
+	std::filesystem::path sourcePath = std::filesystem::absolute(labelsFile, ec);
+	if (ec)
+	{
+		sourcePath = labelsFile;
+	}
+	const std::string fileName = std::format("{}-{:08x}.bin", sourcePath.stem().string(), rage::atStringHash(sourcePath.generic_string().c_str()));
+	return (std::filesystem::path(cacheDir) / fileName).string();
+} // string ::GetCompiledPath(const string& labelsFile, const string& cacheDir)
+
+bool CLabelDatabase::GetSourceStamp(const std::string& labelsFile, unsigned long long& size, long long& time)
+{
+	std::error_code ec;
+	const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(labelsFile, ec);
+	if (ec)
+	{
+		return false;
+	}
+	size = static_cast<unsigned long long>(std::filesystem::file_size(labelsFile, ec));
+	time = static_cast<long long>(writeTime.time_since_epoch().count());
+	return !ec;
+} // bool ::GetSourceStamp(const string& labelsFile, unsigned long long& size, long long& time)
@@ -0,0 +1,95 @@
+//
+//	gxt/labeldb.h
+//
+
+#ifndef _LABELDB_H_
+#define _LABELDB_H_
+
+// Project
+#include "gxt2.h"
+#include "data/mappedfile.h"
+
+// C/C++
+#include <memory>
+#include <string>
+#include <vector>
+#include <string_view>
+
+// Compiled form of a label list that is mapped instead of parsed. Hashes are
+// a sorted column next to the number of their name, the top bits of a hash
+// index straight into the column. Names are sorted and front coded: each one
+// keeps the length it shares with the name before it and the rest. Every
+// BLOCK_SIZE-th name is stored whole with its offset, so a lookup decodes a
+// single block. Names sort the way the hash sees them, case and slashes
+// folded, which makes every prefix a contiguous range. The parts after an
+// underscore are a second sorted range, so a word inside a name is a binary
+// search away as well. The file is in host byte order, it is a cache and is
+// compiled again whenever the list it came from changes.
+class CLabelDatabase
+{
+public:
+	CLabelDatabase();
+
+	// Maps the database in cacheDir, or next to labelsFile without one, compiled first if it is missing or the list has changed
+	bool OpenOrCompile(const std::string& labelsFile, const std::string& cacheDir = "");
+	bool Open(const std::string& fileName);
+	void Close();
+	bool IsOpen() const { return m_File != nullptr; }
+
+	bool Find(unsigned int uHash, std::string& szName) const;
+	bool Contains(unsigned int uHash) const;
+	size_t GetSize() const { return m_Header ? m_Header->m_NumLabels : 0; }
+
+	// Names starting with text, then names with a part after an underscore starting with it, at most maxCount
+	std::vector<std::string> Complete(std::string_view text, size_t maxCount) const;
+
+	// Written to a temporary file and renamed, a reader never sees half a database. Fails
+	// before the list is parsed if the file cannot be created.
+	static bool Compile(const std::string& labelsFile, const std::string& fileName);
+	static std::string GetCompiledPath(const std::string& labelsFile, const std::string& cacheDir = "");
+
+	static constexpr unsigned int LABELDB_MAGIC = MAKE_MAGIC('L', 'B', 'D', 'B');
+	static constexpr unsigned int LABELDB_VERSION = 2;
+	static constexpr unsigned int BLOCK_SIZE = 16;
+	static constexpr unsigned int MAX_INDEX_BITS = 16;
+private:
+	struct Header
+	{
+		unsigned int m_Magic;
+		unsigned int m_Version;
+		unsigned int m_NumLabels;
+		unsigned int m_IndexBits;
+		unsigned long long m_SourceSize;	// Size and write time of the list, a mismatch means it changed
+		long long m_SourceTime;
+		unsigned int m_IndexOffset;			// (1 << m_IndexBits) + 1 column positions
+		unsigned int m_HashesOffset;		// Ascending
+		unsigned int m_NamesOffset;			// Name number of each hash
+		unsigned int m_BlocksOffset;		// Start of each block in the name data
+		unsigned int m_NumParts;
+		unsigned int m_PartsOffset;			// Name number << 8 | offset of each part after an underscore, sorted by the rest of the name
+		unsigned int m_DataOffset;			// Front coded names
+		unsigned int m_DataLength;			// Whole file
+	};
+
+	// Position of uHash in the hash column, m_NumLabels if it is not there
+	unsigned int FindPosition(unsigned int uHash) const;
+
+	// Blocks follow each other, decoding can go on past the end of one into the next
+	const unsigned char* DecodeNext(const unsigned char* pData, std::string& szName) const;
+	bool DecodeName(unsigned int uName, std::string& szName) const;
+	void CompletePrefix(std::string_view text, size_t maxCount, std::vector<std::string>& vNames) const;
+	void CompleteParts(std::string_view text, size_t maxCount, std::vector<std::string>& vNames) const;
+	static bool GetSourceStamp(const std::string& labelsFile, unsigned long long& size, long long& time);
+private:
+	std::unique_ptr<CMappedFile> m_File;
+	const Header* m_Header;
+	const unsigned int* m_Index;
+	const unsigned int* m_Hashes;
+	const unsigned int* m_Names;
+	const unsigned int* m_Blocks;
+	const unsigned int* m_Parts;
+	const unsigned char* m_Data;
+	const unsigned char* m_DataEnd;
+};
+
+#endif // !_LABELDB_H_
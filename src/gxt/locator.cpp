@@ -0,0 +1,395 @@
+//
+//	gxt/locator.cpp
+//
+
+// Project
+#include "locator.h"
+#include "gxt2.h"
+
+// C/C++
+#include <cstdio>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	template<typename T>
+	void WriteValue(std::ofstream& stream, const T& value)
+	{
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+
+	template<typename T>
+	bool ReadValue(std::ifstream& stream, T& value)
+	{
+		return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+	}
+
+	bool WriteString(std::ofstream& stream, const std::string& value)
+	{
+		if (value.size() > UINT16_MAX)
+		{
+			return false;
+		}
+		WriteValue(stream, static_cast<uint16_t>(value.size()));
+		stream.write(value.data(), static_cast<std::streamsize>(value.size()));
+		return true;
+	}
+
+	bool ReadString(std::ifstream& stream, std::string& value)
+	{
+		uint16_t uLength = 0;
+		if (!ReadValue(stream, uLength))
+		{
+			return false;
+		}
+		value.resize(uLength);
+		return static_cast<bool>(stream.read(value.data(), uLength));
+	}
+
+	void PutVarint(std::string& buffer, uint32_t uValue)
+	{
+		while (uValue >= 0x80)
+		{
+			buffer.push_back(static_cast<char>(uValue | 0x80));
+			uValue >>= 7;
+		}
+		buffer.push_back(static_cast<char>(uValue));
+	}
+
+	bool GetVarint(const char*& pData, const char* pEnd, uint32_t& uValue)
+	{
+		uValue = 0;
+		for (int shift = 0; shift < 35 && pData != pEnd; shift += 7)
+		{
+			const uint8_t uByte = static_cast<uint8_t>(*pData++);
+			uValue |= static_cast<uint32_t>(uByte & 0x7F) << shift;
+			if ((uByte & 0x80) == 0)
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+bool CHashLocator::Load(const std::string& indexFile)
+{
+	std::ifstream stream(indexFile, std::ios::binary);
+	if (!stream.is_open())
+	{
+		return false;
+	}
+
+	uint32_t uMagic = 0, uVersion = 0, uNumFiles = 0;
+	if (!ReadValue(stream, uMagic) || !ReadValue(stream, uVersion) || uMagic != INDEX_MAGIC || uVersion != INDEX_VERSION)
+	{
+		printf("Error: %s is not a hash locator index.\n", indexFile.c_str());
+		return false;
+	}
+
+	std::string root;
+	if (!ReadString(stream, root) || !ReadValue(stream, uNumFiles))
+	{
+		return false;
+	}
+	m_Root = std::filesystem::path(root);
+
+	m_Files.resize(uNumFiles);
+	for (File& file : m_Files)
+	{
+		if (!ReadString(stream, file.m_Path) ||
+			!ReadValue(stream, file.m_Size) ||
+			!ReadValue(stream, file.m_WriteTime) ||
+			!ReadValue(stream, file.m_NumEntries))
+		{
+			return false;
+		}
+	}
+
+	uint32_t uNumPostings = 0;
+	uint64_t uEncodedSize = 0;
+	if (!ReadValue(stream, uNumPostings) || !ReadValue(stream, uEncodedSize))
+	{
+		return false;
+	}
+
+	// The encoded postings are the rest of the file, a larger size is corrupted
+	const std::streamoff position = stream.tellg();
+	stream.seekg(0, std::ios::end);
+	const std::streamoff end = stream.tellg();
+	stream.seekg(position);
+
+	std::string buffer;
+	if (position < 0 || end < position || uEncodedSize > static_cast<uint64_t>(end - position))
+	{
+		printf("Error: %s is corrupted.\n", indexFile.c_str());
+		return false;
+	}
+	buffer.resize(static_cast<size_t>(uEncodedSize));
+
+	if (!stream.read(buffer.data(), static_cast<std::streamsize>(buffer.size())) || !DecodePostings(buffer, uNumPostings))
+	{
+		printf("Error: %s is corrupted.\n", indexFile.c_str());
+		return false;
+	}
+	return true;
+} // bool ::Load(const string& indexFile)
+
+bool CHashLocator::Save(const std::string& indexFile) const
+{
+	// Written next to the old index and swapped in, a concurrent query never sees half an index
+	const std::string tempFile = indexFile + ".tmp";
+	{
+		std::ofstream stream(tempFile, std::ios::binary | std::ios::trunc);
+		if (!stream.is_open())
+		{
+			return false;
+		}
+
+		WriteValue(stream, INDEX_MAGIC);
+		WriteValue(stream, INDEX_VERSION);
+		if (!WriteString(stream, m_Root.generic_string()))
+		{
+			return false;
+		}
+
+		WriteValue(stream, static_cast<uint32_t>(m_Files.size()));
+		for (const File& file : m_Files)
+		{
+			if (!WriteString(stream, file.m_Path))
+			{
+				return false;
+			}
+			WriteValue(stream, file.m_Size);
+			WriteValue(stream, file.m_WriteTime);
+			WriteValue(stream, file.m_NumEntries);
+		}
+
+		std::string buffer;
+		EncodePostings(buffer);
+
+		WriteValue(stream, static_cast<uint32_t>(m_FileIds.size()));
+		WriteValue(stream, static_cast<uint64_t>(buffer.size()));
+		stream.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+
+		if (!stream.good())
+		{
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tempFile, indexFile, ec);
+	return !ec;
+} // bool ::Save(const string& indexFile) const
+
+size_t CHashLocator::Update(const std::string& rootDir)
+{
+	const std::filesystem::path root = std::filesystem::absolute(rootDir).lexically_normal();
+
+	// Indexing a different tree, nothing of the old index can be reused
+	if (root != m_Root)
+	{
+		m_Root = root;
+		m_Files.clear();
+		m_Hashes.clear();
+		m_Offsets.clear();
+		m_FileIds.clear();
+	}
+
+	std::unordered_map<std::string, uint32_t> mPrevious;
+	for (uint32_t uFile = 0; uFile < m_Files.size(); uFile++)
+	{
+		mPrevious.emplace(m_Files[uFile].m_Path, uFile);
+	}
+
+	std::vector<std::filesystem::path> vPaths;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(m_Root, std::filesystem::directory_options::skip_permission_denied))
+	{
+		if (entry.is_regular_file() && entry.path().extension() == ".gxt2")
+		{
+			vPaths.push_back(entry.path());
+		}
+	}
+	std::sort(vPaths.begin(), vPaths.end());
+
+	// Previous file id to new file id, UINT32_MAX for dropped files
+	std::vector<uint32_t> vRemap(m_Files.size(), UINT32_MAX);
+	std::vector<Posting> vAdded;
+	std::vector<File> vFiles;
+	std::vector<unsigned int> vHashes;
+	size_t numRead = 0;
+
+	for (const std::filesystem::path& path : vPaths)
+	{
+		std::error_code ec;
+		File file;
+		file.m_Path = path.lexically_relative(m_Root).generic_string();
+		file.m_Size = std::filesystem::file_size(path, ec);
+		file.m_WriteTime = std::filesystem::last_write_time(path, ec).time_since_epoch().count();
+		file.m_NumEntries = 0;
+		if (ec)
+		{
+			continue;
+		}
+
+		const uint32_t uFile = static_cast<uint32_t>(vFiles.size());
+		if (auto it = mPrevious.find(file.m_Path); it != mPrevious.end())
+		{
+			File& previous = m_Files[it->second];
+			if (previous.m_Size == file.m_Size && previous.m_WriteTime == file.m_WriteTime)
+			{
+				vRemap[it->second] = uFile;
+				vFiles.push_back(std::move(previous));
+				continue;
+			}
+		}
+
+		try
+		{
+			CGxt2File gxt(path.string(), CFile::FLAGS_READ_COMPILED);
+			if (!gxt.ReadHashes(vHashes))
+			{
+				continue;
+			}
+		}
+		catch (const std::exception& ex)
+		{
+			printf("Error: %s\n", ex.what());
+			continue;
+		}
+
+		std::sort(vHashes.begin(), vHashes.end());
+		vHashes.erase(std::unique(vHashes.begin(), vHashes.end()), vHashes.end());
+
+		file.m_NumEntries = static_cast<uint32_t>(vHashes.size());
+		for (unsigned int uHash : vHashes)
+		{
+			vAdded.push_back({ uHash, uFile });
+		}
+
+		vFiles.push_back(std::move(file));
+		numRead++;
+	}
+
+	// Postings of unchanged files carry over, only their file ids move
+	std::vector<Posting> vPostings = ExpandPostings();
+	std::erase_if(vPostings, [&vRemap](Posting& posting) -> bool
+	{
+		posting.m_File = vRemap[posting.m_File];
+		return posting.m_File == UINT32_MAX;
+	});
+	vPostings.insert(vPostings.end(), vAdded.begin(), vAdded.end());
+	std::sort(vPostings.begin(), vPostings.end());
+
+	m_Files = std::move(vFiles);
+	CompressPostings(vPostings);
+	return numRead;
+} // size_t ::Update(const string& rootDir)
+
+std::vector<uint32_t> CHashLocator::Find(unsigned int uHash) const
+{
+	auto it = std::lower_bound(m_Hashes.begin(), m_Hashes.end(), uHash);
+	if (it == m_Hashes.end() || *it != uHash)
+	{
+		return {};
+	}
+
+	const size_t index = static_cast<size_t>(it - m_Hashes.begin());
+	return std::vector<uint32_t>(m_FileIds.begin() + m_Offsets[index], m_FileIds.begin() + m_Offsets[index + 1]);
+} // vector<uint32_t> ::Find(unsigned int uHash) const
+
+std::vector<CHashLocator::Posting> CHashLocator::ExpandPostings() const
+{
+	std::vector<Posting> vPostings;
+	vPostings.reserve(m_FileIds.size());
+
+	for (size_t i = 0; i < m_Hashes.size(); i++)
+	{
+		for (uint32_t j = m_Offsets[i]; j < m_Offsets[i + 1]; j++)
+		{
+			vPostings.push_back({ m_Hashes[i], m_FileIds[j] });
+		}
+	}
+	return vPostings;
+} // vector<Posting> ::ExpandPostings() const
+
+void CHashLocator::CompressPostings(std::vector<Posting>& vPostings)
+{
+	m_Hashes.clear();
+	m_Offsets.clear();
+	m_FileIds.clear();
+	m_FileIds.reserve(vPostings.size());
+
+	for (const Posting& posting : vPostings)
+	{
+		if (m_Hashes.empty() || m_Hashes.back() != posting.m_Hash)
+		{
+			m_Hashes.push_back(posting.m_Hash);
+			m_Offsets.push_back(static_cast<uint32_t>(m_FileIds.size()));
+		}
+		m_FileIds.push_back(posting.m_File);
+	}
+	m_Offsets.push_back(static_cast<uint32_t>(m_FileIds.size()));
+} // void ::CompressPostings(vector<Posting>& vPostings)
+
+void CHashLocator::EncodePostings(std::string& buffer) const
+{
+	// Per hash: the distance to the hash before, the number of files and the distance of each file id to the one before
+	uint32_t uPreviousHash = 0;
+	for (size_t i = 0; i < m_Hashes.size(); i++)
+	{
+		PutVarint(buffer, m_Hashes[i] - uPreviousHash);
+		PutVarint(buffer, m_Offsets[i + 1] - m_Offsets[i]);
+		uPreviousHash = m_Hashes[i];
+
+		uint32_t uPreviousFile = 0;
+		for (uint32_t j = m_Offsets[i]; j < m_Offsets[i + 1]; j++)
+		{
+			PutVarint(buffer, m_FileIds[j] - uPreviousFile);
+			uPreviousFile = m_FileIds[j];
+		}
+	}
+} // void ::EncodePostings(string& buffer) const
+
+bool CHashLocator::DecodePostings(const std::string& buffer, size_t numPostings)
+{
+	m_Hashes.clear();
+	m_Offsets.clear();
+	m_FileIds.clear();
+	m_FileIds.reserve(numPostings);
+
+	const char* pData = buffer.data();
+	const char* pEnd = pData + buffer.size();
+	uint32_t uHash = 0;
+
+	while (pData != pEnd)
+	{
+		uint32_t uDelta = 0, uCount = 0;
+		if (!GetVarint(pData, pEnd, uDelta) || !GetVarint(pData, pEnd, uCount) ||
+			uCount == 0 || uCount > numPostings - m_FileIds.size() ||
+			(!m_Hashes.empty() && (uDelta == 0 || uHash + uDelta < uHash)))
+		{
+			return false;
+		}
+		uHash += uDelta;
+		m_Hashes.push_back(uHash);
+		m_Offsets.push_back(static_cast<uint32_t>(m_FileIds.size()));
+
+		uint32_t uFile = 0;
+		for (uint32_t i = 0; i < uCount; i++)
+		{
+			if (!GetVarint(pData, pEnd, uDelta) || uDelta >= m_Files.size() - uFile || (i > 0 && uDelta == 0))
+			{
+				return false;
+			}
+			uFile += uDelta;
+			m_FileIds.push_back(uFile);
+		}
+	}
+	m_Offsets.push_back(static_cast<uint32_t>(m_FileIds.size()));
+
+	return m_FileIds.size() == numPostings;
+} // bool ::DecodePostings(const string& buffer, size_t numPostings)
@@ -0,0 +1,72 @@
+//
+//	gxt/locator.h
+//
+
+#ifndef _LOCATOR_H_
+#define _LOCATOR_H_
+
+// C/C++
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+// Inverted index over a tree of .gxt2 files, answers which files define a
+// hash without opening any of them. Only the offset tables are read while
+// indexing and files whose size and write time did not change are skipped
+// when the index is brought up to date. On disk the hashes and the file ids
+// of each hash are stored as variable length deltas.
+class CHashLocator
+{
+public:
+	struct File
+	{
+		std::string m_Path;			// Relative to the root, generic separators
+		uint64_t m_Size;
+		int64_t m_WriteTime;
+		uint32_t m_NumEntries;
+	};
+public:
+	CHashLocator() = default;
+
+	bool Load(const std::string& indexFile);
+	bool Save(const std::string& indexFile) const;
+
+	// Rescans the root and re-reads new or changed files, returns how many were read
+	size_t Update(const std::string& rootDir);
+
+	// Ids of the files defining uHash, ascending
+	std::vector<uint32_t> Find(unsigned int uHash) const;
+
+	const std::filesystem::path& GetRoot() const { return m_Root; }
+	const std::vector<File>& GetFiles() const { return m_Files; }
+	size_t GetNumHashes() const { return m_Hashes.size(); }
+	size_t GetNumPostings() const { return m_FileIds.size(); }
+
+	static constexpr uint32_t INDEX_MAGIC = 0x494C5847; // 'GXLI'
+	static constexpr uint32_t INDEX_VERSION = 2;
+private:
+	struct Posting
+	{
+		uint32_t m_Hash;
+		uint32_t m_File;
+
+		bool operator<(const Posting& other) const { return m_Hash != other.m_Hash ? m_Hash < other.m_Hash : m_File < other.m_File; }
+	};
+
+	std::vector<Posting> ExpandPostings() const;
+	void CompressPostings(std::vector<Posting>& vPostings);
+
+	void EncodePostings(std::string& buffer) const;
+	bool DecodePostings(const std::string& buffer, size_t numPostings);
+private:
+	std::filesystem::path m_Root;
+	std::vector<File> m_Files;
+
+	// Hash i is defined by m_FileIds[m_Offsets[i], m_Offsets[i + 1])
+	std::vector<uint32_t> m_Hashes;
+	std::vector<uint32_t> m_Offsets;
+	std::vector<uint32_t> m_FileIds;
+};
+
+#endif // !_LOCATOR_H_
@@ -51,8 +51,10 @@ bool CMerger::Run()
 	{
 		return false;
 	}
-	m_Output->SetData(m_Input1->GetData());
-	m_Output->SetData(m_Input2->GetData());
+
+	// The second file overrides the first, the tables are moved across
+	m_Output->SetData(m_Input1->TakeData());
+	m_Output->SetData(m_Input2->TakeData());
 	return m_Output->WriteEntries();
 
 } // bool ::Run()
@@ -0,0 +1,241 @@
+//
+//	gxt/patch.cpp
+//
+
+// Project
+#include "patch.h"
+
+// C/C++
+#include <format>
+#include <algorithm>
+#include <filesystem>
+
+namespace
+{
+	// A hard link may come from the conversion cache, the patch must not reach the cached copy
+	const std::string& DetachFile(const std::string& fileName)
+	{
+		std::error_code ec;
+		if (std::filesystem::hard_link_count(fileName, ec) > 1 && !ec)
+		{
+			const std::string tempFile = fileName + ".tmp";
+			std::filesystem::copy_file(fileName, tempFile, std::filesystem::copy_options::overwrite_existing);
+			std::filesystem::rename(tempFile, fileName);
+		}
+		return fileName;
+	}
+}
+
+CGxt2Patcher::CGxt2Patcher(const std::string& fileName) :
+	CFile(DetachFile(fileName), FLAGS_PATCH_COMPILED),
+	m_DataLength(0),
+	m_BytesRead(0),
+	m_BytesWritten(0)
+{
+	if (!ReadTable())
+	{
+		throw std::runtime_error(std::format("{} is not a valid GXT2 file.", fileName));
+	}
+} // ::CGxt2Patcher(const string& fileName)
+
+CGxt2Patcher::ePatchResult CGxt2Patcher::Patch(unsigned int uHash, std::string_view szText)
+{
+	// The terminator is the only delimiter in the heap
+	if (szText.find('\0') != std::string_view::npos)
+	{
+		return PATCH_INVALID_TEXT;
+	}
+
+	auto it = m_Index.find(uHash);
+	if (it == m_Index.end())
+	{
+		return PATCH_NOT_FOUND;
+	}
+
+	Entry& entry = m_Table[it->second];
+	const unsigned int uOffset = entry.m_Offset;
+	const unsigned int uSlotStart = GetSlotStart(uOffset);
+	const unsigned int uSlotEnd = GetSlotEnd(uOffset);
+
+	// One read covers the previous string and this slot. The previous string has to end
+	// before this one starts, otherwise the two share a tail and neither is ours alone.
+	std::vector<char> vSlot(uSlotEnd - uSlotStart);
+	if (!ReadAt(uSlotStart, vSlot.data(), static_cast<unsigned int>(vSlot.size())))
+	{
+		return PATCH_FAILED;
+	}
+
+	const size_t relativeOffset = uOffset - uSlotStart;
+	const auto itPreviousEnd = std::find(vSlot.begin(), vSlot.begin() + static_cast<ptrdiff_t>(relativeOffset), '\0');
+	const auto itOldEnd = std::find(vSlot.begin() + static_cast<ptrdiff_t>(relativeOffset), vSlot.end(), '\0');
+
+	const bool bOwnsSlot = m_References[uOffset] == 1 &&
+		(relativeOffset == 0 || itPreviousEnd != vSlot.begin() + static_cast<ptrdiff_t>(relativeOffset)) &&
+		itOldEnd != vSlot.end();
+	const size_t oldLength = static_cast<size_t>(itOldEnd - (vSlot.begin() + static_cast<ptrdiff_t>(relativeOffset)));
+	const size_t capacity = uSlotEnd - uOffset;
+
+	if (bOwnsSlot && szText.size() < capacity)
+	{
+		// Leftovers of a longer old string are cleared, they become slack for the next patch
+		std::string szSlot(szText);
+		szSlot.resize(std::max(szText.size(), oldLength) + 1, '\0');
+		return WriteAt(uOffset, szSlot.data(), static_cast<unsigned int>(szSlot.size())) ? PATCH_IN_PLACE : PATCH_FAILED;
+	}
+
+	const unsigned int uNewOffset = m_DataLength;
+	const unsigned int uNewLength = m_DataLength + static_cast<unsigned int>(szText.size()) + 1;
+	const unsigned int uTableEnd = 8 + static_cast<unsigned int>(m_Table.size()) * 8;
+
+	std::string szSlot(szText);
+	szSlot.push_back('\0');
+
+	// String first, then the entry and the length, an interrupted patch leaves a valid file
+	if (!WriteAt(uNewOffset, szSlot.data(), static_cast<unsigned int>(szSlot.size())) ||
+		!WriteValueAt(8 + static_cast<unsigned int>(it->second) * 8 + 4, uNewOffset) ||
+		!WriteValueAt(uTableEnd + 4, uNewLength))
+	{
+		return PATCH_FAILED;
+	}
+
+	entry.m_Offset = uNewOffset;
+	m_DataLength = uNewLength;
+	RemoveReference(uOffset);
+	AddReference(uNewOffset);
+
+	if (bOwnsSlot)
+	{
+		const std::string szZero(oldLength + 1, '\0');
+		WriteAt(uOffset, szZero.data(), static_cast<unsigned int>(szZero.size()));
+	}
+	return PATCH_APPENDED;
+} // ePatchResult ::Patch(unsigned int uHash, string_view szText)
+
+bool CGxt2Patcher::ReadTable()
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	unsigned int uMagic = 0, uNumEntries = 0;
+	if (!ReadAt(0, reinterpret_cast<char*>(&uMagic), sizeof(uMagic)))
+	{
+		return false;
+	}
+
+	if (uMagic == CGxt2File::GXT2_MAGIC_LE)
+	{
+		SetLittleEndian();
+	}
+	else if (uMagic == CGxt2File::GXT2_MAGIC_BE)
+	{
+		SetBigEndian();
+	}
+	else
+	{
+		return false;
+	}
+
+	if (!ReadAt(4, reinterpret_cast<char*>(&uNumEntries), sizeof(uNumEntries)))
+	{
+		return false;
+	}
+	DoSwapEndian(uNumEntries);
+
+	// The count is not trusted with the allocation, the table and the heap header have to fit in the file
+	End();
+	const uint64_t uFileSize = GetPosition();
+	if (16 + static_cast<uint64_t>(uNumEntries) * sizeof(Entry) > uFileSize)
+	{
+		return false;
+	}
+
+	m_Table.resize(uNumEntries);
+	if (!ReadAt(8, reinterpret_cast<char*>(m_Table.data()), uNumEntries * static_cast<unsigned int>(sizeof(Entry))) ||
+		!ReadAt(8 + uNumEntries * 8 + 4, reinterpret_cast<char*>(&m_DataLength), sizeof(m_DataLength)))
+	{
+		return false;
+	}
+	DoSwapEndian(m_DataLength);
+
+	// A string below the heap would let an in place patch overwrite the header or the table
+	const uint64_t uHeapStart = 16 + static_cast<uint64_t>(uNumEntries) * sizeof(Entry);
+
+	m_Index.reserve(uNumEntries);
+	for (size_t i = 0; i < m_Table.size(); i++)
+	{
+		DoSwapEndian(m_Table[i].m_Hash);
+		DoSwapEndian(m_Table[i].m_Offset);
+
+		if (m_Table[i].m_Offset < uHeapStart || m_Table[i].m_Offset >= m_DataLength)
+		{
+			return false;
+		}
+		m_Index[m_Table[i].m_Hash] = i;
+		m_References[m_Table[i].m_Offset]++;
+	}
+
+	m_Offsets.reserve(m_References.size());
+	for (const auto& [uOffset, uCount] : m_References)
+	{
+		m_Offsets.push_back(uOffset);
+	}
+	std::sort(m_Offsets.begin(), m_Offsets.end());
+	return true;
+} // bool ::ReadTable()
+
+bool CGxt2Patcher::ReadAt(unsigned int uPosition, char* pData, unsigned int size)
+{
+	m_File.clear();
+	Seek(static_cast<int>(uPosition));
+	Read(pData, size);
+	m_BytesRead += size;
+	return m_File.good();
+} // bool ::ReadAt(unsigned int uPosition, char* pData, unsigned int size)
+
+bool CGxt2Patcher::WriteAt(unsigned int uPosition, const char* pData, unsigned int size)
+{
+	// filebuf has a single position for both directions, seeking also switches modes
+	m_File.clear();
+	m_File.seekp(uPosition);
+	Write(pData, size);
+	m_File.flush();
+	m_BytesWritten += size;
+	return m_File.good();
+} // bool ::WriteAt(unsigned int uPosition, const char* pData, unsigned int size)
+
+bool CGxt2Patcher::WriteValueAt(unsigned int uPosition, unsigned int uValue)
+{
+	DoSwapEndian(uValue);
+	return WriteAt(uPosition, reinterpret_cast<const char*>(&uValue), sizeof(uValue));
+} // bool ::WriteValueAt(unsigned int uPosition, unsigned int uValue)
+
+unsigned int CGxt2Patcher::GetSlotEnd(unsigned int uOffset) const
+{
+	auto it = std::upper_bound(m_Offsets.begin(), m_Offsets.end(), uOffset);
+	return (it != m_Offsets.end()) ? *it : m_DataLength;
+} // unsigned int ::GetSlotEnd(unsigned int uOffset) const
+
+unsigned int CGxt2Patcher::GetSlotStart(unsigned int uOffset) const
+{
+	auto it = std::lower_bound(m_Offsets.begin(), m_Offsets.end(), uOffset);
+	return (it != m_Offsets.begin()) ? *(it - 1) : uOffset;
+} // unsigned int ::GetSlotStart(unsigned int uOffset) const
+
+void CGxt2Patcher::AddReference(unsigned int uOffset)
+{
+	if (m_References[uOffset]++ == 0)
+	{
+		m_Offsets.insert(std::upper_bound(m_Offsets.begin(), m_Offsets.end(), uOffset), uOffset);
+	}
+} // void ::AddReference(unsigned int uOffset)
+
+void CGxt2Patcher::RemoveReference(unsigned int uOffset)
+{
+	if (--m_References[uOffset] == 0)
+	{
+		m_References.erase(uOffset);
+		m_Offsets.erase(std::lower_bound(m_Offsets.begin(), m_Offsets.end(), uOffset));
+	}
+} // void ::RemoveReference(unsigned int uOffset)
@@ -0,0 +1,68 @@
+//
+//	gxt/patch.h
+//
+
+#ifndef _PATCH_H_
+#define _PATCH_H_
+
+// Project
+#include "gxt2.h"
+
+// C/C++
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+
+// Rewrites single strings of a compiled table without touching the rest of
+// the file. Only the offset table is read up front. A new string that fits
+// in its old slot, including unreferenced bytes up to the next string, is
+// written over it. Anything longer is appended to the heap and the entry
+// offset and data length are updated, the old slot is zeroed so neighbours
+// can grow into it later. Strings shared by several entries are never
+// overwritten. New hashes would shift the heap and need a full rewrite.
+class CGxt2Patcher : public CFile
+{
+public:
+	enum ePatchResult
+	{
+		PATCH_IN_PLACE,
+		PATCH_APPENDED,
+		PATCH_NOT_FOUND,
+		PATCH_INVALID_TEXT,
+		PATCH_FAILED,
+	};
+public:
+	explicit CGxt2Patcher(const std::string& fileName);
+
+	ePatchResult Patch(unsigned int uHash, std::string_view szText);
+
+	size_t GetBytesRead() const { return m_BytesRead; }
+	size_t GetBytesWritten() const { return m_BytesWritten; }
+private:
+	struct Entry
+	{
+		unsigned int m_Hash;
+		unsigned int m_Offset;
+	};
+
+	bool ReadTable();
+	bool ReadAt(unsigned int uPosition, char* pData, unsigned int size);
+	bool WriteAt(unsigned int uPosition, const char* pData, unsigned int size);
+	bool WriteValueAt(unsigned int uPosition, unsigned int uValue);
+
+	// First referenced offset after uOffset, the end of the heap for the last string
+	unsigned int GetSlotEnd(unsigned int uOffset) const;
+	unsigned int GetSlotStart(unsigned int uOffset) const;
+	void AddReference(unsigned int uOffset);
+	void RemoveReference(unsigned int uOffset);
+private:
+	std::vector<Entry> m_Table;							// File order
+	std::unordered_map<unsigned int, size_t> m_Index;	// Hash to table index
+	std::vector<unsigned int> m_Offsets;				// Referenced offsets, ascending and unique
+	std::unordered_map<unsigned int, unsigned int> m_References;
+	unsigned int m_DataLength;
+	size_t m_BytesRead;
+	size_t m_BytesWritten;
+};
+
+#endif // !_PATCH_H_
@@ -0,0 +1,128 @@
+//
+//	gxt/pipeline.cpp
+//
+
+// Project
+#include "pipeline.h"
+
+// C/C++
+#include <algorithm>
+
+CChunkReadBuffer::CChunkReadBuffer(ChunkQueue& queue) :
+	m_Queue(queue),
+	m_ChunkStart(0)
+{
+	setg(nullptr, nullptr, nullptr);
+} // ::CChunkReadBuffer(ChunkQueue& queue)
+
+CChunkReadBuffer::int_type CChunkReadBuffer::underflow()
+{
+	if (gptr() < egptr())
+	{
+		return traits_type::to_int_type(*gptr());
+	}
+
+	m_ChunkStart += static_cast<std::streamoff>(m_Chunk.size());
+	m_Chunk.clear();
+
+	while (m_Chunk.empty())
+	{
+		if (!m_Queue.Pop(m_Chunk))
+		{
+			setg(nullptr, nullptr, nullptr);
+			return traits_type::eof();
+		}
+	}
+
+	setg(m_Chunk.data(), m_Chunk.data(), m_Chunk.data() + m_Chunk.size());
+	return traits_type::to_int_type(*gptr());
+} // int_type ::underflow()
+
+CChunkReadBuffer::pos_type CChunkReadBuffer::seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which)
+{
+	if (dir == std::ios_base::cur)
+	{
+		return seekpos(GetPosition() + off, which);
+	}
+	if (dir == std::ios_base::beg)
+	{
+		return seekpos(off, which);
+	}
+	return pos_type(off_type(-1));
+} // pos_type ::seekoff(off_type off, seekdir dir, openmode which)
+
+CChunkReadBuffer::pos_type CChunkReadBuffer::seekpos(pos_type pos, std::ios_base::openmode which)
+{
+	const std::streamoff target = pos;
+
+	if (!(which & std::ios_base::in) || target < GetPosition())
+	{
+		return pos_type(off_type(-1));
+	}
+
+	// Skip ahead, chunks that were already handed out cannot be revisited
+	while (GetPosition() < target)
+	{
+		if (gptr() == egptr() && traits_type::eq_int_type(underflow(), traits_type::eof()))
+		{
+			return pos_type(off_type(-1));
+		}
+
+		const std::streamoff skip = std::min<std::streamoff>(target - GetPosition(), egptr() - gptr());
+		gbump(static_cast<int>(skip));
+	}
+	return pos;
+} // pos_type ::seekpos(pos_type pos, openmode which)
+
+std::streamoff CChunkReadBuffer::GetPosition() const
+{
+	return m_ChunkStart + (gptr() - eback());
+} // streamoff ::GetPosition() const
+
+//-----------------------------------------------------------------------------------------
+//
+
+CChunkWriteBuffer::CChunkWriteBuffer(ChunkQueue& queue) :
+	m_Queue(queue)
+{
+	m_Chunk.reserve(CHUNK_SIZE);
+} // ::CChunkWriteBuffer(ChunkQueue& queue)
+
+bool CChunkWriteBuffer::Flush()
+{
+	if (m_Chunk.empty())
+	{
+		return true;
+	}
+
+	const bool bSuccess = m_Queue.Push(std::move(m_Chunk));
+	m_Chunk.clear();
+	m_Chunk.reserve(CHUNK_SIZE);
+
+	return bSuccess;
+} // bool ::Flush()
+
+CChunkWriteBuffer::int_type CChunkWriteBuffer::overflow(int_type ch)
+{
+	if (traits_type::eq_int_type(ch, traits_type::eof()))
+	{
+		return traits_type::not_eof(ch);
+	}
+
+	m_Chunk.push_back(traits_type::to_char_type(ch));
+	if (m_Chunk.size() >= CHUNK_SIZE && !Flush())
+	{
+		return traits_type::eof();
+	}
+	return ch;
+} // int_type ::overflow(int_type ch)
+
+std::streamsize CChunkWriteBuffer::xsputn(const char* s, std::streamsize count)
+{
+	m_Chunk.append(s, static_cast<size_t>(count));
+	if (m_Chunk.size() >= CHUNK_SIZE && !Flush())
+	{
+		return 0;
+	}
+	return count;
+} // streamsize ::xsputn(const char* s, streamsize count)
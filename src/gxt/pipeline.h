@@ -0,0 +1,53 @@
+//
+//	gxt/pipeline.h
+//
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+// Project
+#include "data/spscqueue.h"
+
+// C/C++
+#include <string>
+#include <streambuf>
+
+using ChunkQueue = CSpscQueue<std::string>;
+
+// Input side of a stage, lets the CFile codecs read from chunks that
+// another thread pops off the disk. Only forward seeks are supported.
+class CChunkReadBuffer : public std::streambuf
+{
+public:
+	explicit CChunkReadBuffer(ChunkQueue& queue);
+protected:
+	int_type underflow() override;
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override;
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+private:
+	std::streamoff GetPosition() const;
+private:
+	ChunkQueue& m_Queue;
+	std::string m_Chunk;
+	std::streamoff m_ChunkStart;
+};
+
+// Output side of a stage, collects whatever the CFile codecs write into
+// chunks and hands them to the thread that writes them to disk.
+class CChunkWriteBuffer : public std::streambuf
+{
+public:
+	static constexpr size_t CHUNK_SIZE = 1 << 20;
+
+	explicit CChunkWriteBuffer(ChunkQueue& queue);
+
+	bool Flush();
+protected:
+	int_type overflow(int_type ch) override;
+	std::streamsize xsputn(const char* s, std::streamsize count) override;
+private:
+	ChunkQueue& m_Queue;
+	std::string m_Chunk;
+};
+
+#endif // !_PIPELINE_H_
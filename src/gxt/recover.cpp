@@ -0,0 +1,322 @@
+//
+//	gxt/recover.cpp
+//
+
+// Project
+#include "recover.h"
+#include "data/hashset.h"
+#include "data/parallel.h"
+#include "data/stringhash.h"
+
+// C/C++
+#include <set>
+#include <mutex>
+#include <format>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+	std::string ToUpper(std::string_view value)
+	{
+		std::string result(value);
+		for (char& c : result)
+		{
+			if (c >= 'a' && c <= 'z')
+			{
+				c -= 'a' - 'A';
+			}
+		}
+		return result;
+	}
+
+	size_t GetNumTrailingDigits(std::string_view value)
+	{
+		const size_t last = value.find_last_not_of("0123456789");
+		return value.size() - (last == std::string_view::npos ? 0 : last + 1);
+	}
+
+	// Most frequent first, ties in text order so the same labels always give the same search
+	std::vector<std::string> GetMostFrequent(const std::unordered_map<std::string, size_t>& mCounts, size_t maxCount)
+	{
+		std::vector<std::pair<std::string, size_t>> vSorted(mCounts.begin(), mCounts.end());
+		std::sort(vSorted.begin(), vSorted.end(), [](const auto& a, const auto& b)
+		{
+			return a.second != b.second ? a.second > b.second : a.first < b.first;
+		});
+
+		std::vector<std::string> vResult;
+		for (size_t i = 0; i < vSorted.size() && i < maxCount; i++)
+		{
+			vResult.push_back(std::move(vSorted[i].first));
+		}
+		return vResult;
+	}
+}
+
+// One stem worth of candidates. The partial hash of every node is extended in
+// place, the name itself is only put together for a match.
+struct CLabelRecovery::StemSearch
+{
+	struct Hit
+	{
+		unsigned int m_Hash;
+		std::string m_Name;
+		unsigned int m_Shape;
+	};
+
+	StemSearch(const CLabelRecovery& recovery, const CHashSet& unknown) :
+		m_Recovery(recovery),
+		m_Unknown(unknown),
+		m_States(recovery.m_Depth + 1, std::vector<unsigned int>(recovery.m_Numbers.size())),
+		m_NumTried(recovery.m_NumTried.size())
+	{
+	}
+
+	void Test(unsigned int uPartialHash, const std::string* pNumber, unsigned int shape)
+	{
+		const unsigned int uHash = rage::atFinalizeHash(uPartialHash);
+		if (!m_Unknown.Contains(uHash))
+		{
+			return;
+		}
+
+		std::string szName;
+		for (size_t i = 0; i < m_Path.size(); i++)
+		{
+			szName += (i > 1) ? "_" : "";
+			szName += *m_Path[i];
+		}
+		szName += pNumber ? *pNumber : "";
+
+		// The extension is cheap to get wrong, whatever is reported has been hashed in full
+		if (rage::atStringHash(szName.c_str()) == uHash)
+		{
+			m_Hits.push_back({ uHash, ToUpper(szName), shape });
+		}
+	}
+
+	void Expand(unsigned int uPartialHash, unsigned int level)
+	{
+		Test(uPartialHash, nullptr, level * 2);
+
+		// Parents come first, so every number is one step from a state that is already known
+		const std::vector<NumberNode>& vNumbers = m_Recovery.m_Numbers;
+		std::vector<unsigned int>& vStates = m_States[level];
+		for (size_t i = 0; i < vNumbers.size(); i++)
+		{
+			const NumberNode& node = vNumbers[i];
+			vStates[i] = rage::atPartialCharHash(node.m_Char, node.m_Parent == NO_PARENT ? uPartialHash : vStates[node.m_Parent]);
+			if (node.m_IsNumber)
+			{
+				Test(vStates[i], &node.m_Text, level * 2 + 1);
+				m_NumTried[level * 2 + 1]++;
+			}
+		}
+		m_NumTried[level * 2]++;
+
+		if (level >= m_Recovery.m_Depth)
+		{
+			return;
+		}
+
+		// The first token follows the stem directly, the stem brings its own separator
+		const unsigned int uJoined = (level > 0) ? rage::atPartialCharHash('_', uPartialHash) : uPartialHash;
+		for (const std::string& token : m_Recovery.m_Tokens)
+		{
+			m_Path.push_back(&token);
+			Expand(rage::atPartialStringHash(token.c_str(), uJoined), level + 1);
+			m_Path.pop_back();
+		}
+	}
+
+	const CLabelRecovery& m_Recovery;
+	const CHashSet& m_Unknown;
+	std::vector<std::vector<unsigned int>> m_States;		// Number states by level
+	std::vector<const std::string*> m_Path;				// Stem and tokens
+	std::vector<Hit> m_Hits;
+	std::vector<unsigned long long> m_NumTried;
+};
+
+CLabelRecovery::CLabelRecovery(const std::vector<std::string>& vKnownLabels,
+	size_t maxStems /*= DEFAULT_MAX_STEMS*/, size_t maxTokens /*= DEFAULT_MAX_TOKENS*/,
+	unsigned int maxNumber /*= DEFAULT_MAX_NUMBER*/, unsigned int depth /*= DEFAULT_DEPTH*/) :
+	m_Depth(depth)
+{
+	std::unordered_map<std::string, size_t> mStems, mTokens, mNumberStyles;
+	size_t numNumbered = 0;
+
+	for (const std::string& knownLabel : vKnownLabels)
+	{
+		const std::string label = ToUpper(knownLabel);
+
+		// Everything up to an underscore, each stem counted once per label
+		std::vector<std::string> vStems;
+		for (size_t pos = label.find('_'); pos != std::string::npos && pos + 1 < label.size(); pos = label.find('_', pos + 1))
+		{
+			vStems.push_back(label.substr(0, pos + 1));
+		}
+
+		const size_t numDigits = GetNumTrailingDigits(label);
+		if (numDigits > 0 && numDigits < label.size())
+		{
+			const std::string_view stem = std::string_view(label).substr(0, label.size() - numDigits);
+			if (!stem.ends_with('_'))
+			{
+				vStems.emplace_back(stem);
+			}
+
+			// Separator and zero padding of the number, 0 stands for no padding
+			const size_t width = (label[label.size() - numDigits] == '0' && numDigits > 1) ? numDigits : 0;
+			mNumberStyles[std::format("{}{}", stem.ends_with('_') ? "_" : "", width)]++;
+			numNumbered++;
+		}
+
+		for (const std::string& stem : vStems)
+		{
+			mStems[stem]++;
+		}
+
+		size_t start = 0;
+		while (start <= label.size())
+		{
+			const size_t end = std::min(label.find('_', start), label.size());
+			const std::string_view token = std::string_view(label).substr(start, end - start);
+			const size_t numTokenDigits = GetNumTrailingDigits(token);
+
+			if (numTokenDigits < token.size())
+			{
+				mTokens[std::string(token.substr(0, token.size() - numTokenDigits))]++;
+			}
+			start = end + 1;
+		}
+	}
+
+	m_Stems.push_back("");
+	for (std::string& stem : GetMostFrequent(mStems, maxStems))
+	{
+		m_Stems.push_back(std::move(stem));
+	}
+	m_Tokens = GetMostFrequent(mTokens, maxTokens);
+
+	// Rare styles are left out, every style multiplies the whole search
+	std::set<std::string> numbers;
+	for (const auto& [style, count] : mNumberStyles)
+	{
+		if (count * 100 < numNumbered)
+		{
+			continue;
+		}
+
+		const bool bSeparated = style.starts_with('_');
+		const size_t width = strtoul(style.c_str() + (bSeparated ? 1 : 0), nullptr, 10);
+		for (unsigned int n = 0; n < maxNumber; n++)
+		{
+			const std::string number = std::to_string(n);
+			numbers.insert(std::format("{}{}{}", bSeparated ? "_" : "", std::string(width > number.size() ? width - number.size() : 0, '0'), number));
+		}
+	}
+
+	// Sorted, so the prefixes of a number have been added by the time it comes up
+	std::map<std::string, size_t> mNodes;
+	for (const std::string& number : numbers)
+	{
+		for (size_t length = 1; length <= number.size(); length++)
+		{
+			const std::string text = number.substr(0, length);
+			auto it = mNodes.find(text);
+			if (it == mNodes.end())
+			{
+				const size_t parent = (length > 1) ? mNodes[number.substr(0, length - 1)] : NO_PARENT;
+				m_Numbers.push_back({ parent, text.back(), false, text });
+				it = mNodes.emplace(text, m_Numbers.size() - 1).first;
+			}
+			m_Numbers[it->second].m_IsNumber |= (length == number.size());
+		}
+	}
+
+	m_NumTried.assign((m_Depth + 1) * 2, 0);
+	m_NumMatched.assign((m_Depth + 1) * 2, 0);
+} // ::CLabelRecovery(const vector<string>& vKnownLabels, size_t maxStems, size_t maxTokens, unsigned int maxNumber, unsigned int depth)
+
+CLabelRecovery::Names CLabelRecovery::Search(const std::vector<unsigned int>& vUnknown, unsigned int numThreads /*= 0*/)
+{
+	CHashSet unknown;
+	unknown.Reserve(vUnknown.size());
+	for (unsigned int uHash : vUnknown)
+	{
+		unknown.Insert(uHash);
+	}
+
+	std::fill(m_NumTried.begin(), m_NumTried.end(), 0);
+	std::fill(m_NumMatched.begin(), m_NumMatched.end(), 0);
+
+	std::vector<StemSearch::Hit> vHits;
+	std::mutex mutex;
+
+	// A worker takes the next stem when it is done, stems differ a lot in how long they take
+	RunParallel(m_Stems.size(), numThreads, [this, &unknown, &vHits, &mutex](size_t index)
+	{
+		StemSearch search(*this, unknown);
+		search.m_Path.push_back(&m_Stems[index]);
+		search.Expand(rage::atPartialStringHash(m_Stems[index].c_str()), 0);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		for (size_t shape = 0; shape < m_NumTried.size(); shape++)
+		{
+			m_NumTried[shape] += search.m_NumTried[shape];
+		}
+		vHits.insert(vHits.end(), std::make_move_iterator(search.m_Hits.begin()), std::make_move_iterator(search.m_Hits.end()));
+	});
+
+	for (const StemSearch::Hit& hit : vHits)
+	{
+		m_NumMatched[hit.m_Shape]++;
+	}
+
+	// Chance alone gives tried * unknown / 2^32 matches per shape
+	std::vector<double> vPrecision(m_NumTried.size());
+	for (size_t shape = 0; shape < m_NumTried.size(); shape++)
+	{
+		const double expected = static_cast<double>(m_NumTried[shape]) * static_cast<double>(unknown.GetSize()) / 4294967296.0;
+		vPrecision[shape] = m_NumMatched[shape] ? std::max(0.0, 1.0 - expected / static_cast<double>(m_NumMatched[shape])) : 0.0;
+	}
+
+	Names mNames;
+	for (StemSearch::Hit& hit : vHits)
+	{
+		std::vector<Match>& vMatches = mNames[hit.m_Hash];
+		const double precision = vPrecision[hit.m_Shape];
+
+		// Several shapes can spell the same name, it counts with the best of them
+		auto it = std::find_if(vMatches.begin(), vMatches.end(), [&hit](const Match& match) { return match.m_Name == hit.m_Name; });
+		if (it == vMatches.end())
+		{
+			vMatches.push_back({ std::move(hit.m_Name), precision });
+		}
+		else
+		{
+			it->m_Precision = std::max(it->m_Precision, precision);
+		}
+	}
+
+	for (auto& [uHash, vMatches] : mNames)
+	{
+		std::sort(vMatches.begin(), vMatches.end(), [](const Match& a, const Match& b)
+		{
+			return a.m_Precision != b.m_Precision ? a.m_Precision > b.m_Precision : a.m_Name < b.m_Name;
+		});
+	}
+	return mNames;
+} // Names ::Search(const vector<unsigned int>& vUnknown, unsigned int numThreads)
+
+unsigned long long CLabelRecovery::GetNumCandidates() const
+{
+	unsigned long long numCandidates = 0;
+	for (unsigned long long numTried : m_NumTried)
+	{
+		numCandidates += numTried;
+	}
+	return numCandidates;
+} // unsigned long long ::GetNumCandidates() const
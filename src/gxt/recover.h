@@ -0,0 +1,72 @@
+//
+//	gxt/recover.h
+//
+
+#ifndef _RECOVER_H_
+#define _RECOVER_H_
+
+// C/C++
+#include <map>
+#include <string>
+#include <vector>
+
+// Guesses names for hashes without a known label. The known labels are
+// mined for stems (everything up to an underscore, or up to trailing
+// digits), tokens (the parts between underscores) and the number styles
+// they end in. Candidates are a stem followed by up to depth tokens joined
+// by underscores and an optional number. The hash state of every stem and
+// token chain is computed once and reused for all of its extensions, the
+// numbers are walked as a trie so each costs a single character step.
+//
+// With 32-bit hashes a big search also turns up names that only collide.
+// Every candidate shape (number of tokens, with or without a number) keeps
+// count of how many it tried, matches of a shape that found far more than
+// chance would give are likely to be real.
+class CLabelRecovery
+{
+public:
+	struct Match
+	{
+		std::string m_Name;
+		double m_Precision;		// Share of the matches of its shape that are not chance
+	};
+	using Names = std::map<unsigned int, std::vector<Match>>;
+public:
+	CLabelRecovery(const std::vector<std::string>& vKnownLabels,
+		size_t maxStems = DEFAULT_MAX_STEMS, size_t maxTokens = DEFAULT_MAX_TOKENS,
+		unsigned int maxNumber = DEFAULT_MAX_NUMBER, unsigned int depth = DEFAULT_DEPTH);
+
+	// Every candidate hashing to one of vUnknown, best first. Each one is checked against atStringHash.
+	Names Search(const std::vector<unsigned int>& vUnknown, unsigned int numThreads = 0);
+
+	// Candidates the last search tried
+	unsigned long long GetNumCandidates() const;
+
+	size_t GetNumStems() const { return m_Stems.size(); }
+	size_t GetNumTokens() const { return m_Tokens.size(); }
+
+	static constexpr size_t DEFAULT_MAX_STEMS = 2048;
+	static constexpr size_t DEFAULT_MAX_TOKENS = 4096;
+	static constexpr unsigned int DEFAULT_MAX_NUMBER = 100;
+	static constexpr unsigned int DEFAULT_DEPTH = 1;
+private:
+	struct NumberNode
+	{
+		size_t m_Parent;		// Always before the node, NO_PARENT for a first character
+		char m_Char;
+		bool m_IsNumber;		// A whole number ends here and is a candidate
+		std::string m_Text;
+	};
+	struct StemSearch;
+
+	static constexpr size_t NO_PARENT = static_cast<size_t>(-1);
+private:
+	std::vector<std::string> m_Stems;		// Most frequent first, the empty stem included
+	std::vector<std::string> m_Tokens;		// Most frequent first
+	std::vector<NumberNode> m_Numbers;		// Every number in every style, separator included
+	unsigned int m_Depth;
+	std::vector<unsigned long long> m_NumTried;		// By shape, the number of tokens times two plus one with a number
+	std::vector<unsigned long long> m_NumMatched;
+};
+
+#endif // !_RECOVER_H_
@@ -0,0 +1,378 @@
+//
+//	gxt/shmtable.cpp
+//
+
+// Project
+#include "shmtable.h"
+
+// C/C++
+#include <atomic>
+#include <cstdio>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+// POSIX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace
+{
+	// Loads on the read-only mapping, atomic_ref<const T> is not C++20
+	uint32_t LoadReady(const shm::SharedHeader* pHeader)
+	{
+		return std::atomic_ref<uint32_t>(const_cast<uint32_t&>(pHeader->m_Ready)).load(std::memory_order_acquire);
+	}
+
+	std::string GetObjectName(const std::string& name)
+	{
+		// Portable shared memory names are a single leading slash and no others
+		return name.starts_with("/") ? name : "/" + name;
+	}
+
+	uint64_t Align(uint64_t offset)
+	{
+		return (offset + 7) & ~static_cast<uint64_t>(7);
+	}
+
+	std::string GetSegmentName(const std::string& objectName, uint64_t serial)
+	{
+		return objectName + "." + std::to_string(serial);
+	}
+
+	uint64_t LoadSerial(const shm::SharedCurrent* pCurrent)
+	{
+		return std::atomic_ref<uint64_t>(const_cast<uint64_t&>(pCurrent->m_Serial)).load(std::memory_order_acquire);
+	}
+
+	// The current object is only mapped long enough to read it
+	bool ReadSerial(const std::string& objectName, uint64_t& serial)
+	{
+		const int fd = shm_open(objectName.c_str(), O_RDONLY, 0);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat info = {};
+		bool bSuccess = fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(shm::SharedCurrent);
+		if (bSuccess)
+		{
+			void* pMapping = mmap(nullptr, sizeof(shm::SharedCurrent), PROT_READ, MAP_SHARED, fd, 0);
+			bSuccess = (pMapping != MAP_FAILED);
+			if (bSuccess)
+			{
+				const shm::SharedCurrent* pCurrent = static_cast<const shm::SharedCurrent*>(pMapping);
+				serial = LoadSerial(pCurrent);
+				bSuccess = pCurrent->m_Magic == shm::CURRENT_MAGIC && pCurrent->m_Version == shm::VERSION && serial != 0;
+				munmap(pMapping, sizeof(shm::SharedCurrent));
+			}
+		}
+		close(fd);
+
+		return bSuccess;
+	}
+
+	// Switches readers over to a segment, previous is the serial it replaced or 0
+	bool StoreSerial(const std::string& objectName, uint64_t serial, uint64_t& previous)
+	{
+		const int fd = shm_open(objectName.c_str(), O_CREAT | O_RDWR, 0644);
+		if (fd < 0)
+		{
+			return false;
+		}
+
+		struct stat info = {};
+		bool bSuccess = fstat(fd, &info) == 0 &&
+			(static_cast<size_t>(info.st_size) >= sizeof(shm::SharedCurrent) || ftruncate(fd, sizeof(shm::SharedCurrent)) == 0);
+		if (bSuccess)
+		{
+			void* pMapping = mmap(nullptr, sizeof(shm::SharedCurrent), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+			bSuccess = (pMapping != MAP_FAILED);
+			if (bSuccess)
+			{
+				shm::SharedCurrent* pCurrent = static_cast<shm::SharedCurrent*>(pMapping);
+				const bool bKnown = pCurrent->m_Magic == shm::CURRENT_MAGIC && pCurrent->m_Version == shm::VERSION;
+				previous = bKnown ? LoadSerial(pCurrent) : 0;
+
+				pCurrent->m_Magic = shm::CURRENT_MAGIC;
+				pCurrent->m_Version = shm::VERSION;
+				std::atomic_ref<uint64_t>(pCurrent->m_Serial).store(serial, std::memory_order_release);
+				munmap(pMapping, sizeof(shm::SharedCurrent));
+			}
+		}
+		close(fd);
+
+		return bSuccess;
+	}
+}
+
+bool CSharedTableWriter::Publish(const std::string& name, const CTextSnapshot& snapshot)
+{
+	const std::vector<CTextSnapshot::Language>& vLanguages = snapshot.GetLanguages();
+
+	// Lay out the segment first, its size has to be known up front
+	std::vector<shm::SharedLanguage> vRecords(vLanguages.size());
+	uint64_t size = Align(sizeof(shm::SharedHeader) + sizeof(shm::SharedLanguage) * vLanguages.size());
+
+	for (size_t i = 0; i < vLanguages.size(); i++)
+	{
+		const CTextTable& table = *vLanguages[i].m_Table;
+		shm::SharedLanguage& record = vRecords[i];
+
+		memset(&record, 0, sizeof(record));
+		strncpy(record.m_Name, vLanguages[i].m_Name.c_str(), sizeof(record.m_Name) - 1);
+		record.m_Count = static_cast<uint32_t>(table.GetSize());
+		record.m_HeapSize = static_cast<uint32_t>(table.GetHeap().size());
+
+		record.m_HashesOffset = size;
+		size = Align(size + table.GetHashes().size() * sizeof(uint32_t));
+		record.m_OffsetsOffset = size;
+		size = Align(size + table.GetOffsets().size() * sizeof(uint32_t));
+		record.m_HeapOffset = size;
+		size = Align(size + table.GetHeap().size());
+	}
+
+	// Readers stay on the published segment until this one is complete
+	const std::string szCurrentName = GetObjectName(name);
+	uint64_t current = 0;
+	if (!ReadSerial(szCurrentName, current))
+	{
+		current = 0;
+	}
+
+	// A segment under the next serial was left by a publisher that died before switching to it
+	const uint64_t serial = current + 1;
+	const std::string szObjectName = GetSegmentName(szCurrentName, serial);
+	shm_unlink(szObjectName.c_str());
+
+	const int fd = shm_open(szObjectName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd < 0)
+	{
+		printf("Error: Could not create shared memory %s: %s\n", szObjectName.c_str(), strerror(errno));
+		return false;
+	}
+
+	if (ftruncate(fd, static_cast<off_t>(size)) != 0)
+	{
+		printf("Error: Could not size shared memory %s: %s\n", szObjectName.c_str(), strerror(errno));
+		close(fd);
+		shm_unlink(szObjectName.c_str());
+		return false;
+	}
+
+	void* pMapping = mmap(nullptr, static_cast<size_t>(size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (pMapping == MAP_FAILED)
+	{
+		printf("Error: Could not map shared memory %s: %s\n", szObjectName.c_str(), strerror(errno));
+		shm_unlink(szObjectName.c_str());
+		return false;
+	}
+
+	char* pSegment = static_cast<char*>(pMapping);
+	for (size_t i = 0; i < vLanguages.size(); i++)
+	{
+		const CTextTable& table = *vLanguages[i].m_Table;
+		const shm::SharedLanguage& record = vRecords[i];
+
+		memcpy(pSegment + record.m_HashesOffset, table.GetHashes().data(), table.GetHashes().size() * sizeof(uint32_t));
+		memcpy(pSegment + record.m_OffsetsOffset, table.GetOffsets().data(), table.GetOffsets().size() * sizeof(uint32_t));
+		memcpy(pSegment + record.m_HeapOffset, table.GetHeap().data(), table.GetHeap().size());
+	}
+	memcpy(pSegment + sizeof(shm::SharedHeader), vRecords.data(), vRecords.size() * sizeof(shm::SharedLanguage));
+
+	shm::SharedHeader* pHeader = reinterpret_cast<shm::SharedHeader*>(pSegment);
+	pHeader->m_Magic = shm::MAGIC;
+	pHeader->m_Version = shm::VERSION;
+	pHeader->m_Generation = snapshot.GetGeneration();
+	pHeader->m_Size = size;
+	pHeader->m_NumLanguages = static_cast<uint32_t>(vLanguages.size());
+	std::atomic_ref<uint32_t>(pHeader->m_Ready).store(1, std::memory_order_release);
+
+	munmap(pMapping, static_cast<size_t>(size));
+
+	uint64_t previous = 0;
+	if (!StoreSerial(szCurrentName, serial, previous))
+	{
+		printf("Error: Could not publish shared memory %s: %s\n", szCurrentName.c_str(), strerror(errno));
+		shm_unlink(szObjectName.c_str());
+		return false;
+	}
+
+	if (previous != 0 && previous != serial)
+	{
+		shm_unlink(GetSegmentName(szCurrentName, previous).c_str());
+	}
+	return true;
+} // bool ::Publish(const string& name, const CTextSnapshot& snapshot)
+
+void CSharedTableWriter::Unlink(const std::string& name)
+{
+	const std::string szCurrentName = GetObjectName(name);
+
+	uint64_t serial = 0;
+	if (ReadSerial(szCurrentName, serial))
+	{
+		shm_unlink(GetSegmentName(szCurrentName, serial).c_str());
+	}
+	shm_unlink(szCurrentName.c_str());
+} // void ::Unlink(const string& name)
+
+//-----------------------------------------------------------------------------------------
+//
+
+CSharedTableReader::CSharedTableReader() :
+	m_Header(nullptr),
+	m_Serial(0),
+	m_Size(0)
+{
+} // ::CSharedTableReader()
+
+CSharedTableReader::~CSharedTableReader()
+{
+	Detach();
+} // ::~CSharedTableReader()
+
+bool CSharedTableReader::Attach(const std::string& name)
+{
+	Detach();
+
+	// The segment read from the current object can be replaced and unlinked before it is opened, the serial is then read again
+	const std::string szCurrentName = GetObjectName(name);
+	uint64_t serial = 0;
+	int fd = -1;
+
+	for (int attempt = 0; attempt < 3 && fd < 0; attempt++)
+	{
+		if (!ReadSerial(szCurrentName, serial))
+		{
+			return false;
+		}
+
+		fd = shm_open(GetSegmentName(szCurrentName, serial).c_str(), O_RDONLY, 0);
+		if (fd < 0 && errno != ENOENT)
+		{
+			return false;
+		}
+	}
+
+	if (fd < 0)
+	{
+		return false;
+	}
+
+	struct stat info = {};
+	if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(shm::SharedHeader))
+	{
+		close(fd);
+		return false;
+	}
+
+	const size_t size = static_cast<size_t>(info.st_size);
+	void* pMapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+
+	if (pMapping == MAP_FAILED)
+	{
+		return false;
+	}
+
+	// A segment that is still being filled, or comes from another layout, is rejected
+	const shm::SharedHeader* pHeader = static_cast<const shm::SharedHeader*>(pMapping);
+	const bool bValid = LoadReady(pHeader) == 1 &&
+		pHeader->m_Magic == shm::MAGIC &&
+		pHeader->m_Version == shm::VERSION &&
+		pHeader->m_Size == size &&
+		sizeof(shm::SharedHeader) + sizeof(shm::SharedLanguage) * static_cast<uint64_t>(pHeader->m_NumLanguages) <= size;
+
+	if (!bValid)
+	{
+		munmap(pMapping, size);
+		return false;
+	}
+
+	m_Header = pHeader;
+	m_Size = size;
+	m_Name = name;
+	m_Serial = serial;
+	return true;
+} // bool ::Attach(const string& name)
+
+void CSharedTableReader::Detach()
+{
+	if (m_Header)
+	{
+		munmap(const_cast<shm::SharedHeader*>(m_Header), m_Size);
+		m_Header = nullptr;
+		m_Serial = 0;
+		m_Size = 0;
+	}
+} // void ::Detach()
+
+bool CSharedTableReader::IsCurrent() const
+{
+	if (!m_Header)
+	{
+		return false;
+	}
+
+	uint64_t serial = 0;
+	return ReadSerial(GetObjectName(m_Name), serial) && serial == m_Serial;
+} // bool ::IsCurrent() const
+
+std::string_view CSharedTableReader::GetLanguageName(size_t index) const
+{
+	const shm::SharedLanguage* pLanguage = GetLanguage(index);
+	return pLanguage ? std::string_view(pLanguage->m_Name, strnlen(pLanguage->m_Name, sizeof(pLanguage->m_Name))) : std::string_view();
+} // string_view ::GetLanguageName(size_t index) const
+
+size_t CSharedTableReader::FindLanguage(std::string_view szName) const
+{
+	for (size_t i = 0; i < GetNumLanguages(); i++)
+	{
+		if (GetLanguageName(i) == szName)
+		{
+			return i;
+		}
+	}
+	return GetNumLanguages();
+} // size_t ::FindLanguage(string_view szName) const
+
+std::string_view CSharedTableReader::Find(size_t language, unsigned int uHash, bool& bFound) const
+{
+	bFound = false;
+
+	const shm::SharedLanguage* pLanguage = GetLanguage(language);
+	if (!pLanguage)
+	{
+		return {};
+	}
+
+	const uint32_t* pHashes = At<uint32_t>(pLanguage->m_HashesOffset);
+	const uint32_t* pHashesEnd = pHashes + pLanguage->m_Count;
+	const uint32_t* it = std::lower_bound(pHashes, pHashesEnd, uHash);
+
+	if (it == pHashesEnd || *it != uHash)
+	{
+		return {};
+	}
+
+	const uint32_t* pOffsets = At<uint32_t>(pLanguage->m_OffsetsOffset);
+	const size_t index = static_cast<size_t>(it - pHashes);
+
+	bFound = true;
+	return std::string_view(At<char>(pLanguage->m_HeapOffset) + pOffsets[index], pOffsets[index + 1] - pOffsets[index]);
+} // string_view ::Find(size_t language, unsigned int uHash, bool& bFound) const
+
+const shm::SharedLanguage* CSharedTableReader::GetLanguage(size_t index) const
+{
+	if (!m_Header || index >= m_Header->m_NumLanguages)
+	{
+		return nullptr;
+	}
+	return At<shm::SharedLanguage>(sizeof(shm::SharedHeader)) + index;
+} // const shm::SharedLanguage* ::GetLanguage(size_t index) const
@@ -0,0 +1,106 @@
+//
+//	gxt/shmtable.h
+//
+
+#ifndef _SHMTABLE_H_
+#define _SHMTABLE_H_
+
+// Project
+#include "snapshot.h"
+
+// C/C++
+#include <string>
+#include <cstdint>
+#include <string_view>
+
+// A table is published as a segment named "<name>.<serial>", the object under
+// the plain name only holds the serial of the current one. A new segment is
+// filled completely before the serial switches to it, the previous one is
+// unlinked after that. Offsets in a segment are relative to its start so every
+// process can map it anywhere. Arrays are 8 byte aligned.
+//
+//   SharedHeader
+//   SharedLanguage[m_NumLanguages]
+//   per language: u32 hashes[count], u32 offsets[count + 1], heap
+namespace shm
+{
+	static constexpr uint32_t MAGIC = 0x4D535847; // 'GXSM'
+	static constexpr uint32_t CURRENT_MAGIC = 0x43535847; // 'GXSC'
+	static constexpr uint32_t VERSION = 2;
+
+	struct SharedCurrent
+	{
+		uint32_t m_Magic;
+		uint32_t m_Version;
+		uint64_t m_Serial; // of the segment to attach to, stored last
+	};
+
+	struct SharedHeader
+	{
+		uint32_t m_Magic;
+		uint32_t m_Version;
+		uint64_t m_Generation;
+		uint64_t m_Size;
+		uint32_t m_NumLanguages;
+		uint32_t m_Ready; // written last, readers ignore segments without it
+	};
+
+	struct SharedLanguage
+	{
+		char m_Name[64];
+		uint32_t m_Count;
+		uint32_t m_HeapSize;
+		uint64_t m_HashesOffset;
+		uint64_t m_OffsetsOffset;
+		uint64_t m_HeapOffset;
+	};
+}
+
+// Copies a snapshot into a new POSIX shared memory object and switches the
+// name over to it. The segment it replaces stays readable until then and is
+// unlinked after, processes attached to it keep their mapping until they
+// attach again.
+class CSharedTableWriter
+{
+public:
+	static bool Publish(const std::string& name, const CTextSnapshot& snapshot);
+	static void Unlink(const std::string& name);
+};
+
+// Read-only view of a published segment, lookups run directly on the
+// shared pages without parsing or copying anything.
+class CSharedTableReader
+{
+public:
+	CSharedTableReader();
+	~CSharedTableReader();
+
+	CSharedTableReader(const CSharedTableReader&) = delete;
+	CSharedTableReader& operator=(const CSharedTableReader&) = delete;
+
+	bool Attach(const std::string& name);
+	void Detach();
+	bool IsAttached() const { return m_Header != nullptr; }
+
+	// False once the publisher replaced the segment, Attach() again to switch
+	bool IsCurrent() const;
+
+	uint64_t GetGeneration() const { return m_Header->m_Generation; }
+	size_t GetNumLanguages() const { return m_Header->m_NumLanguages; }
+	std::string_view GetLanguageName(size_t index) const;
+	// GetNumLanguages() if there is no such language
+	size_t FindLanguage(std::string_view szName) const;
+
+	std::string_view Find(size_t language, unsigned int uHash, bool& bFound) const;
+private:
+	const shm::SharedLanguage* GetLanguage(size_t index) const;
+	template<typename T>
+	const T* At(uint64_t offset) const { return reinterpret_cast<const T*>(reinterpret_cast<const char*>(m_Header) + offset); }
+private:
+	const shm::SharedHeader* m_Header;
+	std::string m_Name;
+	uint64_t m_Serial;
+	size_t m_Size;
+};
+
+#endif // !_SHMTABLE_H_
@@ -0,0 +1,55 @@
+//
+//	gxt/snapshot.cpp
+//
+
+// Project
+#include "snapshot.h"
+
+// C/C++
+#include <algorithm>
+
+CTextTable::CTextTable(const CFile::Map& entries)
+{
+	size_t heapSize = 0;
+	for (const auto& [uHash, szText] : entries)
+	{
+		heapSize += szText.size();
+	}
+
+	m_Hashes.reserve(entries.size());
+	m_Offsets.reserve(entries.size() + 1);
+	m_Heap.reserve(heapSize);
+
+	// The map is ordered, so the hashes come out sorted
+	for (const auto& [uHash, szText] : entries)
+	{
+		m_Hashes.push_back(uHash);
+		m_Offsets.push_back(static_cast<unsigned int>(m_Heap.size()));
+		m_Heap += szText;
+	}
+	m_Offsets.push_back(static_cast<unsigned int>(m_Heap.size()));
+} // ::CTextTable(const CFile::Map& entries)
+
+std::string_view CTextTable::Find(unsigned int uHash, bool& bFound) const
+{
+	const auto it = std::lower_bound(m_Hashes.begin(), m_Hashes.end(), uHash);
+
+	bFound = (it != m_Hashes.end() && *it == uHash);
+	if (!bFound)
+	{
+		return {};
+	}
+
+	const size_t index = static_cast<size_t>(it - m_Hashes.begin());
+	return std::string_view(m_Heap).substr(m_Offsets[index], m_Offsets[index + 1] - m_Offsets[index]);
+} // string_view ::Find(unsigned int uHash, bool& bFound) const
+
+//-----------------------------------------------------------------------------------------
+//
+
+CTextSnapshot::CTextSnapshot(std::vector<Language>&& vLanguages, SharedTable pLabels, unsigned long long uGeneration) :
+	m_Languages(std::move(vLanguages)),
+	m_Labels(std::move(pLabels)),
+	m_Generation(uGeneration)
+{
+} // ::CTextSnapshot(vector<Language>&& vLanguages, SharedTable pLabels, unsigned long long uGeneration)
@@ -0,0 +1,66 @@
+//
+//	gxt/snapshot.h
+//
+
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+// Project
+#include "gxt2.h"
+
+// C/C++
+#include <memory>
+#include <string>
+#include <vector>
+#include <string_view>
+
+// Flattened, immutable copy of one table. Hashes and offsets sit in two
+// arrays next to one string heap, so a lookup is a binary search over
+// contiguous memory instead of a walk through map nodes.
+class CTextTable
+{
+public:
+	explicit CTextTable(const CFile::Map& entries);
+
+	// Empty view with bFound = false if the hash is not in the table
+	std::string_view Find(unsigned int uHash, bool& bFound) const;
+	size_t GetSize() const { return m_Hashes.size(); }
+
+	// Raw arrays, the text of entry i is m_Heap[m_Offsets[i], m_Offsets[i + 1])
+	const std::vector<unsigned int>& GetHashes() const { return m_Hashes; }
+	const std::vector<unsigned int>& GetOffsets() const { return m_Offsets; }
+	const std::string& GetHeap() const { return m_Heap; }
+private:
+	std::vector<unsigned int> m_Hashes;
+	std::vector<unsigned int> m_Offsets;
+	std::string m_Heap;
+};
+
+using SharedTable = std::shared_ptr<const CTextTable>;
+
+// Everything a reader needs for one batch, published as a whole and never
+// modified afterwards. Unchanged tables are shared between generations.
+class CTextSnapshot
+{
+public:
+	struct Language
+	{
+		std::string m_Name;
+		SharedTable m_Table;
+	};
+public:
+	CTextSnapshot(std::vector<Language>&& vLanguages, SharedTable pLabels, unsigned long long uGeneration);
+
+	const std::vector<Language>& GetLanguages() const { return m_Languages; }
+	const CTextTable* GetTable(size_t index) const { return index < m_Languages.size() ? m_Languages[index].m_Table.get() : nullptr; }
+	const SharedTable& GetLabels() const { return m_Labels; }
+	unsigned long long GetGeneration() const { return m_Generation; }
+private:
+	std::vector<Language> m_Languages;
+	SharedTable m_Labels;
+	unsigned long long m_Generation;
+};
+
+using SharedSnapshot = std::shared_ptr<const CTextSnapshot>;
+
+#endif // !_SNAPSHOT_H_
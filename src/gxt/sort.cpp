@@ -0,0 +1,290 @@
+//
+//	gxt/sort.cpp
+//
+
+// Project
+#include "sort.h"
+#include "main/main.h"
+
+// C/C++
+#include <queue>
+#include <format>
+#include <algorithm>
+#include <filesystem>
+
+bool CExternalSorter::Run::Open(const std::string& path)
+{
+	// Larger read buffer per run, the merge touches every run round robin
+	m_Buffer.resize(64 * 1024);
+	m_File.rdbuf()->pubsetbuf(m_Buffer.data(), static_cast<std::streamsize>(m_Buffer.size()));
+	m_File.open(path, std::ios::in | std::ios::binary);
+
+	std::error_code ec;
+	m_Path = path;
+	m_Remaining = std::filesystem::file_size(path, ec);
+	if (!m_File.is_open() || ec)
+	{
+		throw std::runtime_error(std::format("The temporary file {} could not be opened.", path));
+	}
+	return Next();
+} // bool ::Run::Open(const string& path)
+
+bool CExternalSorter::Run::Next()
+{
+	// The run ends at a record boundary, anything cut short is a damaged spill file
+	if (m_Remaining == 0)
+	{
+		return false;
+	}
+
+	unsigned int uLength = 0;
+	if (m_Remaining < sizeof(m_Hash) + sizeof(uLength))
+	{
+		throw std::runtime_error(std::format("The temporary file {} is damaged.", m_Path));
+	}
+
+	m_File.read(reinterpret_cast<char*>(&m_Hash), sizeof(m_Hash));
+	m_File.read(reinterpret_cast<char*>(&uLength), sizeof(uLength));
+	m_Remaining -= sizeof(m_Hash) + sizeof(uLength);
+
+	// The length is not trusted with the allocation, the text has to fit in what is left of the file
+	if (!m_File || uLength > m_Remaining)
+	{
+		throw std::runtime_error(std::format("The temporary file {} is damaged.", m_Path));
+	}
+
+	m_Text.resize(uLength);
+	m_File.read(m_Text.data(), uLength);
+	m_Remaining -= uLength;
+
+	if (!m_File)
+	{
+		throw std::runtime_error(std::format("The temporary file {} is damaged.", m_Path));
+	}
+	return true;
+} // bool ::Run::Next()
+
+//-----------------------------------------------------------------------------------------
+//
+
+CExternalSorter::CExternalSorter(const std::string& filePath, size_t memoryBudget /*= DEFAULT_MEMORY_BUDGET*/) :
+	m_Input(nullptr),
+	m_Output(nullptr),
+	m_MemoryBudget(memoryBudget)
+{
+	CreateInputInterface(filePath);
+	CreateOutputInterface(filePath);
+} // ::CExternalSorter(const string& filePath, size_t memoryBudget = DEFAULT_MEMORY_BUDGET)
+
+CExternalSorter::~CExternalSorter()
+{
+	Reset();
+} // ::~CExternalSorter()
+
+void CExternalSorter::Reset()
+{
+	if (m_Input)
+	{
+		delete m_Input;
+		m_Input = nullptr;
+	}
+	if (m_Output)
+	{
+		delete m_Output;
+		m_Output = nullptr;
+	}
+	RemoveRuns();
+} // void ::Reset()
+
+void CExternalSorter::Sort()
+{
+	CFile::Vec vRun;
+	size_t uRunSize = 0;
+
+	unsigned int uHash = 0;
+	std::string szText;
+
+	// Phase 1: cut the unsorted input into sorted runs that fit the budget
+	while (GetInput()->ReadEntry(uHash, szText))
+	{
+		uRunSize += sizeof(CFile::Vec::value_type) + szText.capacity();
+		vRun.emplace_back(uHash, std::move(szText));
+
+		if (uRunSize >= m_MemoryBudget)
+		{
+			SpillRun(vRun);
+			uRunSize = 0;
+		}
+	}
+
+	// Everything fit into a single run, no need to go through the disk
+	if (m_Runs.empty())
+	{
+		SortRun(vRun);
+		for (const auto& [uEntryHash, szEntryText] : vRun)
+		{
+			if (!GetOutput()->AddEntry(uEntryHash, szEntryText))
+			{
+				throw std::runtime_error("Failed to save content.");
+			}
+		}
+	}
+	else
+	{
+		if (!vRun.empty())
+		{
+			SpillRun(vRun);
+		}
+		CFile::Vec().swap(vRun);
+
+		// Phase 2: k-way merge of all runs into the output
+		MergeRuns();
+	}
+
+	if (!GetOutput()->Finish())
+	{
+		throw std::runtime_error("Failed to save content.");
+	}
+	RemoveRuns();
+} // void ::Sort()
+
+void CExternalSorter::SortRun(CFile::Vec& vRun)
+{
+	std::stable_sort(vRun.begin(), vRun.end(), [](const auto& a, const auto& b) -> bool
+	{
+		return a.first < b.first;
+	});
+
+	// Keep the last occurrence of a hash, same as assigning into CFile::Map
+	auto itOut = vRun.begin();
+	for (auto it = vRun.begin(); it != vRun.end(); ++it)
+	{
+		if (std::next(it) != vRun.end() && std::next(it)->first == it->first)
+		{
+			continue;
+		}
+		if (itOut != it)
+		{
+			*itOut = std::move(*it);
+		}
+		++itOut;
+	}
+	vRun.erase(itOut, vRun.end());
+} // void ::SortRun(Vec& vRun)
+
+void CExternalSorter::SpillRun(CFile::Vec& vRun)
+{
+	SortRun(vRun);
+
+	const std::string runPath = std::format("{}.run{}.tmp", m_OutputPath, m_Runs.size());
+	std::ofstream runFile(runPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!runFile.is_open())
+	{
+		throw std::runtime_error(std::format("The temporary file {} could not be created.", runPath));
+	}
+	m_Runs.push_back(runPath);
+
+	for (const auto& [uHash, szText] : vRun)
+	{
+		const unsigned int uLength = static_cast<unsigned int>(szText.size());
+
+		runFile.write(reinterpret_cast<const char*>(&uHash), sizeof(uHash));
+		runFile.write(reinterpret_cast<const char*>(&uLength), sizeof(uLength));
+		runFile.write(szText.data(), uLength);
+	}
+
+	// Closing flushes the buffer, a short write shows up here and not in the merge
+	runFile.close();
+	if (!runFile.good())
+	{
+		throw std::runtime_error(std::format("Failed to write temporary file {}.", runPath));
+	}
+	vRun.clear();
+} // void ::SpillRun(Vec& vRun)
+
+void CExternalSorter::MergeRuns()
+{
+	std::vector<Run> vRuns(m_Runs.size());
+
+	// (hash, run index), smallest hash first and ties in input order
+	using Head = std::pair<unsigned int, size_t>;
+	std::priority_queue<Head, std::vector<Head>, std::greater<Head>> qHeads;
+
+	for (size_t i = 0; i < vRuns.size(); i++)
+	{
+		if (vRuns[i].Open(m_Runs[i]))
+		{
+			qHeads.emplace(vRuns[i].m_Hash, i);
+		}
+	}
+
+	std::vector<size_t> vPopped;
+	while (!qHeads.empty())
+	{
+		const unsigned int uHash = qHeads.top().first;
+
+		vPopped.clear();
+		while (!qHeads.empty() && qHeads.top().first == uHash)
+		{
+			vPopped.push_back(qHeads.top().second);
+			qHeads.pop();
+		}
+
+		// Later runs hold later input, they win on duplicate hashes
+		if (!GetOutput()->AddEntry(uHash, vRuns[vPopped.back()].m_Text))
+		{
+			throw std::runtime_error("Failed to save content.");
+		}
+
+		for (const size_t uRun : vPopped)
+		{
+			if (vRuns[uRun].Next())
+			{
+				qHeads.emplace(vRuns[uRun].m_Hash, uRun);
+			}
+		}
+	}
+} // void ::MergeRuns()
+
+void CExternalSorter::RemoveRuns()
+{
+	std::error_code ec;
+	for (const std::string& runPath : m_Runs)
+	{
+		std::filesystem::remove(runPath, ec);
+	}
+	m_Runs.clear();
+} // void ::RemoveRuns()
+
+void CExternalSorter::CreateInputInterface(const std::string& filePath)
+{
+	const std::string szFileExtension = filePath.substr(filePath.find_last_of("."));
+
+	if (szFileExtension == ".txt")
+	{
+		m_Input = GXT_NEW CTextFile(filePath, CFile::FLAGS_READ_DECOMPILED);
+	}
+	else if (szFileExtension == ".json")
+	{
+		m_Input = GXT_NEW CJsonFile(filePath, CFile::FLAGS_READ_DECOMPILED);
+	}
+	else if (szFileExtension == ".csv")
+	{
+		m_Input = GXT_NEW CCsvFile(filePath, CFile::FLAGS_READ_DECOMPILED);
+	}
+	else if (szFileExtension == ".oxt")
+	{
+		m_Input = GXT_NEW COxtFile(filePath, CFile::FLAGS_READ_DECOMPILED);
+	}
+	else
+	{
+		throw std::invalid_argument("Unknown input file format.");
+	}
+} // void ::CreateInputInterface(const string& filePath)
+
+void CExternalSorter::CreateOutputInterface(const std::string& filePath)
+{
+	m_OutputPath = filePath.substr(0, filePath.find_last_of(".")) + ".gxt2";
+	m_Output = GXT_NEW CGxt2Writer(m_OutputPath);
+} // void ::CreateOutputInterface(const string& filePath)
@@ -0,0 +1,62 @@
+//
+//	gxt/sort.h
+//
+
+#ifndef _SORT_H_
+#define _SORT_H_
+
+// Project
+#include "gxt2.h"
+
+// C/C++
+#include <vector>
+
+class CExternalSorter
+{
+private:
+	struct Run
+	{
+		std::ifstream m_File;
+		std::string m_Path;
+		uint64_t m_Remaining;		// Bytes of the file not read yet
+		std::vector<char> m_Buffer;
+		unsigned int m_Hash;
+		std::string m_Text;
+
+		// Both return false at the end of the run and throw on a damaged file
+		bool Open(const std::string& path);
+		bool Next();
+	};
+public:
+	static constexpr size_t DEFAULT_MEMORY_BUDGET = 256ull << 20;
+
+	explicit CExternalSorter(const std::string& filePath, size_t memoryBudget = DEFAULT_MEMORY_BUDGET);
+	virtual ~CExternalSorter();
+
+	void Reset();
+	void Sort();
+
+	CFile* GetInput() { return m_Input; }
+	const CFile* GetInput() const { return m_Input; }
+
+	CGxt2Writer* GetOutput() { return m_Output; }
+	const CGxt2Writer* GetOutput() const { return m_Output; }
+
+	size_t GetNumRuns() const { return m_Runs.size(); }
+private:
+	void CreateInputInterface(const std::string& filePath);
+	void CreateOutputInterface(const std::string& filePath);
+
+	static void SortRun(CFile::Vec& vRun);
+	void SpillRun(CFile::Vec& vRun);
+	void MergeRuns();
+	void RemoveRuns();
+private:
+	CFile* m_Input;
+	CGxt2Writer* m_Output;
+	std::string m_OutputPath;
+	std::vector<std::string> m_Runs;
+	size_t m_MemoryBudget;
+};
+
+#endif // !_SORT_H_
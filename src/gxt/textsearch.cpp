@@ -0,0 +1,811 @@
+//
+//	gxt/textsearch.cpp
+//
+
+// Project
+#include "textsearch.h"
+
+// C/C++
+#include <bit>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TEXT_SEARCH_SIMD 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// Same folding as tolower in the C locale, bytes of multibyte characters pass through
+	char FoldChar(char c)
+	{
+		return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+	}
+
+	// Fuzzy scores, close to the ones fzf starts from
+	constexpr int SCORE_MATCH = 16;
+	constexpr int BONUS_BOUNDARY = 8;		// First byte of a word
+	constexpr int BONUS_CONSECUTIVE = 4;	// Right after the byte matched before
+	constexpr int BONUS_FIRST = 2;			// Multiplies the bonus of the first byte of the query
+	constexpr int PENALTY_GAP_START = 3;
+	constexpr int PENALTY_GAP_EXTEND = 1;
+	constexpr size_t MAX_GAP_EXTEND = 16;
+
+	// After a byte that is no ASCII letter or digit, bytes of multibyte characters count as letters
+	bool IsWordStart(std::string_view szValue, size_t i)
+	{
+		if (i == 0)
+		{
+			return true;
+		}
+		const unsigned char c = static_cast<unsigned char>(szValue[i - 1]);
+		return c < 0x80 && !((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'));
+	}
+}
+
+CTextSearch::CTextSearch() :
+	m_BlockSize(0),
+	m_BlockCapacity(0),
+	m_ArenaSize(0),
+	m_NumDeadBytes(0),
+	m_NumIndexedSlots(0),
+	m_UseIndex(false),
+	m_Fuzzy(false),
+	m_Generation(0),
+	m_Running(false),
+	m_Stop(false)
+{
+} // ::CTextSearch()
+
+CTextSearch::~CTextSearch()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+		m_Generation++;
+	}
+	m_Wake.notify_one();
+
+	if (m_Worker.joinable())
+	{
+		m_Worker.join();
+	}
+} // ::~CTextSearch()
+
+void CTextSearch::SetRow(size_t row, std::string_view szText, std::string_view szName)
+{
+	// Folded before the lock is taken, the worker only waits for the copy
+	std::string szFolded;
+	szFolded.reserve(szText.size() + szName.size() + 1);
+	Fold(szText, szFolded);
+	szFolded.push_back('\0');
+	Fold(szName, szFolded);
+
+	bool bIndex = false;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		const size_t slot = m_Slots.size();
+		if (row < m_Rows.size())
+		{
+			m_NumDeadBytes += m_Slots[m_Rows[row]].m_Length;
+			m_SlotRows[m_Rows[row]] = NO_ROW;
+			m_Rows[row] = slot;
+		}
+		else
+		{
+			m_Rows.push_back(slot);
+		}
+		m_Slots.push_back({ Store(szFolded), szFolded.size() });
+		m_SlotRows.push_back(row);
+
+		// Every edit leaves its old copy behind, they are dropped once they make up half the arena
+		if (m_NumDeadBytes > m_ArenaSize / 2 && m_NumDeadBytes > 64 * 1024)
+		{
+			Compact();
+		}
+		bIndex = m_UseIndex;
+	}
+
+	if (bIndex)
+	{
+		m_Wake.notify_one();
+	}
+} // void ::SetRow(size_t row, string_view szText, string_view szName)
+
+void CTextSearch::AppendRows(const std::vector<std::string_view>& vTexts, const std::vector<std::string_view>& vNames)
+{
+	const size_t numRows = std::min(vTexts.size(), vNames.size());
+	const size_t numSlices = (numRows + APPEND_SLICE_SIZE - 1) / APPEND_SLICE_SIZE;
+
+	// Folding keeps the length, every copy is its text, a NUL and its name
+	std::vector<std::string> vFolded(numSlices);
+	RunParallel(numSlices, 0, [&vTexts, &vNames, &vFolded, numRows](size_t slice)
+	{
+		const size_t end = std::min(numRows, (slice + 1) * APPEND_SLICE_SIZE);
+		std::string& szFolded = vFolded[slice];
+		for (size_t i = slice * APPEND_SLICE_SIZE; i < end; i++)
+		{
+			Fold(vTexts[i], szFolded);
+			szFolded.push_back('\0');
+			Fold(vNames[i], szFolded);
+		}
+	});
+
+	bool bIndex = false;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Rows.reserve(m_Rows.size() + numRows);
+		m_Slots.reserve(m_Slots.size() + numRows);
+		m_SlotRows.reserve(m_SlotRows.size() + numRows);
+
+		size_t offset = 0;
+		for (size_t i = 0; i < numRows; i++)
+		{
+			if (i % APPEND_SLICE_SIZE == 0)
+			{
+				offset = 0;
+			}
+
+			const size_t length = vTexts[i].size() + 1 + vNames[i].size();
+			m_SlotRows.push_back(m_Rows.size());
+			m_Rows.push_back(m_Slots.size());
+			m_Slots.push_back({ Store(std::string_view(vFolded[i / APPEND_SLICE_SIZE]).substr(offset, length)), length });
+			offset += length;
+		}
+		bIndex = m_UseIndex;
+	}
+
+	if (bIndex)
+	{
+		m_Wake.notify_one();
+	}
+} // void ::AppendRows(const vector<string_view>& vTexts, const vector<string_view>& vNames)
+
+void CTextSearch::RemoveRow(size_t row)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (row >= m_Rows.size())
+	{
+		return;
+	}
+
+	// A running search and results not taken yet both still have the old row numbers
+	m_Generation++;
+	m_Running = false;
+	m_Results.clear();
+
+	m_NumDeadBytes += m_Slots[m_Rows[row]].m_Length;
+	m_SlotRows[m_Rows[row]] = NO_ROW;
+	if (row + 1 != m_Rows.size())
+	{
+		m_Rows[row] = m_Rows.back();
+		m_SlotRows[m_Rows[row]] = row;
+	}
+	m_Rows.pop_back();
+} // void ::RemoveRow(size_t row)
+
+void CTextSearch::Clear()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Generation++;
+	m_Running = false;
+	m_Results.clear();
+
+	m_Blocks.clear();
+	m_BlockSize = 0;
+	m_BlockCapacity = 0;
+	m_ArenaSize = 0;
+	m_Slots.clear();
+	m_SlotRows.clear();
+	m_Rows.clear();
+	m_NumDeadBytes = 0;
+
+	m_Postings.clear();
+	m_NumIndexedSlots = 0;
+} // void ::Clear()
+
+size_t CTextSearch::GetNumRows() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Rows.size();
+} // size_t ::GetNumRows() const
+
+void CTextSearch::EnableIndex(bool bEnable)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_UseIndex = bEnable;
+		if (!bEnable)
+		{
+			m_Postings.clear();
+			m_NumIndexedSlots = 0;
+		}
+		else if (!m_Worker.joinable())
+		{
+			m_Worker = std::thread(&CTextSearch::Run, this);
+		}
+	}
+	m_Wake.notify_one();
+} // void ::EnableIndex(bool bEnable)
+
+void CTextSearch::UpdateIndex()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_UseIndex)
+	{
+		IndexSlots(m_Slots.size());
+	}
+} // void ::UpdateIndex()
+
+void CTextSearch::Start(std::string_view szQuery, std::vector<size_t> vOrder, bool bFuzzy /*= false*/)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		if (!m_Worker.joinable())
+		{
+			m_Worker = std::thread(&CTextSearch::Run, this);
+		}
+
+		m_Query.clear();
+		Fold(szQuery, m_Query);
+		m_Fuzzy = bFuzzy;
+		m_Order = std::move(vOrder);
+		m_Results.clear();
+		m_Generation++;
+		m_Running = true;
+	}
+	m_Wake.notify_one();
+} // void ::Start(string_view szQuery, vector<size_t> vOrder, bool bFuzzy)
+
+void CTextSearch::Cancel()
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	m_Generation++;
+	m_Running = false;
+	m_Results.clear();
+} // void ::Cancel()
+
+bool CTextSearch::TakeResults(std::vector<size_t>& vRows)
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	if (m_Results.empty())
+	{
+		return false;
+	}
+
+	vRows.insert(vRows.end(), m_Results.begin(), m_Results.end());
+	m_Results.clear();
+	return true;
+} // bool ::TakeResults(vector<size_t>& vRows)
+
+bool CTextSearch::Matches(size_t row, std::string_view szQuery) const
+{
+	std::string szFolded;
+	Fold(szQuery, szFolded);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return row < m_Rows.size() && Contains(GetRow(row), szFolded);
+} // bool ::Matches(size_t row, string_view szQuery) const
+
+void CTextSearch::Find(std::string_view szQuery, std::vector<size_t>& vRows) const
+{
+	std::string szFolded;
+	Fold(szQuery, szFolded);
+
+	// Only the copies are taken under the lock, they are compared after it is released
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	const Blocks vBlocks = m_Blocks;
+	if (CanUseIndex(szFolded))
+	{
+		std::vector<Candidate> vCandidates;
+		FindCandidates(szFolded, vCandidates);
+		std::vector<unsigned char> vMatches(m_Rows.size(), 0);
+		lock.unlock();
+
+		MatchCandidates(vCandidates, szFolded, vMatches);
+		for (size_t row = 0; row < vMatches.size(); row++)
+		{
+			if (vMatches[row])
+			{
+				vRows.push_back(row);
+			}
+		}
+		return;
+	}
+
+	std::vector<std::string_view> vCopies(m_Rows.size());
+	for (size_t row = 0; row < m_Rows.size(); row++)
+	{
+		vCopies[row] = GetRow(row);
+	}
+	lock.unlock();
+
+	for (size_t row = 0; row < vCopies.size(); row++)
+	{
+		if (Contains(vCopies[row], szFolded))
+		{
+			vRows.push_back(row);
+		}
+	}
+} // void ::Find(string_view szQuery, vector<size_t>& vRows) const
+
+bool CTextSearch::MatchFuzzy(size_t row, std::string_view szQuery, std::vector<size_t>& vPositions, bool& bInName) const
+{
+	std::string szFolded;
+	Fold(szQuery, szFolded);
+
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return row < m_Rows.size() && ScoreFuzzyRow(GetRow(row), szFolded, &vPositions, &bInName) != NO_MATCH;
+} // bool ::MatchFuzzy(size_t row, string_view szQuery, vector<size_t>& vPositions, bool& bInName) const
+
+bool CTextSearch::Contains(std::string_view szHaystack, std::string_view szNeedle)
+{
+	const size_t length = szNeedle.size();
+	if (length < 2 || length > szHaystack.size())
+	{
+		return szHaystack.find(szNeedle) != std::string_view::npos;
+	}
+
+#if TEXT_SEARCH_SIMD
+	// Candidates have the first and the last byte of the needle in place, 16 starts at a time
+	const __m128i first = _mm_set1_epi8(szNeedle.front());
+	const __m128i last = _mm_set1_epi8(szNeedle.back());
+	const char* pData = szHaystack.data();
+
+	size_t i = 0;
+	for (; i + length - 1 + 16 <= szHaystack.size(); i += 16)
+	{
+		const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i));
+		const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pData + i + length - 1));
+		unsigned int mask = static_cast<unsigned int>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+
+		while (mask)
+		{
+			const unsigned int bit = static_cast<unsigned int>(std::countr_zero(mask));
+			if (memcmp(pData + i + bit + 1, szNeedle.data() + 1, length - 2) == 0)
+			{
+				return true;
+			}
+			mask &= mask - 1;
+		}
+	}
+
+	// Starts too close to the end for a whole block
+	return szHaystack.substr(i).find(szNeedle) != std::string_view::npos;
+#else
+	return szHaystack.find(szNeedle) != std::string_view::npos;
+#endif
+} // bool ::Contains(string_view szHaystack, string_view szNeedle)
+
+void CTextSearch::Fold(std::string_view szValue, std::string& szFolded)
+{
+	const size_t start = szFolded.size();
+	szFolded.resize(start + szValue.size());
+	std::transform(szValue.begin(), szValue.end(), szFolded.begin() + static_cast<ptrdiff_t>(start), FoldChar);
+} // void ::Fold(string_view szValue, string& szFolded)
+
+int CTextSearch::ScoreFuzzy(std::string_view szValue, std::string_view szQuery, std::vector<size_t>* pPositions /*= nullptr*/)
+{
+	if (szQuery.empty() || szQuery.size() > szValue.size())
+	{
+		return NO_MATCH;
+	}
+
+	// Earliest end of the query as a subsequence
+	size_t q = 0;
+	size_t end = 0;
+	for (size_t i = 0; i < szValue.size(); i++)
+	{
+		if (szValue[i] == szQuery[q] && ++q == szQuery.size())
+		{
+			end = i + 1;
+			break;
+		}
+	}
+	if (q < szQuery.size())
+	{
+		return NO_MATCH;
+	}
+
+	// Walking back from the end gives the latest start, the tightest match ending there
+	size_t start = end;
+	while (q > 0)
+	{
+		if (szValue[--start] == szQuery[q - 1])
+		{
+			q--;
+		}
+	}
+
+	int score = 0;
+	size_t previous = NO_ROW;
+	for (size_t i = start; i < end && q < szQuery.size(); i++)
+	{
+		if (szValue[i] != szQuery[q])
+		{
+			continue;
+		}
+
+		int points = SCORE_MATCH;
+		if (IsWordStart(szValue, i))
+		{
+			points += (q == 0) ? BONUS_BOUNDARY * BONUS_FIRST : BONUS_BOUNDARY;
+		}
+		if (previous != NO_ROW)
+		{
+			const size_t gap = i - previous - 1;
+			if (gap == 0)
+			{
+				points += BONUS_CONSECUTIVE;
+			}
+			else
+			{
+				points -= PENALTY_GAP_START + PENALTY_GAP_EXTEND * static_cast<int>(std::min(gap - 1, MAX_GAP_EXTEND));
+			}
+		}
+
+		score += points;
+		previous = i;
+		q++;
+		if (pPositions)
+		{
+			pPositions->push_back(i);
+		}
+	}
+	return score;
+} // int ::ScoreFuzzy(string_view szValue, string_view szQuery, vector<size_t>* pPositions)
+
+int CTextSearch::ScoreFuzzyRow(std::string_view szCopy, std::string_view szQuery, std::vector<size_t>* pPositions, bool* pInName)
+{
+	// Text and name are scored on their own, the better one counts
+	const size_t split = szCopy.find('\0');
+	const std::string_view szText = szCopy.substr(0, split);
+	const std::string_view szName = (split != std::string_view::npos) ? szCopy.substr(split + 1) : std::string_view();
+
+	const int textScore = ScoreFuzzy(szText, szQuery);
+	const int nameScore = ScoreFuzzy(szName, szQuery);
+	const bool bName = nameScore > textScore;
+
+	if (pPositions && (bName ? nameScore : textScore) != NO_MATCH)
+	{
+		pPositions->clear();
+		ScoreFuzzy(bName ? szName : szText, szQuery, pPositions);
+	}
+	if (pInName)
+	{
+		*pInName = bName;
+	}
+	return bName ? nameScore : textScore;
+} // int ::ScoreFuzzyRow(string_view szCopy, string_view szQuery, vector<size_t>* pPositions, bool* pInName)
+
+void CTextSearch::Run()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	unsigned int seen = 0;
+	std::vector<unsigned char> vMatches;
+	std::vector<Candidate> vCandidates;
+	std::vector<size_t> vFound;
+
+	while (true)
+	{
+		m_Wake.wait(lock, [this, &seen]() { return m_Stop || (m_Running && m_Generation != seen) || (m_UseIndex && m_NumIndexedSlots < m_Slots.size()); });
+		if (m_Stop)
+		{
+			return;
+		}
+
+		// Nothing to search, the index grows a chunk at a time
+		if (!m_Running || m_Generation == seen)
+		{
+			IndexSlots(INDEX_CHUNK_SIZE);
+			lock.unlock();
+			std::this_thread::yield();
+			lock.lock();
+			continue;
+		}
+
+		const unsigned int generation = m_Generation;
+		const std::string szQuery = m_Query;
+		const std::vector<size_t> vOrder = std::move(m_Order);
+		seen = generation;
+
+		if (m_Fuzzy)
+		{
+			RankFuzzy(lock, generation, szQuery, vOrder);
+			continue;
+		}
+
+		// The index finds every match up front, only handing them out in order is left. The candidates
+		// are compared without the lock, an edit in the meantime is picked up by the next search.
+		const bool bIndexed = CanUseIndex(szQuery);
+		if (bIndexed)
+		{
+			const Blocks vBlocks = m_Blocks;
+			vCandidates.clear();
+			FindCandidates(szQuery, vCandidates);
+			vMatches.assign(m_Rows.size(), 0);
+
+			lock.unlock();
+			MatchCandidates(vCandidates, szQuery, vMatches);
+			lock.lock();
+		}
+
+		// Only the copies of a chunk are taken under the lock, the matches are handed out
+		// once it is taken again and the search is still the latest
+		for (size_t first = 0; first < vOrder.size(); first += CHUNK_SIZE)
+		{
+			const size_t last = std::min(first + CHUNK_SIZE, vOrder.size());
+			Blocks vBlocks;
+			vCandidates.clear();
+			if (!bIndexed)
+			{
+				vBlocks = m_Blocks;
+				for (size_t i = first; i < last; i++)
+				{
+					if (vOrder[i] < m_Rows.size())
+					{
+						vCandidates.push_back({ vOrder[i], GetRow(vOrder[i]), false });
+					}
+				}
+			}
+			lock.unlock();
+
+			vFound.clear();
+			if (bIndexed)
+			{
+				for (size_t i = first; i < last; i++)
+				{
+					if (vOrder[i] < vMatches.size() && vMatches[vOrder[i]])
+					{
+						vFound.push_back(vOrder[i]);
+					}
+				}
+			}
+			else
+			{
+				for (const Candidate& candidate : vCandidates)
+				{
+					if (Contains(candidate.m_Copy, szQuery))
+					{
+						vFound.push_back(candidate.m_Row);
+					}
+				}
+			}
+
+			lock.lock();
+			if (m_Generation != generation)
+			{
+				break;
+			}
+			m_Results.insert(m_Results.end(), vFound.begin(), vFound.end());
+		}
+
+		if (m_Generation == generation)
+		{
+			m_Running = false;
+		}
+	}
+} // void ::Run()
+
+void CTextSearch::RankFuzzy(std::unique_lock<std::mutex>& lock, unsigned int generation, std::string_view szQuery, const std::vector<size_t>& vOrder)
+{
+	// The copies of a chunk are taken under the lock and scored on the pool without it,
+	// every slice keeps its own best and the chunk merges them
+	std::vector<Ranked> vBest;
+	std::vector<std::string_view> vCopies;
+	for (size_t first = 0; first < vOrder.size(); first += FUZZY_CHUNK_SIZE)
+	{
+		const size_t last = std::min(first + FUZZY_CHUNK_SIZE, vOrder.size());
+		const Blocks vBlocks = m_Blocks;
+
+		// A row that is gone has no copy, an empty one never matches
+		vCopies.assign(last - first, std::string_view());
+		for (size_t i = first; i < last; i++)
+		{
+			if (vOrder[i] < m_Rows.size())
+			{
+				vCopies[i - first] = GetRow(vOrder[i]);
+			}
+		}
+		lock.unlock();
+
+		std::vector<std::vector<Ranked>> vSliceBest((vCopies.size() + FUZZY_SLICE_SIZE - 1) / FUZZY_SLICE_SIZE);
+		m_Pool.Run(vSliceBest.size(), [first, szQuery, &vCopies, &vSliceBest](size_t index)
+		{
+			const size_t sliceFirst = index * FUZZY_SLICE_SIZE;
+			const size_t sliceLast = std::min(sliceFirst + FUZZY_SLICE_SIZE, vCopies.size());
+			for (size_t i = sliceFirst; i < sliceLast; i++)
+			{
+				const int score = ScoreFuzzyRow(vCopies[i], szQuery, nullptr, nullptr);
+				if (score != NO_MATCH)
+				{
+					vSliceBest[index].push_back({ score, first + i });
+				}
+			}
+			KeepBest(vSliceBest[index]);
+		});
+
+		for (const std::vector<Ranked>& vSlice : vSliceBest)
+		{
+			vBest.insert(vBest.end(), vSlice.begin(), vSlice.end());
+		}
+		KeepBest(vBest);
+
+		lock.lock();
+		if (m_Generation != generation)
+		{
+			return;
+		}
+	}
+
+	std::sort(vBest.begin(), vBest.end(), [](const Ranked& a, const Ranked& b) { return a.IsBetterThan(b); });
+	for (const Ranked& ranked : vBest)
+	{
+		m_Results.push_back(vOrder[ranked.m_Position]);
+	}
+	m_Running = false;
+} // void ::RankFuzzy(unique_lock<mutex>& lock, unsigned int generation, string_view szQuery, const vector<size_t>& vOrder)
+
+void CTextSearch::KeepBest(std::vector<Ranked>& vRanked)
+{
+	if (vRanked.size() > FUZZY_MAX_RESULTS)
+	{
+		std::nth_element(vRanked.begin(), vRanked.begin() + FUZZY_MAX_RESULTS, vRanked.end(), [](const Ranked& a, const Ranked& b) { return a.IsBetterThan(b); });
+		vRanked.resize(FUZZY_MAX_RESULTS);
+	}
+} // void ::KeepBest(vector<Ranked>& vRanked)
+
+void CTextSearch::Compact()
+{
+	// The old blocks live on until the last search that holds them is done
+	const Blocks vOldBlocks = std::move(m_Blocks);
+	m_Blocks.clear();
+	m_BlockSize = 0;
+	m_BlockCapacity = 0;
+	m_ArenaSize = 0;
+
+	std::vector<Slot> vSlots(m_Rows.size());
+	for (size_t row = 0; row < m_Rows.size(); row++)
+	{
+		const std::string_view szCopy = GetRow(row);
+		vSlots[row] = { Store(szCopy), szCopy.size() };
+		m_Rows[row] = row;
+	}
+
+	m_Slots = std::move(vSlots);
+	m_SlotRows = m_Rows;
+	m_NumDeadBytes = 0;
+
+	// Copies are numbered again, the worker builds the index over from the start
+	m_Postings.clear();
+	m_NumIndexedSlots = 0;
+} // void ::Compact()
+
+void CTextSearch::IndexSlots(size_t maxCount)
+{
+	std::vector<unsigned int> vTrigrams;
+	const size_t last = std::min(m_Slots.size(), m_NumIndexedSlots + maxCount);
+	for (; m_NumIndexedSlots < last; m_NumIndexedSlots++)
+	{
+		if (m_SlotRows[m_NumIndexedSlots] == NO_ROW)
+		{
+			continue;
+		}
+
+		GetTrigrams(GetSlot(m_NumIndexedSlots), vTrigrams);
+		for (unsigned int trigram : vTrigrams)
+		{
+			m_Postings[trigram].push_back(static_cast<unsigned int>(m_NumIndexedSlots));
+		}
+	}
+} // void ::IndexSlots(size_t maxCount)
+
+const char* CTextSearch::Store(std::string_view szFolded)
+{
+	// A block is never reallocated, a copy that does not fit in the last one starts a new one
+	if (m_BlockCapacity - m_BlockSize < szFolded.size() || m_Blocks.empty())
+	{
+		m_BlockCapacity = std::max(ARENA_BLOCK_SIZE, szFolded.size());
+		m_BlockSize = 0;
+		m_Blocks.emplace_back(new char[m_BlockCapacity]);
+	}
+
+	char* pCopy = m_Blocks.back().get() + m_BlockSize;
+	memcpy(pCopy, szFolded.data(), szFolded.size());
+	m_BlockSize += szFolded.size();
+	m_ArenaSize += szFolded.size();
+	return pCopy;
+} // const char* ::Store(string_view szFolded)
+
+void CTextSearch::FindCandidates(std::string_view szQuery, std::vector<Candidate>& vCandidates) const
+{
+	std::vector<unsigned int> vTrigrams;
+	GetTrigrams(szQuery, vTrigrams);
+
+	// A trigram no copy has rules out every indexed one
+	std::vector<const std::vector<unsigned int>*> vLists;
+	for (unsigned int trigram : vTrigrams)
+	{
+		const auto it = m_Postings.find(trigram);
+		if (it == m_Postings.end())
+		{
+			vLists.clear();
+			break;
+		}
+		vLists.push_back(&it->second);
+	}
+
+	if (!vLists.empty())
+	{
+		// Shortest list first, each longer one is only searched for what is left
+		std::sort(vLists.begin(), vLists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+		std::vector<unsigned int> vSlots = *vLists.front();
+		for (size_t i = 1; i < vLists.size() && !vSlots.empty(); i++)
+		{
+			auto it = vLists[i]->begin();
+			size_t numKept = 0;
+			for (unsigned int slot : vSlots)
+			{
+				it = std::lower_bound(it, vLists[i]->end(), slot);
+				if (it != vLists[i]->end() && *it == slot)
+				{
+					vSlots[numKept++] = slot;
+				}
+			}
+			vSlots.resize(numKept);
+		}
+
+		// A copy with the only trigram of the query contains it, longer ones still have to line up
+		const bool bExact = szQuery.size() == 3;
+		for (unsigned int slot : vSlots)
+		{
+			const size_t row = m_SlotRows[slot];
+			if (row != NO_ROW)
+			{
+				vCandidates.push_back({ row, GetSlot(slot), bExact });
+			}
+		}
+	}
+
+	// Copies the index has not reached yet
+	for (size_t slot = m_NumIndexedSlots; slot < m_Slots.size(); slot++)
+	{
+		const size_t row = m_SlotRows[slot];
+		if (row != NO_ROW)
+		{
+			vCandidates.push_back({ row, GetSlot(slot), false });
+		}
+	}
+} // void ::FindCandidates(string_view szQuery, vector<Candidate>& vCandidates) const
+
+void CTextSearch::MatchCandidates(const std::vector<Candidate>& vCandidates, std::string_view szQuery, std::vector<unsigned char>& vMatches)
+{
+	for (const Candidate& candidate : vCandidates)
+	{
+		if (candidate.m_Row < vMatches.size() && (candidate.m_Exact || Contains(candidate.m_Copy, szQuery)))
+		{
+			vMatches[candidate.m_Row] = 1;
+		}
+	}
+} // void ::MatchCandidates(const vector<Candidate>& vCandidates, string_view szQuery, vector<unsigned char>& vMatches)
+
+void CTextSearch::GetTrigrams(std::string_view szValue, std::vector<unsigned int>& vTrigrams)
+{
+	vTrigrams.clear();
+	for (size_t i = 0; i + 3 <= szValue.size(); i++)
+	{
+		const unsigned char a = static_cast<unsigned char>(szValue[i]);
+		const unsigned char b = static_cast<unsigned char>(szValue[i + 1]);
+		const unsigned char c = static_cast<unsigned char>(szValue[i + 2]);
+
+		// Never across the NUL between text and name
+		if (a && b && c)
+		{
+			vTrigrams.push_back(a | (b << 8) | (c << 16));
+		}
+	}
+
+	std::sort(vTrigrams.begin(), vTrigrams.end());
+	vTrigrams.erase(std::unique(vTrigrams.begin(), vTrigrams.end()), vTrigrams.end());
+} // void ::GetTrigrams(string_view szValue, vector<unsigned int>& vTrigrams)
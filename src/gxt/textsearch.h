@@ -0,0 +1,170 @@
+//
+//	gxt/textsearch.h
+//
+
+#ifndef _TEXTSEARCH_H_
+#define _TEXTSEARCH_H_
+
+// Project
+#include "data/parallel.h"
+
+// C/C++
+#include <mutex>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <string_view>
+#include <unordered_map>
+#include <condition_variable>
+
+// Case insensitive substring search over the rows of an open table, run on
+// a worker thread. Every row keeps a case folded copy of its text and name
+// in an arena of fixed blocks, folded when the row is set and never again
+// per search. A copy never moves, a search takes the copies it needs under
+// the lock and holds their blocks while it compares without it. A search
+// walks the rows in the order it is given and hands out matches as
+// it goes, a new search or a change that moves rows cancels the one before.
+//
+// With the index enabled the worker also keeps a posting list of copies for
+// every three byte sequence, built in the background and extended whenever a
+// row is set. A query of three bytes or more only verifies the copies found
+// in all of its posting lists. Copies are numbered in the order they were
+// made, so appending keeps every list sorted, a replaced copy stays in its
+// lists until the next compaction and is skipped as dead.
+//
+// A fuzzy search matches the query as a subsequence of the text or the name
+// and ranks rows the way fzf does: matched bytes score, a match at the start
+// of a word or right after the one before scores more and a gap costs. The
+// worker scores the rows in slices on a pool kept for every search and hands
+// out the best FUZZY_MAX_RESULTS at once when it is done, best first.
+class CTextSearch
+{
+public:
+	CTextSearch();
+	~CTextSearch();
+
+	CTextSearch(const CTextSearch&) = delete;
+	CTextSearch& operator=(const CTextSearch&) = delete;
+
+	// row == GetNumRows() appends. Text and name are searched as one, a match never spans both.
+	void SetRow(size_t row, std::string_view szText, std::string_view szName);
+
+	// Same as SetRow(GetNumRows(), ...) for every pair, folded on every core and added under one lock
+	void AppendRows(const std::vector<std::string_view>& vTexts, const std::vector<std::string_view>& vNames);
+
+	// Mirrors a removal that moves the last row into the gap, cancels the search and drops its results
+	void RemoveRow(size_t row);
+	void Clear();
+	size_t GetNumRows() const;
+
+	// The worker builds the index while no search is running, UpdateIndex builds the rest on the calling thread
+	void EnableIndex(bool bEnable);
+	bool IsIndexEnabled() const { return m_UseIndex; }
+	void UpdateIndex();
+
+	// Searches the rows in vOrder on the worker
+	void Start(std::string_view szQuery, std::vector<size_t> vOrder, bool bFuzzy = false);
+	void Cancel();
+	bool IsRunning() const { return m_Running; }
+
+	// Appends the rows found since the last call, in the order of the search
+	bool TakeResults(std::vector<size_t>& vRows);
+
+	// Checks one row on the calling thread
+	bool Matches(size_t row, std::string_view szQuery) const;
+
+	// Every matching row in row order, on the calling thread
+	void Find(std::string_view szQuery, std::vector<size_t>& vRows) const;
+
+	// Bytes of the text, or of the name if that scores better, the fuzzy query matches in one row
+	bool MatchFuzzy(size_t row, std::string_view szQuery, std::vector<size_t>& vPositions, bool& bInName) const;
+
+	// szHaystack has to be folded already, the needle too
+	static bool Contains(std::string_view szHaystack, std::string_view szNeedle);
+	static void Fold(std::string_view szValue, std::string& szFolded);
+
+	// Both folded, NO_MATCH unless every byte of the query is found in order
+	static int ScoreFuzzy(std::string_view szValue, std::string_view szQuery, std::vector<size_t>* pPositions = nullptr);
+
+	static constexpr size_t CHUNK_SIZE = 2048;			// Rows between two checks for a newer search
+	static constexpr size_t INDEX_CHUNK_SIZE = 256;		// Copies indexed between two checks for a search
+	static constexpr size_t FUZZY_MAX_RESULTS = 1000;
+	static constexpr size_t FUZZY_CHUNK_SIZE = 65536;	// Rows scored between two checks for a newer search
+	static constexpr size_t FUZZY_SLICE_SIZE = 4096;	// Rows a thread scores at a time
+	static constexpr size_t APPEND_SLICE_SIZE = 4096;	// Rows a thread folds at a time
+	static constexpr size_t ARENA_BLOCK_SIZE = 1 << 20;	// Bytes of a block, a longer copy gets one of its own
+	static constexpr size_t NO_ROW = ~static_cast<size_t>(0);
+	static constexpr int NO_MATCH = -0x7FFFFFFF;
+private:
+	struct Slot
+	{
+		const char* m_Data;
+		size_t m_Length;
+	};
+
+	// A copy that may contain the query, m_Exact when it is known to
+	struct Candidate
+	{
+		size_t m_Row;
+		std::string_view m_Copy;
+		bool m_Exact;
+	};
+
+	using Blocks = std::vector<std::shared_ptr<char[]>>;
+
+	struct Ranked
+	{
+		int m_Score;
+		size_t m_Position;		// In the order of the search, breaks ties
+
+		bool IsBetterThan(const Ranked& other) const { return (m_Score != other.m_Score) ? m_Score > other.m_Score : m_Position < other.m_Position; }
+	};
+
+	void Run();
+	void RankFuzzy(std::unique_lock<std::mutex>& lock, unsigned int generation, std::string_view szQuery, const std::vector<size_t>& vOrder);
+	void Compact();
+	void IndexSlots(size_t maxCount);
+
+	// Copies that may contain the query, which has to be folded and at least three bytes long. Taken under
+	// the lock, the copies stay valid without it for as long as the blocks they are in are held.
+	void FindCandidates(std::string_view szQuery, std::vector<Candidate>& vCandidates) const;
+	static void MatchCandidates(const std::vector<Candidate>& vCandidates, std::string_view szQuery, std::vector<unsigned char>& vMatches);
+	bool CanUseIndex(std::string_view szQuery) const { return m_UseIndex && szQuery.size() >= 3; }
+
+	const char* Store(std::string_view szFolded);
+	std::string_view GetSlot(size_t slot) const { return { m_Slots[slot].m_Data, m_Slots[slot].m_Length }; }
+	std::string_view GetRow(size_t row) const { return GetSlot(m_Rows[row]); }
+	static void GetTrigrams(std::string_view szValue, std::vector<unsigned int>& vTrigrams);
+	static int ScoreFuzzyRow(std::string_view szCopy, std::string_view szQuery, std::vector<size_t>* pPositions, bool* pInName);
+	static void KeepBest(std::vector<Ranked>& vRanked);
+private:
+	mutable std::mutex m_Mutex;
+	std::condition_variable m_Wake;
+	std::thread m_Worker;
+	CWorkerPool m_Pool;				// Only used by the worker
+
+	Blocks m_Blocks;				// Folded copies, text and name split by a NUL
+	size_t m_BlockSize;				// Bytes used in the last block
+	size_t m_BlockCapacity;
+	size_t m_ArenaSize;				// Bytes used in every block
+	std::vector<Slot> m_Slots;		// Every copy since the last compaction
+	std::vector<size_t> m_SlotRows;	// Row of each copy, NO_ROW once it was replaced
+	std::vector<size_t> m_Rows;		// Copy of each row
+	size_t m_NumDeadBytes;			// Arena bytes no row points to any more
+
+	std::unordered_map<unsigned int, std::vector<unsigned int>> m_Postings;	// Copies that contain a trigram, ascending
+	size_t m_NumIndexedSlots;
+	bool m_UseIndex;
+
+	std::string m_Query;			// Folded
+	bool m_Fuzzy;
+	std::vector<size_t> m_Order;
+	std::vector<size_t> m_Results;
+	unsigned int m_Generation;		// Bumped by every start and cancel
+	std::atomic<bool> m_Running;
+	bool m_Stop;
+};
+
+#endif // !_TEXTSEARCH_H_
@@ -0,0 +1,499 @@
+//
+//	gxt/watch.cpp
+//
+
+// Project
+#include "watch.h"
+#include "convert.h"
+#include "data/parallel.h"
+
+// C/C++
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <cstring>
+#include <stdexcept>
+#include <algorithm>
+#include <initializer_list>
+
+#if __linux__
+// POSIX
+#include <poll.h>
+#include <unistd.h>
+#include <sys/inotify.h>
+#endif
+
+namespace
+{
+	std::vector<std::filesystem::path> FindSources(const std::filesystem::path& directory)
+	{
+		std::vector<std::filesystem::path> vSources;
+		std::error_code ec;
+		for (std::filesystem::recursive_directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+		{
+			if (it->is_regular_file() && CSourceWatcher::IsSource(it->path()))
+			{
+				vSources.push_back(it->path());
+			}
+		}
+		std::sort(vSources.begin(), vSources.end());
+		return vSources;
+	}
+
+	CFile::Map ReadSource(const std::filesystem::path& path)
+	{
+		CConverter converter(path.string(), false);
+		if (!converter.GetInput()->ReadEntries())
+		{
+			throw std::runtime_error("Failed to read content.");
+		}
+		return converter.GetInput()->TakeData();
+	}
+
+	// Written aside and renamed over the target, readers never see a partial table
+	void WriteTable(const std::string& fileName, CFile::Map&& mEntries, int endian)
+	{
+		const std::string tempFile = fileName + ".tmp";
+		{
+			CGxt2File table(tempFile, CFile::FLAGS_WRITE_COMPILED, endian);
+			table.SetData(std::move(mEntries));
+			if (!table.WriteEntries())
+			{
+				throw std::runtime_error("Failed to save content.");
+			}
+		}
+		std::filesystem::rename(tempFile, fileName);
+	}
+
+	bool IsInside(const std::filesystem::path& path, const std::filesystem::path& directory)
+	{
+		const std::filesystem::path relative = path.lexically_relative(directory);
+		return !relative.empty() && *relative.begin() != "..";
+	}
+
+	long long GetElapsed(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+CSourceWatcher::CSourceWatcher(const std::string& sourceDir, const std::string& masterFile /*= ""*/, int endian /*= CFile::_LITTLE_ENDIAN*/) :
+	m_SourceDir(sourceDir),
+	m_MasterFile(masterFile),
+	m_Endian(endian),
+	m_Running(false)
+{
+	if (!std::filesystem::is_directory(m_SourceDir))
+	{
+		throw std::invalid_argument(sourceDir + " is not a directory.");
+	}
+
+#if __linux__
+	m_Notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Notify < 0)
+	{
+		throw std::runtime_error(std::string("Could not initialize inotify: ") + strerror(errno));
+	}
+#endif
+} // ::CSourceWatcher(const string& sourceDir, const string& masterFile, int endian)
+
+CSourceWatcher::~CSourceWatcher()
+{
+#if __linux__
+	close(m_Notify);
+#endif
+} // ::~CSourceWatcher()
+
+void CSourceWatcher::Run(unsigned int debounceInterval /*= DEFAULT_DEBOUNCE_INTERVAL*/)
+{
+	m_Running = true;
+	Synchronize();
+
+	PathSet changed, removed;
+	std::chrono::steady_clock::time_point lastChange;
+
+	// Saving one file fires several events and editors save several files at once,
+	// everything is compiled together once the tree has been quiet for the interval
+	while (m_Running)
+	{
+		unsigned int timeout = 250;
+		if (!changed.empty() || !removed.empty())
+		{
+			const long long waited = GetElapsed(lastChange);
+			if (waited >= debounceInterval)
+			{
+				Compile(changed, removed);
+				changed.clear();
+				removed.clear();
+				continue;
+			}
+			timeout = debounceInterval - static_cast<unsigned int>(waited);
+		}
+
+		if (WaitForChanges(timeout, changed, removed))
+		{
+			lastChange = std::chrono::steady_clock::now();
+		}
+	}
+} // void ::Run(unsigned int debounceInterval)
+
+bool CSourceWatcher::IsSource(const std::filesystem::path& path)
+{
+	const std::filesystem::path extension = path.extension();
+	return extension == ".json" || extension == ".csv" || extension == ".oxt" || extension == ".txt";
+} // bool ::IsSource(const path& path)
+
+void CSourceWatcher::Synchronize()
+{
+	PathSet changed;
+
+	// Watches go first, nothing written while scanning is missed
+	AddWatches(m_SourceDir, changed);
+
+	const std::vector<std::filesystem::path> vSources = FindSources(m_SourceDir);
+	if (!m_MasterFile.empty())
+	{
+		UpdateMaster(vSources, {});
+	}
+	else
+	{
+		// Only sources newer than their table, an unchanged tree costs one stat per file
+		std::vector<std::filesystem::path> vStale;
+		for (const std::filesystem::path& source : vSources)
+		{
+			std::filesystem::path output = source;
+			output.replace_extension(".gxt2");
+
+			std::error_code ec;
+			const std::filesystem::file_time_type outputTime = std::filesystem::last_write_time(output, ec);
+			if (ec || outputTime < std::filesystem::last_write_time(source, ec))
+			{
+				vStale.push_back(source);
+			}
+		}
+
+		CompileSources(vStale);
+	}
+
+	printf("Watching %s (%zu sources)\n", m_SourceDir.string().c_str(), vSources.size());
+} // void ::Synchronize()
+
+void CSourceWatcher::Compile(const PathSet& changed, const PathSet& removed)
+{
+	std::vector<std::filesystem::path> vSources;
+	for (const std::filesystem::path& source : changed)
+	{
+		// Gone again before the interval ran out, e.g. an editor's temporary file
+		std::error_code ec;
+		if (std::filesystem::is_regular_file(source, ec))
+		{
+			vSources.push_back(source);
+		}
+	}
+
+	if (!m_MasterFile.empty())
+	{
+		UpdateMaster(vSources, removed);
+	}
+	else
+	{
+		CompileSources(vSources);
+		RemoveOutputs(removed);
+	}
+} // void ::Compile(const PathSet& changed, const PathSet& removed)
+
+void CSourceWatcher::CompileSources(const std::vector<std::filesystem::path>& vSources)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	std::atomic<size_t> numCompiled = 0;
+
+	RunParallel(vSources.size(), 0, [this, &vSources, &numCompiled](size_t index)
+	{
+		try
+		{
+			// Parsed before anything is written, a half saved source leaves the old table alone
+			std::filesystem::path output = vSources[index];
+			output.replace_extension(".gxt2");
+			WriteTable(output.string(), ReadSource(vSources[index]), m_Endian);
+			printf("Compiled %s\n", vSources[index].string().c_str());
+			numCompiled++;
+		}
+		catch (const std::exception& ex)
+		{
+			printf("Error: %s: %s\n", vSources[index].string().c_str(), ex.what());
+		}
+	});
+
+	if (!vSources.empty())
+	{
+		printf("Compiled %zu of %zu sources in %lld ms\n", numCompiled.load(), vSources.size(), GetElapsed(start));
+	}
+} // void ::CompileSources(const vector<path>& vSources)
+
+void CSourceWatcher::RemoveOutputs(const PathSet& removed)
+{
+	for (const std::filesystem::path& source : removed)
+	{
+		std::filesystem::path output = source;
+		output.replace_extension(".gxt2");
+
+		// Back again, or the table is still compiled from a source of another format
+		std::error_code ec;
+		bool bInUse = std::filesystem::is_regular_file(source, ec);
+		for (const char* szExtension : { ".json", ".csv", ".oxt", ".txt" })
+		{
+			std::filesystem::path sibling = source;
+			sibling.replace_extension(szExtension);
+			bInUse = bInUse || std::filesystem::is_regular_file(sibling, ec);
+		}
+
+		if (!bInUse && std::filesystem::remove(output, ec))
+		{
+			printf("Removed %s\n", output.string().c_str());
+		}
+	}
+} // void ::RemoveOutputs(const PathSet& removed)
+
+void CSourceWatcher::UpdateMaster(const std::vector<std::filesystem::path>& vSources, const PathSet& removed)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<CFile::Map> vMaps(vSources.size());
+	std::vector<char> vSuccess(vSources.size(), false);
+
+	RunParallel(vSources.size(), 0, [&vSources, &vMaps, &vSuccess](size_t index)
+	{
+		try
+		{
+			vMaps[index] = ReadSource(vSources[index]);
+			vSuccess[index] = true;
+		}
+		catch (const std::exception& ex)
+		{
+			// The last good version stays in the master until the source parses again
+			printf("Error: %s: %s\n", vSources[index].string().c_str(), ex.what());
+		}
+	});
+
+	size_t numUpdated = 0;
+	for (size_t i = 0; i < vSources.size(); i++)
+	{
+		if (vSuccess[i])
+		{
+			m_Sources[vSources[i]] = std::move(vMaps[i]);
+			numUpdated++;
+		}
+	}
+
+	size_t numRemoved = 0;
+	for (const std::filesystem::path& source : removed)
+	{
+		numRemoved += m_Sources.erase(source);
+	}
+
+	if (numUpdated == 0 && numRemoved == 0 && std::filesystem::exists(m_MasterFile))
+	{
+		return;
+	}
+
+	CFile::Map mMaster;
+	for (const auto& [path, mEntries] : m_Sources)
+	{
+		for (const auto& [uHash, szText] : mEntries)
+		{
+			mMaster.insert_or_assign(uHash, szText);
+		}
+	}
+	const size_t numEntries = mMaster.size();
+
+	try
+	{
+		WriteTable(m_MasterFile, std::move(mMaster), m_Endian);
+	}
+	catch (const std::exception& ex)
+	{
+		printf("Error: %s: %s\n", m_MasterFile.c_str(), ex.what());
+		return;
+	}
+
+	printf("Updated %s (%zu changed, %zu removed, %zu entries) in %lld ms\n", m_MasterFile.c_str(), numUpdated, numRemoved, numEntries, GetElapsed(start));
+} // void ::UpdateMaster(const vector<path>& vSources, const PathSet& removed)
+
+#if __linux__
+bool CSourceWatcher::WaitForChanges(unsigned int timeout, PathSet& changed, PathSet& removed)
+{
+	pollfd notify = { m_Notify, POLLIN, 0 };
+	if (poll(&notify, 1, static_cast<int>(timeout)) <= 0)
+	{
+		// Timed out, or interrupted by the signal that stops the watcher
+		return false;
+	}
+
+	alignas(inotify_event) char buffer[64 * 1024];
+	bool bChanged = false;
+
+	for (ssize_t length = read(m_Notify, buffer, sizeof(buffer)); length > 0; length = read(m_Notify, buffer, sizeof(buffer)))
+	{
+		for (ssize_t offset = 0; offset < length;)
+		{
+			const inotify_event* pEvent = reinterpret_cast<const inotify_event*>(buffer + offset);
+			offset += static_cast<ssize_t>(sizeof(inotify_event) + pEvent->len);
+
+			// The kernel dropped events, only a rescan can tell what changed
+			if (pEvent->mask & IN_Q_OVERFLOW)
+			{
+				for (const std::filesystem::path& source : FindSources(m_SourceDir))
+				{
+					changed.insert(source);
+				}
+				bChanged = true;
+				continue;
+			}
+
+			auto it = m_Watches.find(pEvent->wd);
+			if (it == m_Watches.end())
+			{
+				continue;
+			}
+			if (pEvent->mask & IN_IGNORED)
+			{
+				m_Watches.erase(it);
+				continue;
+			}
+			if (pEvent->len == 0)
+			{
+				continue;
+			}
+
+			const std::filesystem::path path = it->second / pEvent->name;
+			if (pEvent->mask & IN_ISDIR)
+			{
+				if (pEvent->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					// Sources moved in along with the directory never fire events of their own
+					AddWatches(path, changed);
+					bChanged = true;
+				}
+				else if (pEvent->mask & IN_MOVED_FROM)
+				{
+					// A moved directory keeps its watches, they would report under the old path
+					std::erase_if(m_Watches, [this, &path](const auto& watch) -> bool
+					{
+						if (!IsInside(watch.second, path))
+						{
+							return false;
+						}
+						inotify_rm_watch(m_Notify, watch.first);
+						return true;
+					});
+					for (const auto& [source, mEntries] : m_Sources)
+					{
+						if (IsInside(source, path))
+						{
+							removed.insert(source);
+						}
+					}
+					bChanged = true;
+				}
+			}
+			else if (IsSource(path))
+			{
+				if (pEvent->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+				{
+					changed.insert(path);
+					removed.erase(path);
+					bChanged = true;
+				}
+				else if (pEvent->mask & (IN_DELETE | IN_MOVED_FROM))
+				{
+					removed.insert(path);
+					changed.erase(path);
+					bChanged = true;
+				}
+			}
+		}
+	}
+	return bChanged;
+} // bool ::WaitForChanges(unsigned int timeout, PathSet& changed, PathSet& removed)
+
+void CSourceWatcher::AddWatches(const std::filesystem::path& directory, PathSet& changed)
+{
+	constexpr uint32_t uMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ONLYDIR;
+
+	std::vector<std::filesystem::path> vDirectories = { directory };
+	std::error_code ec;
+	for (std::filesystem::recursive_directory_iterator it(directory, std::filesystem::directory_options::skip_permission_denied, ec), end; !ec && it != end; it.increment(ec))
+	{
+		if (it->is_directory())
+		{
+			vDirectories.push_back(it->path());
+		}
+		else if (it->is_regular_file() && IsSource(it->path()))
+		{
+			changed.insert(it->path());
+		}
+	}
+
+	for (const std::filesystem::path& path : vDirectories)
+	{
+		const int wd = inotify_add_watch(m_Notify, path.c_str(), uMask);
+		if (wd < 0)
+		{
+			// Usually fs.inotify.max_user_watches, the rest of the tree is still watched
+			printf("Error: Could not watch %s: %s\n", path.string().c_str(), strerror(errno));
+			continue;
+		}
+		m_Watches[wd] = path;
+	}
+} // void ::AddWatches(const path& directory, PathSet& changed)
+#else
+bool CSourceWatcher::WaitForChanges(unsigned int timeout, PathSet& changed, PathSet& removed)
+{
+	std::this_thread::sleep_for(std::chrono::milliseconds(timeout));
+
+	bool bChanged = false;
+	std::map<std::filesystem::path, std::filesystem::file_time_type> mWriteTimes;
+
+	for (const std::filesystem::path& source : FindSources(m_SourceDir))
+	{
+		std::error_code ec;
+		const std::filesystem::file_time_type writeTime = std::filesystem::last_write_time(source, ec);
+		if (ec)
+		{
+			continue;
+		}
+
+		auto it = m_WriteTimes.find(source);
+		if (it == m_WriteTimes.end() || it->second != writeTime)
+		{
+			changed.insert(source);
+			removed.erase(source);
+			bChanged = true;
+		}
+		mWriteTimes[source] = writeTime;
+	}
+
+	for (const auto& [source, writeTime] : m_WriteTimes)
+	{
+		if (!mWriteTimes.contains(source))
+		{
+			removed.insert(source);
+			changed.erase(source);
+			bChanged = true;
+		}
+	}
+
+	m_WriteTimes = std::move(mWriteTimes);
+	return bChanged;
+} // bool ::WaitForChanges(unsigned int timeout, PathSet& changed, PathSet& removed)
+
+void CSourceWatcher::AddWatches(const std::filesystem::path& directory, PathSet& /*changed*/)
+{
+	// Remember what the tree looks like now, the first poll only reports what differs
+	for (const std::filesystem::path& source : FindSources(directory))
+	{
+		std::error_code ec;
+		m_WriteTimes[source] = std::filesystem::last_write_time(source, ec);
+	}
+} // void ::AddWatches(const path& directory, PathSet& changed)
+#endif // __linux__
@@ -0,0 +1,69 @@
+//
+//	gxt/watch.h
+//
+
+#ifndef _WATCH_H_
+#define _WATCH_H_
+
+// Project
+#include "gxt2.h"
+
+// C/C++
+#include <map>
+#include <set>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <unordered_map>
+
+// Recompiles text sources (.json, .csv, .oxt, .txt) below a directory as they
+// change. Without a master table every source is compiled to a .gxt2 next to
+// itself, which is removed again along with the source. With one, every
+// source is kept decoded and the master is rebuilt from the cache, so an edit
+// only re-reads the files that changed. Sources later in path order win on
+// duplicate hashes.
+class CSourceWatcher
+{
+public:
+	CSourceWatcher(const std::string& sourceDir, const std::string& masterFile = "", int endian = CFile::_LITTLE_ENDIAN);
+	~CSourceWatcher();
+
+	// Brings the outputs up to date, then blocks until Stop()
+	void Run(unsigned int debounceInterval = DEFAULT_DEBOUNCE_INTERVAL);
+	void Stop() { m_Running = false; }
+
+	static bool IsSource(const std::filesystem::path& path);
+
+	static constexpr unsigned int DEFAULT_DEBOUNCE_INTERVAL = 100;
+private:
+	using PathSet = std::set<std::filesystem::path>;
+
+	void Synchronize();
+	void Compile(const PathSet& changed, const PathSet& removed);
+	void CompileSources(const std::vector<std::filesystem::path>& vSources);
+	void RemoveOutputs(const PathSet& removed);
+	void UpdateMaster(const std::vector<std::filesystem::path>& vSources, const PathSet& removed);
+
+	// Collects changes for at most timeout ms, true if any were found
+	bool WaitForChanges(unsigned int timeout, PathSet& changed, PathSet& removed);
+	void AddWatches(const std::filesystem::path& directory, PathSet& changed);
+private:
+	std::filesystem::path m_SourceDir;
+	std::string m_MasterFile;
+	int m_Endian;
+	std::atomic<bool> m_Running;
+
+	// Decoded sources of the master table
+	std::map<std::filesystem::path, CFile::Map> m_Sources;
+
+#if __linux__
+	int m_Notify;
+	std::unordered_map<int, std::filesystem::path> m_Watches;
+#else
+	// Polled instead where inotify is not available
+	std::map<std::filesystem::path, std::filesystem::file_time_type> m_WriteTimes;
+#endif
+};
+
+#endif // !_WATCH_H_
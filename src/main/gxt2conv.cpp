@@ -7,35 +7,277 @@
 
 #include "gxt/gxt2.h"
 #include "gxt/convert.h"
+#include "gxt/sort.h"
+#include "gxt/watch.h"
+#include "gxt/cache.h"
+#include "gxt/patch.h"
+#include "gxt/labeldb.h"
 
 // C/C++
+#include <memory>
+#include <vector>
+#include <format>
 #include <fstream>
+#include <csignal>
+#include <filesystem>
 #include <stdlib.h>
 #include <string.h>
 
+static CSourceWatcher* s_Watcher = nullptr;
+
+static void OnSignal(int /*signal*/)
+{
+	if (s_Watcher)
+	{
+		s_Watcher->Stop();
+	}
+}
+
 int gxt2conv::Run(int argc, char* argv[])
 {
-	if (argc < 2 || argc > 3)
+	if (argc < 2)
 	{
-		printf("Usage: %s global.gxt2\n\t", argv[0]);
+		printf("Usage: %s global.gxt2 [/le | /be] [/external] [/mem:<MB>] [/pipeline] [/cache:<dir> | /nocache] [/out:<file>[:le | :be] ...]\n\t", argv[0]);
+		printf("%s global.gxt2 /patch:<changes.txt | .json | .csv | .oxt>\n\t", argv[0]);
+		printf("%s labels.txt /labels [/out:<labels.bin>]\n\t", argv[0]);
+		printf("%s <source directory> /watch [/le | /be] [/master:<file.gxt2>] [/debounce:<ms>]\n\t", argv[0]);
 		return 1;
 	}
 
-	CConverter gxtConverter(argv[1]);
+	int endian = CFile::_ENDIAN_UNKNOWN;
+	bool bExternalSort = false;
+	bool bPipelined = false;
+	bool bWatch = false;
+	bool bCompileLabels = false;
+	std::string cacheDir = CConversionCache::GetDefaultDirectory();
+	std::string masterFile;
+	std::string patchFile;
+	unsigned int debounceInterval = CSourceWatcher::DEFAULT_DEBOUNCE_INTERVAL;
+	size_t memoryBudget = CExternalSorter::DEFAULT_MEMORY_BUDGET;
+	std::vector<std::pair<std::string, int>> vOutputs;
 
-	if (argc == 3)
+	for (int i = 2; i < argc; i++)
 	{
-		if (strcmp(argv[2], "/le") == 0)
+		if (strcmp(argv[i], "/le") == 0)
+		{
+			endian = CFile::_LITTLE_ENDIAN;
+		}
+		else if (strcmp(argv[i], "/be") == 0)
+		{
+			endian = CFile::_BIG_ENDIAN;
+		}
+		else if (strcmp(argv[i], "/external") == 0)
+		{
+			bExternalSort = true;
+		}
+		else if (strcmp(argv[i], "/pipeline") == 0)
 		{
-			gxtConverter.GetOutput()->SetLittleEndian();
+			bPipelined = true;
 		}
-		if (strcmp(argv[2], "/be") == 0)
+		else if (strncmp(argv[i], "/cache:", 7) == 0)
 		{
-			gxtConverter.GetOutput()->SetBigEndian();
+			cacheDir = argv[i] + 7;
 		}
+		else if (strcmp(argv[i], "/nocache") == 0)
+		{
+			cacheDir.clear();
+		}
+		else if (strncmp(argv[i], "/patch:", 7) == 0)
+		{
+			patchFile = argv[i] + 7;
+		}
+		else if (strcmp(argv[i], "/labels") == 0)
+		{
+			bCompileLabels = true;
+		}
+		else if (strcmp(argv[i], "/watch") == 0)
+		{
+			bWatch = true;
+		}
+		else if (strncmp(argv[i], "/master:", 8) == 0)
+		{
+			masterFile = argv[i] + 8;
+		}
+		else if (strncmp(argv[i], "/debounce:", 10) == 0)
+		{
+			debounceInterval = static_cast<unsigned int>(strtoul(argv[i] + 10, nullptr, 10));
+		}
+		else if (strncmp(argv[i], "/mem:", 5) == 0)
+		{
+			memoryBudget = strtoull(argv[i] + 5, nullptr, 10) << 20;
+		}
+		else if (strncmp(argv[i], "/out:", 5) == 0)
+		{
+			std::string szOutput = argv[i] + 5;
+			int outputEndian = CFile::_ENDIAN_UNKNOWN;
+
+			if (szOutput.ends_with(":le"))
+			{
+				outputEndian = CFile::_LITTLE_ENDIAN;
+			}
+			else if (szOutput.ends_with(":be"))
+			{
+				outputEndian = CFile::_BIG_ENDIAN;
+			}
+			if (outputEndian != CFile::_ENDIAN_UNKNOWN)
+			{
+				szOutput.resize(szOutput.size() - 3);
+			}
+			vOutputs.emplace_back(szOutput, outputEndian);
+		}
+	}
+
+	// Keeps compiling the sources below a directory until interrupted
+	if (bWatch)
+	{
+		CSourceWatcher watcher(argv[1], masterFile, (endian != CFile::_ENDIAN_UNKNOWN) ? endian : CFile::_LITTLE_ENDIAN);
+
+		// Keep the log readable when stdout is redirected to a file
+		setvbuf(stdout, nullptr, _IOLBF, 0);
+
+		s_Watcher = &watcher;
+		signal(SIGINT, OnSignal);
+		signal(SIGTERM, OnSignal);
+
+		watcher.Run(debounceInterval);
+
+		s_Watcher = nullptr;
+		return 0;
 	}
 
-	gxtConverter.Convert();
+	// Compiles a label list into the database the editor maps at startup
+	if (bCompileLabels)
+	{
+		const std::string szOutput = vOutputs.empty() ? CLabelDatabase::GetCompiledPath(argv[1]) : vOutputs[0].first;
+		CLabelDatabase database;
+		if (!CLabelDatabase::Compile(argv[1], szOutput) || !database.Open(szOutput))
+		{
+			printf("Error: Could not compile %s!\n", argv[1]);
+			return 1;
+		}
+
+		printf("Compiled %zu labels into %s\n", database.GetSize(), szOutput.c_str());
+		return 0;
+	}
+
+	// Rewrites only the changed strings of an existing table
+	if (!patchFile.empty())
+	{
+		CConverter changes(patchFile, false);
+		if (!changes.GetInput()->ReadEntries())
+		{
+			throw std::runtime_error("Failed to read content.");
+		}
+
+		CGxt2Patcher patcher(argv[1]);
+		size_t numInPlace = 0, numAppended = 0, numFailed = 0;
+
+		for (const auto& [uHash, szText] : changes.GetInput()->GetDataConst())
+		{
+			switch (patcher.Patch(uHash, szText))
+			{
+			case CGxt2Patcher::PATCH_IN_PLACE:
+				numInPlace++;
+				break;
+			case CGxt2Patcher::PATCH_APPENDED:
+				numAppended++;
+				break;
+			case CGxt2Patcher::PATCH_NOT_FOUND:
+				printf("Error: 0x%08X is not in %s, new entries need a full conversion.\n", uHash, argv[1]);
+				numFailed++;
+				break;
+			default:
+				printf("Error: Could not patch 0x%08X.\n", uHash);
+				numFailed++;
+				break;
+			}
+		}
+
+		printf("Patched %zu entries (%zu in place, %zu appended), read %zu KB, wrote %zu KB\n",
+			numInPlace + numAppended, numInPlace, numAppended, (patcher.GetBytesRead() + 1023) >> 10, (patcher.GetBytesWritten() + 1023) >> 10);
+		return numFailed == 0 ? 0 : 1;
+	}
+
+	// Sorts text imports in bounded memory and streams them into a .gxt2
+	if (bExternalSort)
+	{
+		CExternalSorter gxtSorter(argv[1], memoryBudget);
+
+		if (endian != CFile::_ENDIAN_UNKNOWN)
+		{
+			gxtSorter.GetOutput()->SetEndian(endian);
+		}
+
+		gxtSorter.Sort();
+		return 0;
+	}
+
+	// The default output is spelled out so the cache knows every file it serves
+	if (vOutputs.empty())
+	{
+		vOutputs.emplace_back(CConverter::GetDefaultOutputPath(argv[1]), endian);
+	}
+	for (auto& [szOutput, outputEndian] : vOutputs)
+	{
+		if (outputEndian == CFile::_ENDIAN_UNKNOWN)
+		{
+			outputEndian = (endian != CFile::_ENDIAN_UNKNOWN) ? endian : CFile::_LITTLE_ENDIAN;
+		}
+	}
+
+	// Outputs already converted from identical input are linked from the cache
+	std::unique_ptr<CConversionCache> pCache;
+	std::vector<std::string> vKeys;
+	if (!cacheDir.empty())
+	{
+		pCache = std::make_unique<CConversionCache>(cacheDir);
+
+		for (size_t i = 0; i < vOutputs.size();)
+		{
+			const auto& [szOutput, outputEndian] = vOutputs[i];
+
+			// Endianness only changes compiled tables, text outputs share their entry
+			const std::string szExtension = std::filesystem::path(szOutput).extension().string();
+			const std::string key = CConversionCache::MakeKey({ argv[1] }, std::format("convert {} {}", szExtension, szExtension == ".gxt2" ? outputEndian : 0));
+
+			if (pCache->Fetch(key, szOutput))
+			{
+				printf("Cached %s\n", szOutput.c_str());
+				vOutputs.erase(vOutputs.begin() + static_cast<ptrdiff_t>(i));
+				continue;
+			}
+
+			CConversionCache::RemoveOutput(szOutput);
+			vKeys.push_back(key);
+			i++;
+		}
+
+		if (vOutputs.empty())
+		{
+			return 0;
+		}
+	}
+
+	{
+		// Every /out: target is written from a single decode of the input
+		CConverter gxtConverter(argv[1], false, bPipelined);
+
+		for (const auto& [szOutput, outputEndian] : vOutputs)
+		{
+			gxtConverter.AddOutput(szOutput, outputEndian);
+		}
+
+		gxtConverter.Convert();
+	}
+
+	// The outputs are complete once the converter has closed them
+	for (size_t i = 0; pCache && i < vOutputs.size(); i++)
+	{
+		if (!pCache->Store(vKeys[i], vOutputs[i].first))
+		{
+			printf("Warning: Could not add %s to the cache.\n", vOutputs[i].first.c_str());
+		}
+	}
 	return 0;
 }
 
@@ -0,0 +1,168 @@
+//
+//	main/gxt2d.cpp
+//
+
+// Project
+#include "gxt2d.h"
+
+#include "gxt/gxt2.h"
+#include "gxt/daemon.h"
+#include "gxt/shmtable.h"
+#include "data/stringhash.h"
+
+// C/C++
+#include <string>
+#include <csignal>
+#include <stdlib.h>
+#include <string.h>
+
+static CLookupDaemon* s_Daemon = nullptr;
+
+static void OnSignal(int /*signal*/)
+{
+	if (s_Daemon)
+	{
+		s_Daemon->Stop();
+	}
+}
+
+int gxt2d::Run(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: %s <socket | -> <text directory> [/labels:<labels.txt>] [/reload:<ms>] [/shm:<name>]\n", argv[0]);
+		printf("       %s /shm:<name> <language> [0xHASH | LABEL ...]\n\t", argv[0]);
+		return 1;
+	}
+
+	if (strncmp(argv[1], "/shm:", 5) == 0)
+	{
+		return Lookup(argv[1] + 5, argc - 2, argv + 2);
+	}
+
+	std::string labelsFile;
+	std::string sharedMemoryName;
+	unsigned int reloadInterval = 1000;
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (strncmp(argv[i], "/labels:", 8) == 0)
+		{
+			labelsFile = argv[i] + 8;
+		}
+		else if (strncmp(argv[i], "/shm:", 5) == 0)
+		{
+			sharedMemoryName = argv[i] + 5;
+		}
+		else if (strncmp(argv[i], "/reload:", 8) == 0)
+		{
+			reloadInterval = static_cast<unsigned int>(strtoul(argv[i] + 8, nullptr, 10));
+		}
+	}
+
+	// "-" runs as a shared memory publisher only
+	const std::string socketPath = (strcmp(argv[1], "-") == 0) ? "" : argv[1];
+	if (socketPath.empty() && sharedMemoryName.empty())
+	{
+		printf("Nothing to serve, pass a socket or /shm:<name>!\n");
+		return 1;
+	}
+
+	CLookupDaemon daemon(socketPath, argv[2], labelsFile);
+
+	for (const CTextSnapshot::Language& language : daemon.GetSnapshot()->GetLanguages())
+	{
+		printf("Loaded %s (%zu entries)\n", language.m_Name.c_str(), language.m_Table->GetSize());
+	}
+
+	// Keep the log readable when stdout is redirected to a file
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+
+	s_Daemon = &daemon;
+	signal(SIGINT, OnSignal);
+	signal(SIGTERM, OnSignal);
+	signal(SIGPIPE, SIG_IGN);
+
+	if (!sharedMemoryName.empty())
+	{
+		if (!daemon.PublishSharedMemory(sharedMemoryName))
+		{
+			return 1;
+		}
+		printf("Published to shared memory %s\n", sharedMemoryName.c_str());
+	}
+	if (!socketPath.empty())
+	{
+		printf("Listening on %s\n", socketPath.c_str());
+	}
+	const bool bSuccess = daemon.Run(reloadInterval > 0 ? reloadInterval : 1000);
+
+	s_Daemon = nullptr;
+	return bSuccess ? 0 : 1;
+}
+
+int gxt2d::Lookup(const std::string& name, int argc, char* argv[])
+{
+	CSharedTableReader reader;
+	if (!reader.Attach(name))
+	{
+		printf("Error: Nothing is published as %s!\n", name.c_str());
+		return 1;
+	}
+
+	const size_t language = reader.FindLanguage(argv[0]);
+	if (language == reader.GetNumLanguages())
+	{
+		printf("Error: %s is not published, available:", argv[0]);
+		for (size_t i = 0; i < reader.GetNumLanguages(); i++)
+		{
+			printf(" %.*s", static_cast<int>(reader.GetLanguageName(i).size()), reader.GetLanguageName(i).data());
+		}
+		printf("\n");
+		return 1;
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		const std::string query = argv[i];
+		const unsigned int uHash = query.starts_with("0x") || query.starts_with("0X") ?
+			static_cast<unsigned int>(strtoul(query.c_str() + 2, nullptr, 16)) :
+			rage::atStringHash(query.c_str());
+
+		bool bFound = false;
+		const std::string_view szText = reader.Find(language, uHash, bFound);
+		if (bFound)
+		{
+			printf("0x%08X %s: %.*s\n", uHash, query.c_str(), static_cast<int>(szText.size()), szText.data());
+		}
+		else
+		{
+			printf("0x%08X %s: not found\n", uHash, query.c_str());
+		}
+	}
+	return 0;
+}
+
+gxt2d& gxt2d::GetInstance()
+{
+	static gxt2d gxt2d;
+	return gxt2d;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return gxt2d::GetInstance().Run(argc, argv);
+	}
+	catch (const std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return 1;
+	}
+	catch (...)
+	{
+		printf("Unknown error occurred!\n");
+		return 1;
+	}
+}
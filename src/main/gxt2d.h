@@ -0,0 +1,28 @@
+//
+//	main/gxt2d.h
+//
+
+#ifndef _GXT2D_H_
+#define _GXT2D_H_
+
+// Project
+#include "gxt/gxt2.h"
+#include "gxt/daemon.h"
+
+#include "system/app.h"
+
+class gxt2d : public CApp
+{
+private:
+	gxt2d() = default;
+	~gxt2d() = default;
+public:
+	int Run(int argc, char* argv[]) override;
+private:
+	// Answers from a segment another gxt2d published, without a socket round trip
+	int Lookup(const std::string& name, int argc, char* argv[]);
+public:
+	static gxt2d& GetInstance();
+};
+
+#endif // !_GXT2D_H_
@@ -6,6 +6,7 @@
 #include "main.h"
 #include "gxt2edit.h"
 #include "data/util.h"
+#include "data/parallel.h"
 #include "data/stringhash.h"
 #include "grc/graphics.h"
 #include "grc/images/addfile.cpp"
@@ -16,6 +17,7 @@
 #include <format>
 #include <algorithm>
 #include <filesystem>
+#include <unordered_map>
 
 #if __has_include(<execution>)
 	#include <execution>
@@ -42,7 +44,9 @@ gxt2edit::gxt2edit(const std::string& windowTitle, int width, int height) :
 	m_LabelsNotFound(false),
 	m_EditorToolsHeight(110.f),
 	m_SortViewNextRound(false),
-	m_SortUnderlyingData(false),
+	m_FuzzySearch(false),
+	m_LabelSuggestionIndex(-1),
+	m_LabelSuggestionsInUse(false),
 	m_AddFileImg(nullptr),
 	m_RequestNewFile(false),
 	m_RequestOpenFile(false),
@@ -109,9 +113,7 @@ bool gxt2edit::Init()
 	std::filesystem::path labelsFile = basePath / LABELS_FILENAME;
 	if (std::filesystem::exists(labelsFile))
 	{
-		m_LabelNames = GXT_NEW CHashDatabase(labelsFile.string());
-		m_LabelNames->ReadEntries();
-		m_LabelNames->Close();
+		LoadLabels(labelsFile.string());
 	}
 	else
 	{
@@ -126,9 +128,7 @@ bool gxt2edit::Init()
 		}
 		if (std::filesystem::exists(labelsFile))
 		{
-			m_LabelNames = GXT_NEW CHashDatabase(labelsFile.string());
-			m_LabelNames->ReadEntries();
-			m_LabelNames->Close();
+			LoadLabels(labelsFile.string());
 		}
 		else
 #endif
@@ -142,6 +142,57 @@ bool gxt2edit::Init()
 	return bInit;
 }
 
+void gxt2edit::LoadLabels(const std::string& labelsFile)
+{
+	m_LabelNames = GXT_NEW CMemoryFile(); // memory device
+
+	// The compiled labels are mapped as they are, they only get compiled again when labels.txt changed
+	if (!m_LabelDatabase.OpenOrCompile(labelsFile, GetCacheDirectory()))
+	{
+		// Nowhere to write them, parse the list instead
+		CHashDatabase labels(labelsFile);
+		labels.ReadEntries();
+		m_LabelNames->SetData(labels.TakeData());
+	}
+}
+
+std::string gxt2edit::GetCacheDirectory()
+{
+	// Not next to labels.txt, an installed copy is usually read-only
+	std::filesystem::path cacheDir;
+#if _WIN32
+	TCHAR localAppDataPath[MAX_PATH] = {};
+	if (SHGetFolderPath(NULL, CSIDL_LOCAL_APPDATA, NULL, 0, localAppDataPath) == S_OK)
+	{
+		cacheDir = localAppDataPath;
+		cacheDir /= GXT_EDITOR_DOCUMENTS_PATH;
+	}
+#else
+	const char* szCacheHome = std::getenv("XDG_CACHE_HOME");
+	const char* szHome = std::getenv("HOME");
+	if (szCacheHome && *szCacheHome)
+	{
+		cacheDir = std::filesystem::path(szCacheHome) / "gxt2edit";
+	}
+	else if (szHome && *szHome)
+	{
+#if defined(__APPLE__)
+		cacheDir = std::filesystem::path(szHome) / "Library" / "Caches" / "gxt2edit";
+#else
+		cacheDir = std::filesystem::path(szHome) / ".cache" / "gxt2edit";
+#endif
+	}
+#endif
+
+	// Empty compiles next to the list, which still works for a copy the user owns
+	std::error_code ec;
+	if (cacheDir.empty() || (!std::filesystem::create_directories(cacheDir, ec) && ec))
+	{
+		return "";
+	}
+	return cacheDir.string();
+}
+
 void gxt2edit::Shutdown()
 {
 	if (m_AddFileImg)
@@ -154,13 +205,20 @@ void gxt2edit::Shutdown()
 		delete m_LabelNames;
 		m_LabelNames = nullptr;
 	}
+	m_LabelDatabase.Close();
 	return CAppUI::Shutdown();
 }
 
 void gxt2edit::Reset()
 {
 	m_Data.clear();
+	m_DataIndex.clear();
+	m_DisplayNames.clear();
+	m_Order.clear();
 	m_Filter.clear();
+	m_OrderPositions.clear();
+	m_FilterPositions.clear();
+	m_Search.Clear();
 
 	m_HashInput.clear();
 	m_LabelInput.clear();
@@ -172,6 +230,7 @@ void gxt2edit::Draw()
 	HandleDragDropLoading();
 	RenderPopups();
 	CacheDisplayNames();
+	TakeSearchResults();
 	RenderEditor();
 	ProcessShortcuts();
 	ProcessFileRequests();
@@ -247,6 +306,12 @@ void gxt2edit::RenderMenuBar()
 			{
 				SetBigEndian();
 			}
+			ImGui::Separator();
+			if (ImGui::MenuItem("Search Index", nullptr, m_Search.IsIndexEnabled()))
+			{
+				// Built in the background, large tables answer long queries without a scan
+				m_Search.EnableIndex(!m_Search.IsIndexEnabled());
+			}
 #if _WIN32
 			ImGui::Separator();
 			if (ImGui::MenuItem("Register Extension", "Requires Admin"))
@@ -291,7 +356,8 @@ void gxt2edit::RenderTable()
 	ImGui::SetNextWindowPos(ImVec2(pViewport->Pos.x, m_BarSize.y));
 	ImGui::SetNextWindowSize(ImVec2(pViewport->Size.x, pViewport->Size.y - m_BarSize.y - m_EditorToolsHeight));
 
-	if (ImGui::Begin("##Editor", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings))
+	// Stays behind the label suggestions even after a click on the table
+	if (ImGui::Begin("##Editor", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoBringToFrontOnFocus))
 	{
 		if (ImGui::BeginTable("GXT2 Editor", 
 			eColumnSetup::COLUMN_MAX, 
@@ -327,15 +393,25 @@ void gxt2edit::RenderTable()
 				clipper.Begin(static_cast<int>(m_Filter.size()));
 
 				const float trashIconWidth = ImGui::CalcTextSize(ICON_FA_TRASH).x;
+				const bool bHighlight = m_FuzzySearch && !m_SearchInput.empty();
+				std::vector<size_t> vPositions;
+				bool bInName = false;
 
 				while (clipper.Step())
 				{
 					for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i)
 					{
-						// Data
-						const unsigned int& uHash	= m_Filter[i].first;
-						std::string& szText			= m_Filter[i].second;
-						std::string& displayName	= m_LabelNames->GetData()[uHash];
+						// Data, edits go straight to the document
+						const unsigned int uHash	= m_Data[m_Filter[i]].first;
+						std::string& szText			= m_Data[m_Filter[i]].second;
+						std::string& displayName	= m_DisplayNames[m_Filter[i]];
+
+						// Only the rows in view are matched again for their positions
+						vPositions.clear();
+						if (bHighlight)
+						{
+							m_Search.MatchFuzzy(m_Filter[i], m_SearchInput, vPositions, bInName);
+						}
 
 #if 0
 						const CFile::Map::const_iterator itMap = m_LabelNames->GetDataConst().find(uHash);
@@ -360,33 +436,26 @@ void gxt2edit::RenderTable()
 
 						ImGui::TableSetColumnIndex(eColumnSetup::COLUMN_HASH);
 						ImGui::PushItemWidth(-FLT_EPSILON);
+						if (bInName)
+						{
+							HighlightMatches(displayName, vPositions);
+						}
 						ImGui::InputText(("##Hash" + displayName).c_str(), &displayName, ImGuiInputTextFlags_ReadOnly);
 						ImGui::PopItemWidth();
 
 						ImGui::TableSetColumnIndex(eColumnSetup::COLUMN_TEXT);
 						ImGui::PushItemWidth(-FLT_EPSILON);
+						if (!bInName)
+						{
+							HighlightMatches(szText, vPositions);
+						}
 						if (ImGui::InputText(("##Text" + displayName).c_str(), &szText, ImGuiInputTextFlags_AutoSelectAll))
 						{
 							if (szText.empty())
 							{
 								FlagForDeletion(uHash);
 							}
-							else
-							{
-								auto it = std::find_if(m_Data.begin(), m_Data.end(),
-									[uHash](const std::pair<unsigned int, std::string>& entry) -> bool
-									{
-										return entry.first == uHash;
-									});
-
-								if (it != m_Data.end())
-								{
-									if (it->second != szText)
-									{
-										it->second = szText;
-									}
-								}
-							}
+							m_Search.SetRow(m_Filter[i], szText, displayName);
 							m_HasPendingChanges = true;
 						}
 						ImGui::PopItemWidth();
@@ -455,10 +524,13 @@ void gxt2edit::RenderEditTools()
 		ImGui::SameLine();
 
 		ImGui::PushItemWidth(250.f);
-		if (ImGui::InputText("##LabelInput", &m_LabelInput))
+		if (ImGui::InputText("##LabelInput", &m_LabelInput, ImGuiInputTextFlags_CallbackCompletion | ImGuiInputTextFlags_CallbackHistory, LabelInputCallback, this))
 		{
 			m_HashInput = std::format("{:08X}", rage::atStringHash(m_LabelInput.c_str()));
+			UpdateLabelSuggestions();
 		}
+		const bool bLabelInputActive = ImGui::IsItemActive();
+		const float labelInputX = ImGui::GetItemRectMin().x;
 		ImGui::PopItemWidth();
 		ImGui::SameLine();
 
@@ -478,13 +550,7 @@ void gxt2edit::RenderEditTools()
 
 				if (uHash != 0x00000000)
 				{
-					auto it = std::find_if(m_Data.begin(), m_Data.end(),
-						[uHash](const std::pair<unsigned int, std::string>& entry) -> bool
-						{
-							return entry.first == uHash;
-						});
-
-					if (it != m_Data.end())
+					if (FindEntry(uHash))
 					{
 						m_RenderEntryAlreadyExistPopup = true;
 					}
@@ -508,9 +574,14 @@ void gxt2edit::RenderEditTools()
 		ImGui::Text(ICON_FA_MAGNIFYING_GLASS " Search");
 		ImGui::SameLine();
 
-		ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x - paddingLeftRight - 210.f);
+		const float fuzzyWidth = ImGui::GetFrameHeight() + ImGui::GetStyle().ItemInnerSpacing.x + ImGui::CalcTextSize("Fuzzy").x + ImGui::GetStyle().ItemSpacing.x;
+		ImGui::PushItemWidth(ImGui::GetContentRegionAvail().x - paddingLeftRight - 210.f - fuzzyWidth);
 		ImGui::SetCursorPosX(cursorX);
-		ImGui::InputText("##SearchInput", &m_SearchInput);
+		if (ImGui::InputText("##SearchInput", &m_SearchInput))
+		{
+			// Every keystroke replaces the search that is running
+			UpdateFilter();
+		}
 		ImGui::PopItemWidth();
 		ImGui::SameLine();
 
@@ -518,7 +589,6 @@ void gxt2edit::RenderEditTools()
 		{
 			if (!m_SearchInput.empty())
 			{
-				m_SortViewNextRound = true;
 				UpdateFilter();
 			}
 		}
@@ -526,14 +596,78 @@ void gxt2edit::RenderEditTools()
 		if (ImGui::Button("Clear", ImVec2(100.f, 0.f)))
 		{
 			m_SearchInput.clear();
-			m_SortViewNextRound = true;
+			UpdateFilter();
+		}
+		ImGui::SameLine();
+		if (ImGui::Checkbox("Fuzzy", &m_FuzzySearch))
+		{
+			// Misspelled queries still find rows, ranked best first instead of in sort order
 			UpdateFilter();
 		}
 
+		RenderLabelSuggestions(bLabelInputActive, labelInputX);
+
 		ImGui::End();
 	}
 }
 
+void gxt2edit::RenderLabelSuggestions(bool bLabelInputActive, float labelInputX)
+{
+	if (m_LabelInput.empty() || m_LabelSuggestions.empty() || (!bLabelInputActive && !m_LabelSuggestionsInUse))
+	{
+		m_LabelSuggestionsInUse = false;
+		return;
+	}
+
+	// Opens upwards from the top of the editor bar, over the table
+	const ImGuiViewport* pViewport = ImGui::GetMainViewport();
+	ImGui::SetNextWindowPos(ImVec2(labelInputX, pViewport->Size.y - m_EditorToolsHeight), ImGuiCond_Always, ImVec2(0.f, 1.f));
+
+	if (ImGui::Begin("##LabelSuggestions", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoMove | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing))
+	{
+		for (int i = 0; i < static_cast<int>(m_LabelSuggestions.size()); i++)
+		{
+			ImGui::PushID(i);
+			const bool bClicked = ImGui::Selectable(m_LabelSuggestions[i].c_str(), i == m_LabelSuggestionIndex);
+			ImGui::PopID();
+
+			if (bClicked)
+			{
+				m_LabelInput = m_LabelSuggestions[i];
+				m_HashInput = std::format("{:08X}", rage::atStringHash(m_LabelInput.c_str()));
+				m_LabelSuggestions.clear();
+				break;
+			}
+		}
+		m_LabelSuggestionsInUse = ImGui::IsWindowFocused() || ImGui::IsWindowHovered();
+	}
+	ImGui::End();
+}
+
+void gxt2edit::HighlightMatches(const std::string& szValue, const std::vector<size_t>& vPositions) const
+{
+	// Drawn before the input, which has no background of its own in the table
+	const ImVec2 origin = ImGui::GetCursorScreenPos();
+	const float x = origin.x + ImGui::GetStyle().FramePadding.x;
+	const float y = origin.y + ImGui::GetStyle().FramePadding.y;
+	const ImU32 color = ImGui::GetColorU32(ImGuiCol_TextSelectedBg);
+	const char* pValue = szValue.c_str();
+
+	for (size_t position : vPositions)
+	{
+		// A multibyte character is highlighted whole
+		size_t next = position + 1;
+		while (next < szValue.size() && (static_cast<unsigned char>(szValue[next]) & 0xC0) == 0x80)
+		{
+			next++;
+		}
+
+		const float x0 = x + ImGui::CalcTextSize(pValue, pValue + position).x;
+		const float x1 = x + ImGui::CalcTextSize(pValue, pValue + next).x;
+		ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(x0, y), ImVec2(x1, y + ImGui::GetTextLineHeight()), color);
+	}
+}
+
 void gxt2edit::RenderPopups()
 {
 	if (ImGui::BeginPopupModal("Unsaved Changes", nullptr, ImGuiWindowFlags_AlwaysAutoResize))
@@ -701,8 +835,11 @@ void gxt2edit::SortTable()
 	ImGuiTableSortSpecs* sortSpecs = ImGui::TableGetSortSpecs();
 	if (sortSpecs && (sortSpecs->SpecsDirty || m_SortViewNextRound))
 	{
-		auto compareEntries = [&](const std::pair<unsigned int, std::string>& a, const std::pair<unsigned int, std::string>& b) -> bool
+		auto compareEntries = [&](size_t aRow, size_t bRow) -> bool
 		{
+			const std::pair<unsigned int, std::string>& a = m_Data[aRow];
+			const std::pair<unsigned int, std::string>& b = m_Data[bRow];
+
 			for (int n = 0; n < sortSpecs->SpecsCount; n++)
 			{
 				int delta = 0;
@@ -720,33 +857,21 @@ void gxt2edit::SortTable()
 					}
 					else
 					{
-						const CFile::Map& mLabels = m_LabelNames->GetDataConst();
-						const CFile::Map::const_iterator aIt = mLabels.find(a.first);
-						const CFile::Map::const_iterator bIt = mLabels.find(b.first);
-
-						if (aIt != mLabels.end() && bIt != mLabels.end())
-						{
-							const std::string strA = aIt->second;
-							const std::string strB = bIt->second;
-							
-							if (strA.starts_with("0x") && strB.starts_with("0x"))
-							{
-								// Hash comparison
-								if (a.first < b.first) delta = -1;
-								if (a.first > b.first) delta = 1;
-							}
-							else
-							{
-								// Name comparison
-								delta = utils::SortStringIntegers(strA, strB);
-							}
-						}
-						else
+						// Every row keeps its name, nothing is decoded per comparison
+						const std::string& strA = m_DisplayNames[aRow];
+						const std::string& strB = m_DisplayNames[bRow];
+						
+						if (strA.starts_with("0x") && strB.starts_with("0x"))
 						{
 							// Hash comparison
 							if (a.first < b.first) delta = -1;
 							if (a.first > b.first) delta = 1;
 						}
+						else
+						{
+							// Name comparison
+							delta = utils::SortStringIntegers(strA, strB);
+						}
 					}
 				}
 				break;
@@ -765,33 +890,31 @@ void gxt2edit::SortTable()
 		MEASURE_START;
 		{
 #ifdef USE_EXECUTION_SORT
-			if (m_SortUnderlyingData)
-			{
-				std::sort(std::execution::par, m_Data.begin(), m_Data.end(), compareEntries);
-			}
-			std::sort(std::execution::par, m_Filter.begin(), m_Filter.end(), compareEntries);
+			std::sort(std::execution::par, m_Order.begin(), m_Order.end(), compareEntries);
 #else
-			if (m_SortUnderlyingData)
-			{
-				std::sort(m_Data.begin(), m_Data.end(), compareEntries);
-			}
-			std::sort(m_Filter.begin(), m_Filter.end(), compareEntries);
+			std::sort(m_Order.begin(), m_Order.end(), compareEntries);
 
 #endif
 		}
 		MEASURE_END;
 
 #if MEASURE_ENABLED
-		printf("[%s] Entry Count = %lli, m_SortViewNextRound = %s, m_SortUnderlyingData = %s, Execution Time = %lli ms\n", __FUNCTION__, 
-			m_Filter.size(), 
+		printf("[%s] Entry Count = %lli, m_SortViewNextRound = %s, Execution Time = %lli ms\n", __FUNCTION__, 
+			m_Order.size(), 
 			(m_SortViewNextRound) ? "true" : "false", 
-			(m_SortUnderlyingData) ? "true" : "false",
 			MEASURE_MS);
 #endif
 
+		for (size_t position = 0; position < m_Order.size(); position++)
+		{
+			m_OrderPositions[m_Order[position]] = position;
+		}
+
 		sortSpecs->SpecsDirty = false;
 		m_SortViewNextRound = false;
-		m_SortUnderlyingData = false;
+
+		// A search hands out its rows in the new order from the start
+		UpdateFilter();
 	}
 }
 
@@ -1026,13 +1149,36 @@ void gxt2edit::LoadFromFile(const std::string& path, eFileType fileType)
 	{
 		if (pInputDevice->ReadEntries())
 		{
-			for (const auto& [uHash, szEntry] : pInputDevice->GetData())
+			// An imported hash that is already there keeps its text, as it did when saved
+			const size_t firstRow = m_Data.size();
+			for (auto& [uHash, szEntry] : pInputDevice->TakeData())
 			{
-				m_Data.emplace_back(uHash, szEntry);
+				AddRow(uHash, std::move(szEntry));
 			}
-			m_Filter = m_Data;
+
+			// Names and search copies of the new rows are made together, on every core
+			m_DisplayNames.resize(m_Data.size());
+			RunParallel((m_Data.size() - firstRow + LOAD_SLICE_SIZE - 1) / LOAD_SLICE_SIZE, 0, [this, firstRow](size_t slice)
+			{
+				const size_t end = std::min(m_Data.size(), firstRow + (slice + 1) * LOAD_SLICE_SIZE);
+				for (size_t row = firstRow + slice * LOAD_SLICE_SIZE; row < end; row++)
+				{
+					m_DisplayNames[row] = GetDisplayName(m_Data[row].first);
+				}
+			});
+
+			std::vector<std::string_view> vTexts, vNames;
+			vTexts.reserve(m_Data.size() - firstRow);
+			vNames.reserve(m_Data.size() - firstRow);
+			for (size_t row = firstRow; row < m_Data.size(); row++)
+			{
+				vTexts.push_back(m_Data[row].second);
+				vNames.push_back(m_DisplayNames[row]);
+			}
+			m_Search.AppendRows(vTexts, vNames);
+
 			m_SortViewNextRound = true;
-			m_SortUnderlyingData = true;
+			UpdateFilter();
 
 			if (fileType == FILETYPE_GXT2)
 			{
@@ -1104,53 +1250,185 @@ void gxt2edit::FlagForDeletion(unsigned int uHash)
 	m_EntriesToRemove.push_back(uHash);
 }
 
+std::string* gxt2edit::FindEntry(unsigned int uHash)
+{
+	auto it = m_DataIndex.find(uHash);
+	return (it != m_DataIndex.end()) ? &m_Data[it->second].second : nullptr;
+}
+
+bool gxt2edit::AddEntry(unsigned int uHash, std::string szText)
+{
+	if (!AddRow(uHash, std::move(szText)))
+	{
+		return false;
+	}
+	const size_t row = m_Data.size() - 1;
+	m_DisplayNames.push_back(GetDisplayName(uHash));
+	m_Search.SetRow(row, m_Data[row].second, m_DisplayNames[row]);
+	return true;
+}
+
+bool gxt2edit::AddRow(unsigned int uHash, std::string&& szText)
+{
+	if (!m_DataIndex.emplace(uHash, m_Data.size()).second)
+	{
+		return false;
+	}
+	m_Data.emplace_back(uHash, std::move(szText));
+	m_OrderPositions.push_back(m_Order.size());
+	m_FilterPositions.push_back(NO_INDEX);
+	m_Order.push_back(m_Data.size() - 1);
+	return true;
+}
+
+bool gxt2edit::RemoveEntry(unsigned int uHash)
+{
+	auto it = m_DataIndex.find(uHash);
+	if (it == m_DataIndex.end())
+	{
+		return false;
+	}
+
+	// The last row moves into the gap, no other row changes its place. Its
+	// positions go along, the removed row's places are left empty.
+	const size_t row = it->second;
+	const size_t last = m_Data.size() - 1;
+	m_DataIndex.erase(it);
+	m_Search.RemoveRow(row);
+
+	m_Order[m_OrderPositions[row]] = NO_INDEX;
+	if (m_FilterPositions[row] != NO_INDEX)
+	{
+		m_Filter[m_FilterPositions[row]] = NO_INDEX;
+	}
+
+	if (row != last)
+	{
+		m_Data[row] = std::move(m_Data.back());
+		m_DisplayNames[row] = std::move(m_DisplayNames.back());
+		m_DataIndex[m_Data[row].first] = row;
+
+		m_OrderPositions[row] = m_OrderPositions[last];
+		m_Order[m_OrderPositions[row]] = row;
+		m_FilterPositions[row] = m_FilterPositions[last];
+		if (m_FilterPositions[row] != NO_INDEX)
+		{
+			m_Filter[m_FilterPositions[row]] = row;
+		}
+	}
+	m_Data.pop_back();
+	m_DisplayNames.pop_back();
+	m_OrderPositions.pop_back();
+	m_FilterPositions.pop_back();
+	return true;
+}
+
+void gxt2edit::CompactRows(std::vector<size_t>& vRows, std::vector<size_t>& vPositions)
+{
+	// One pass for any number of removals, the rows after a gap move up
+	size_t count = 0;
+	for (size_t row : vRows)
+	{
+		if (row != NO_INDEX)
+		{
+			vPositions[row] = count;
+			vRows[count++] = row;
+		}
+	}
+	vRows.resize(count);
+}
+
+bool gxt2edit::MatchesSearch(size_t row) const
+{
+	return m_SearchInput.empty() || m_Search.Matches(row, m_SearchInput);
+}
+
+void gxt2edit::UpdateFilterRow(size_t row)
+{
+	// The running search does not know the row yet and a ranking has no place for it, both start over
+	if (m_Search.IsRunning() || (m_FuzzySearch && !m_SearchInput.empty()))
+	{
+		UpdateFilter();
+		return;
+	}
+
+	const size_t position = m_FilterPositions[row];
+	const bool bMatches = MatchesSearch(row);
+	if (bMatches && position == NO_INDEX)
+	{
+		m_FilterPositions[row] = m_Filter.size();
+		m_Filter.push_back(row);
+	}
+	else if (!bMatches && position != NO_INDEX)
+	{
+		m_Filter[position] = NO_INDEX;
+		m_FilterPositions[row] = NO_INDEX;
+		CompactRows(m_Filter, m_FilterPositions);
+	}
+}
+
+void gxt2edit::TakeSearchResults()
+{
+	const size_t numShown = m_Filter.size();
+	if (m_Search.TakeResults(m_Filter))
+	{
+		for (size_t position = numShown; position < m_Filter.size(); position++)
+		{
+			m_FilterPositions[m_Filter[position]] = position;
+		}
+	}
+}
+
 void gxt2edit::UpdateFilter()
 {
 	m_Filter.clear();
+	std::fill(m_FilterPositions.begin(), m_FilterPositions.end(), NO_INDEX);
 
 	if (m_Data.empty())
 	{
+		m_Search.Cancel();
 		m_HasPendingChanges = false;
 		return;
 	}
+
 	if (m_SearchInput.empty())
 	{
-		m_Filter = m_Data;
-		m_SortUnderlyingData = true;
+		m_Search.Cancel();
+		m_Filter = m_Order;
+		m_FilterPositions = m_OrderPositions;
 		return;
 	}
-	for (const auto& entry : m_Data)
-	{
-		if (utils::ToLower(entry.second).find(utils::ToLower(m_SearchInput)) != std::string::npos)
-		{
-			m_Filter.push_back(entry);
-		}
-		else if (utils::ToLower(m_LabelNames->GetData()[entry.first]).find(utils::ToLower(m_SearchInput)) != std::string::npos)
-		{
-			m_Filter.push_back(entry);
-		}
-	}
+
+	// Matches come over the next frames, in sort order or best first for a fuzzy search
+	m_Search.Start(m_SearchInput, m_Order, m_FuzzySearch);
 }
 
 void gxt2edit::UpdateEntries()
 {
-	bool bShouldUpdateFilter = false;
-
-	for (const unsigned int& uHash : m_EntriesToRemove)
+	if (!m_EntriesToRemove.empty())
 	{
-		auto it = std::find_if(m_Data.begin(), m_Data.end(),
-			[uHash](const std::pair<unsigned int, std::string>& entry) -> bool
+		bool bRemoved = false;
+		for (const unsigned int& uHash : m_EntriesToRemove)
+		{
+			if (RemoveEntry(uHash))
 			{
-				return entry.first == uHash;
-			});
+				// Update State
+				bRemoved = true;
+				m_HasPendingChanges = !m_Data.empty();
+			}
+		}
 
-		if (it != m_Data.end())
+		if (bRemoved)
 		{
-			m_Data.erase(it);
+			// The removed rows left gaps, the order and the view close them in one pass each
+			CompactRows(m_Order, m_OrderPositions);
+			CompactRows(m_Filter, m_FilterPositions);
 
-			// Update State
-			bShouldUpdateFilter = true;
-			m_HasPendingChanges = true;
+			// Removing a row dropped the results not shown yet, the search starts over on the rows that are left
+			if (!m_SearchInput.empty())
+			{
+				UpdateFilter();
+			}
 		}
 	}
 
@@ -1162,16 +1440,16 @@ void gxt2edit::UpdateEntries()
 		// Entry is not a duplicate, insert and pop
 		if (!m_RenderEntryAlreadyExistPopup && !m_OverrideExistingEntry)
 		{
-			m_Data.push_back(entryToAdd);
+			// Update Display Names, the search takes the name along with the row
+			UpdateDisplayName(uHash);
+
+			AddEntry(uHash, entryToAdd.second);
 			m_ItemsToAdd.pop();
 
 			// Update State
-			bShouldUpdateFilter = true;
+			UpdateFilterRow(m_Data.size() - 1);
 			m_HasPendingChanges = true;
 
-			// Update Display Names
-			UpdateDisplayName(uHash);
-
 			// Insertion was successful, clear fields
 			m_HashInput.clear();
 			m_LabelInput.clear();
@@ -1179,26 +1457,23 @@ void gxt2edit::UpdateEntries()
 		}
 		else if (m_OverrideExistingEntry) // User clicked "Yes" - override existing entry and pop it
 		{
-			auto it = std::find_if(m_Data.begin(), m_Data.end(),
-				[uHash](const std::pair<unsigned int, std::string>& entry) -> bool
-				{
-					return entry.first == uHash;
-				});
-
-			if (it != m_Data.end())
+			if (std::string* pText = FindEntry(uHash))
 			{
 				// Override and Pop
-				it->second = entryToAdd.second;
+				*pText = entryToAdd.second;
 				m_ItemsToAdd.pop();
 
+				// Update Display Names
+				UpdateDisplayName(uHash);
+
 				// Update State
-				bShouldUpdateFilter = true;
+				const size_t row = m_DataIndex.at(uHash);
+				m_DisplayNames[row] = GetDisplayName(uHash);
+				m_Search.SetRow(row, *pText, m_DisplayNames[row]);
+				UpdateFilterRow(row);
 				m_HasPendingChanges = true;
 				m_OverrideExistingEntry = false;
 
-				// Update Display Names
-				UpdateDisplayName(uHash);
-
 				// Insertion was successful, clear fields
 				m_HashInput.clear();
 				m_LabelInput.clear();
@@ -1218,10 +1493,6 @@ void gxt2edit::UpdateEntries()
 	{
 		m_EntriesToRemove.clear();
 	}
-	if (bShouldUpdateFilter)
-	{
-		UpdateFilter();
-	}
 }
 
 void gxt2edit::UpdateDisplayName(unsigned int uHash, bool bHashOnly /*= false*/)
@@ -1231,7 +1502,8 @@ void gxt2edit::UpdateDisplayName(unsigned int uHash, bool bHashOnly /*= false*/)
 		return;
 	}
 
-	if (auto it = m_LabelNames->GetData().find(uHash); it == m_LabelNames->GetData().end())
+	// Known labels stay in the database, only the rest needs a name here
+	if (auto it = m_LabelNames->GetData().find(uHash); it == m_LabelNames->GetData().end() && !m_LabelDatabase.Contains(uHash))
 	{
 		if (!m_LabelInput.empty() && !bHashOnly)
 		{
@@ -1266,6 +1538,68 @@ void gxt2edit::CacheDisplayNames()
 	}
 }
 
+std::string gxt2edit::GetDisplayName(unsigned int uHash) const
+{
+	if (m_LabelNames)
+	{
+		if (auto it = m_LabelNames->GetDataConst().find(uHash); it != m_LabelNames->GetDataConst().end())
+		{
+			return it->second;
+		}
+	}
+
+	std::string displayName;
+	if (!m_LabelDatabase.Find(uHash, displayName))
+	{
+		displayName = std::format("0x{:08X}", uHash);
+	}
+	return displayName;
+}
+
+void gxt2edit::UpdateLabelSuggestions()
+{
+	// One more than shown, the label as typed is not a suggestion
+	const unsigned int uHash = rage::atStringHash(m_LabelInput.c_str());
+	m_LabelSuggestions = m_LabelDatabase.Complete(m_LabelInput, LABEL_SUGGESTIONS_MAX + 1);
+	std::erase_if(m_LabelSuggestions, [uHash](const std::string& szName) { return rage::atStringHash(szName.c_str()) == uHash; });
+
+	if (m_LabelSuggestions.size() > LABEL_SUGGESTIONS_MAX)
+	{
+		m_LabelSuggestions.resize(LABEL_SUGGESTIONS_MAX);
+	}
+	m_LabelSuggestionIndex = -1;
+}
+
+int gxt2edit::LabelInputCallback(ImGuiInputTextCallbackData* pData)
+{
+	gxt2edit& editor = *static_cast<gxt2edit*>(pData->UserData);
+	const int numSuggestions = static_cast<int>(editor.m_LabelSuggestions.size());
+	if (numSuggestions == 0)
+	{
+		return 0;
+	}
+
+	if (pData->EventFlag == ImGuiInputTextFlags_CallbackHistory)
+	{
+		if (pData->EventKey == ImGuiKey_UpArrow)
+		{
+			editor.m_LabelSuggestionIndex = (editor.m_LabelSuggestionIndex <= 0) ? numSuggestions - 1 : editor.m_LabelSuggestionIndex - 1;
+		}
+		else if (pData->EventKey == ImGuiKey_DownArrow)
+		{
+			editor.m_LabelSuggestionIndex = (editor.m_LabelSuggestionIndex + 1) % numSuggestions;
+		}
+	}
+	else if (pData->EventFlag == ImGuiInputTextFlags_CallbackCompletion)
+	{
+		// Tab takes the highlighted suggestion, the first one if none is
+		const std::string& suggestion = editor.m_LabelSuggestions[std::max(editor.m_LabelSuggestionIndex, 0)];
+		pData->DeleteChars(0, pData->BufTextLen);
+		pData->InsertChars(0, suggestion.c_str());
+	}
+	return 0;
+}
+
 void gxt2edit::GenerateUsedLabelList() const
 {
 	if (!m_LabelNames)
@@ -1274,24 +1608,20 @@ void gxt2edit::GenerateUsedLabelList() const
 	}
 
 	CFile::Map mMap;
-	const CFile::Map& mLabels = m_LabelNames->GetDataConst();
-
-	for (const auto& [uHash, szName] : m_Data)
+	for (const auto& [uHash, szText] : m_Data)
 	{
-		if (auto it = mLabels.find(uHash); it != mLabels.end())
+		std::string displayName = GetDisplayName(uHash);
+		if (displayName.starts_with("0x"))
 		{
-			if (it->second.starts_with("0x"))
-			{
-				continue;
-			}
-			mMap[uHash] = it->second;
+			continue;
 		}
+		mMap[uHash] = std::move(displayName);
 	}
 
 	if (!mMap.empty())
 	{
 		CFile* pFile = GXT_NEW CHashDatabase(std::format("labelnames-{}.txt", time(nullptr)), CFile::FLAGS_WRITE_DECOMPILED);
-		pFile->SetData(mMap);
+		pFile->SetData(std::move(mMap));
 		pFile->WriteEntries();
 
 		delete pFile;
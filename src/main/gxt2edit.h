@@ -7,6 +7,8 @@
 
 // Project
 #include "gxt/gxt2.h"
+#include "gxt/labeldb.h"
+#include "gxt/textsearch.h"
 #include "grc/image.h"
 #include "system/app.h"
 
@@ -16,6 +18,7 @@
 // C/C++
 #include <vector>
 #include <stack>
+#include <unordered_map>
 
 // Descriptions
 #define FILEDESC_GXT2 "GTA Text Table (*.gxt2)"
@@ -38,11 +41,17 @@
 
 // Known Labels Filename
 #define LABELS_FILENAME				"labels.txt"
+#define LABEL_SUGGESTIONS_MAX		10
 #define GXT_EDITOR_DOCUMENTS_PATH	"GXT Editor"
 
+// Rows a thread names at a time when a file is loaded
+#define LOAD_SLICE_SIZE				4096
+
 class gxt2edit : public CAppUI
 {
 private:
+	static constexpr size_t NO_INDEX = ~static_cast<size_t>(0);
+
 	enum eFileType
 	{
 		FILETYPE_UNKNOWN,
@@ -84,6 +93,8 @@ private:
 	void RegisterExtension(bool bUnregister = false);
 #endif
 	void SetEditorTheme(bool bDarkMode /*= true*/) const;
+	void LoadLabels(const std::string& labelsFile);
+	static std::string GetCacheDirectory();
 
 	//---------------- UI ----------------
 	//
@@ -96,6 +107,8 @@ private:
 	void RenderEmptyView();
 	void RenderEditTools();
 	void RenderPopups();
+	void RenderLabelSuggestions(bool bLabelInputActive, float labelInputX);
+	void HighlightMatches(const std::string& szValue, const std::vector<size_t>& vPositions) const;
 	void ProcessShortcuts();
 	void SortTable();
 
@@ -125,10 +138,21 @@ private:
 	//
 	bool CheckChanges();
 	void FlagForDeletion(unsigned int uHash);
+	std::string* FindEntry(unsigned int uHash);
+	bool AddEntry(unsigned int uHash, std::string szText);
+	bool AddRow(unsigned int uHash, std::string&& szText);	// Leaves the name and the search copy to the caller
+	bool RemoveEntry(unsigned int uHash);	// Leaves NO_INDEX behind in m_Order and m_Filter, see CompactRows
+	static void CompactRows(std::vector<size_t>& vRows, std::vector<size_t>& vPositions);
+	bool MatchesSearch(size_t row) const;
+	void TakeSearchResults();
+	void UpdateFilterRow(size_t row);
 	void UpdateFilter();
 	void UpdateEntries();
 	void UpdateDisplayName(unsigned int uHash, bool bHashOnly = false);
 	void CacheDisplayNames();
+	std::string GetDisplayName(unsigned int uHash) const;
+	void UpdateLabelSuggestions();
+	static int LabelInputCallback(ImGuiInputTextCallbackData* pData);
 
 	//---------------- Tools ----------------
 	//
@@ -138,8 +162,15 @@ private:
 	//---------------- IO ----------------
 	//
 	CFile::Vec m_Data;
-	CFile::Vec m_Filter;
-	CFile* m_LabelNames;
+	std::unordered_map<unsigned int, size_t> m_DataIndex;	// Hash to row in m_Data
+	std::vector<std::string> m_DisplayNames;	// Of each row in m_Data, taken from the labels once when the row is added
+	std::vector<size_t> m_Order;		// Rows of m_Data in sort order
+	std::vector<size_t> m_Filter;		// Rows of m_Order that match the search, filled by m_Search as it goes
+	std::vector<size_t> m_OrderPositions;	// Position of each row in m_Order
+	std::vector<size_t> m_FilterPositions;	// Position of each row in m_Filter, NO_INDEX if it is not in view
+	CTextSearch m_Search;
+	CLabelDatabase m_LabelDatabase;
+	CFile* m_LabelNames;		// Labels typed in and hashes without one, the database has the rest
 	std::string m_Path;
 	int m_Endian;
 	bool m_LabelsNotFound;
@@ -149,11 +180,14 @@ private:
 	ImVec2 m_BarSize;
 	float m_EditorToolsHeight;
 	bool m_SortViewNextRound;
-	bool m_SortUnderlyingData;
 	std::string m_HashInput;
 	std::string m_LabelInput;
 	std::string m_TextInput;
 	std::string m_SearchInput;
+	bool m_FuzzySearch;
+	std::vector<std::string> m_LabelSuggestions;
+	int m_LabelSuggestionIndex;			// Highlighted suggestion, -1 for none
+	bool m_LabelSuggestionsInUse;		// Hovered or focused, a click on it takes the focus off the input
 	CImage* m_AddFileImg;
 
 	//---------------- Editing ----------------
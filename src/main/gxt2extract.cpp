@@ -0,0 +1,82 @@
+//
+//	main/gxt2extract.cpp
+//
+
+// Project
+#include "gxt2extract.h"
+
+#include "gxt/gxt2.h"
+#include "gxt/extract.h"
+
+// C/C++
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+int gxt2extract::Run(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		printf("Usage: %s <labels.txt> <output.gxt2> <input1.gxt2> [input2.gxt2 ...] [/le | /be]\n\t", argv[0]);
+		return 1;
+	}
+
+	int endian = CFile::_LITTLE_ENDIAN;
+	std::vector<std::string> inputFiles;
+
+	for (int i = 3; i < argc; i++)
+	{
+		if (strcmp(argv[i], "/le") == 0)
+		{
+			endian = CFile::_LITTLE_ENDIAN;
+		}
+		else if (strcmp(argv[i], "/be") == 0)
+		{
+			endian = CFile::_BIG_ENDIAN;
+		}
+		else
+		{
+			inputFiles.push_back(argv[i]);
+		}
+	}
+
+	if (inputFiles.empty())
+	{
+		printf("No input files specified!\n");
+		return 1;
+	}
+
+	CExtractor extractor(argv[1], inputFiles, argv[2]);
+	extractor.GetOutput()->SetEndian(endian);
+
+	if (!extractor.Run())
+	{
+		printf("Extraction failed!\n");
+		return 1;
+	}
+	return 0;
+}
+
+gxt2extract& gxt2extract::GetInstance()
+{
+	static gxt2extract gxt2extract;
+	return gxt2extract;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return gxt2extract::GetInstance().Run(argc, argv);
+	}
+	catch (const std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return 1;
+	}
+	catch (...)
+	{
+		printf("Unknown error occurred!\n");
+		return 1;
+	}
+}
@@ -0,0 +1,25 @@
+//
+//	main/gxt2extract.h
+//
+
+#ifndef _GXT2EXTRACT_H_
+#define _GXT2EXTRACT_H_
+
+// Project
+#include "gxt/gxt2.h"
+#include "gxt/extract.h"
+
+#include "system/app.h"
+
+class gxt2extract : public CApp
+{
+private:
+	gxt2extract() = default;
+	~gxt2extract() = default;
+public:
+	int Run(int argc, char* argv[]) override;
+public:
+	static gxt2extract& GetInstance();
+};
+
+#endif // !_GXT2EXTRACT_H_
@@ -0,0 +1,234 @@
+//
+//	main/gxt2grep.cpp
+//
+
+// Project
+#include "gxt2grep.h"
+
+#include "gxt/gxt2.h"
+#include "gxt/grep.h"
+#include "gxt/textsearch.h"
+
+// C/C++
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include <filesystem>
+#include <stdlib.h>
+#include <string.h>
+
+int gxt2grep::Run(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: %s <pattern> <input.gxt2 | directory> [...] [/i] [/regex] [/labels:<labels.txt>] [/threads:<count>] [/query]\n\t", argv[0]);
+		return 1;
+	}
+
+	int flags = CTableGrep::FLAGS_NONE;
+	unsigned int numThreads = 0;
+	bool bQuery = false;
+	std::string labelsFile;
+	std::vector<std::string> inputFiles;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (strcmp(argv[i], "/i") == 0)
+		{
+			flags |= CTableGrep::FLAGS_IGNORE_CASE;
+		}
+		else if (strcmp(argv[i], "/regex") == 0)
+		{
+			flags |= CTableGrep::FLAGS_REGEX;
+		}
+		else if (strncmp(argv[i], "/labels:", 8) == 0)
+		{
+			labelsFile = argv[i] + 8;
+		}
+		else if (strncmp(argv[i], "/threads:", 9) == 0)
+		{
+			numThreads = static_cast<unsigned int>(strtoul(argv[i] + 9, nullptr, 10));
+		}
+		else if (strcmp(argv[i], "/query") == 0)
+		{
+			bQuery = true;
+		}
+		else if (std::filesystem::is_directory(argv[i]))
+		{
+			std::vector<std::string> vFound;
+			for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(argv[i]))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".gxt2")
+				{
+					vFound.push_back(entry.path().string());
+				}
+			}
+			std::sort(vFound.begin(), vFound.end());
+			inputFiles.insert(inputFiles.end(), vFound.begin(), vFound.end());
+		}
+		else
+		{
+			inputFiles.push_back(argv[i]);
+		}
+	}
+
+	if (inputFiles.empty())
+	{
+		printf("No input files specified!\n");
+		return 1;
+	}
+
+	CFile::Map mLabels;
+	if (!labelsFile.empty())
+	{
+		CHashDatabase labels(labelsFile);
+		if (!labels.ReadEntries())
+		{
+			printf("Failed to read %s!\n", labelsFile.c_str());
+			return 1;
+		}
+		mLabels = labels.TakeData();
+	}
+
+	if (bQuery)
+	{
+		// The index only answers plain substrings, and it already uses every core
+		if ((flags & CTableGrep::FLAGS_REGEX) || numThreads != 0)
+		{
+			printf("/query cannot be combined with /regex or /threads!\n");
+			return 1;
+		}
+		return RunQueries(argv[1], inputFiles, mLabels, (flags & CTableGrep::FLAGS_IGNORE_CASE) != 0);
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	CTableGrep grep(argv[1], flags);
+	const std::vector<CTableGrep::Result> vResults = grep.Search(inputFiles, numThreads);
+
+	const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+	size_t numMatches = 0;
+	bool bSuccess = true;
+
+	// One tab separated line per hash: file, hash, label, text
+	for (const CTableGrep::Result& result : vResults)
+	{
+		if (!result.m_Error.empty())
+		{
+			printf("Error: %s: %s\n", result.m_Path.c_str(), result.m_Error.c_str());
+			bSuccess = false;
+		}
+
+		for (const CTableGrep::Match& match : result.m_Matches)
+		{
+			const auto it = mLabels.find(match.m_Hash);
+			const char* szLabel = it != mLabels.end() ? it->second.c_str() : "";
+			printf("%s\t0x%08X\t%s\t%.*s\n", result.m_Path.c_str(), match.m_Hash, szLabel, static_cast<int>(match.m_Text.size()), match.m_Text.data());
+		}
+		numMatches += result.m_Matches.size();
+	}
+
+	fprintf(stderr, "%zu matches in %zu files (%lld ms)\n", numMatches, vResults.size(), static_cast<long long>(elapsed.count()));
+	return bSuccess ? 0 : 1;
+}
+
+int gxt2grep::RunQueries(const std::string& firstQuery, const std::vector<std::string>& inputFiles, const CFile::Map& mLabels, bool bIgnoreCase)
+{
+	struct Row
+	{
+		size_t m_File;
+		unsigned int m_Hash;
+		std::string m_Text;
+	};
+
+	auto start = std::chrono::steady_clock::now();
+
+	// Every table goes into one index, only the text is searched like without /query
+	std::vector<Row> vRows;
+	CTextSearch search;
+	for (size_t i = 0; i < inputFiles.size(); i++)
+	{
+		CGxt2File input(inputFiles[i], CFile::FLAGS_READ_COMPILED);
+		if (!input.ReadEntries())
+		{
+			printf("Error: Failed to read %s!\n", inputFiles[i].c_str());
+			return 1;
+		}
+
+		for (auto& [uHash, szText] : input.TakeData())
+		{
+			vRows.push_back({ i, uHash, std::move(szText) });
+		}
+	}
+
+	std::vector<std::string_view> vTexts(vRows.size());
+	for (size_t row = 0; row < vRows.size(); row++)
+	{
+		vTexts[row] = vRows[row].m_Text;
+	}
+	search.AppendRows(vTexts, std::vector<std::string_view>(vRows.size()));
+	search.EnableIndex(true);
+	search.UpdateIndex();
+
+	fprintf(stderr, "Indexed %zu entries in %zu files (%lld ms)\n", vRows.size(), inputFiles.size(),
+		static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count()));
+
+	// The pattern on the command line first, then one per line until the input ends
+	std::string szQuery = firstQuery;
+	std::vector<size_t> vFound;
+	do
+	{
+		if (szQuery.empty())
+		{
+			continue;
+		}
+
+		start = std::chrono::steady_clock::now();
+		vFound.clear();
+		search.Find(szQuery, vFound);
+
+		// The index folds case, a match with the case of the query also matches folded
+		if (!bIgnoreCase)
+		{
+			std::erase_if(vFound, [&vRows, &szQuery](size_t row) { return vRows[row].m_Text.find(szQuery) == std::string::npos; });
+		}
+		const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+		for (size_t row : vFound)
+		{
+			const auto it = mLabels.find(vRows[row].m_Hash);
+			const char* szLabel = it != mLabels.end() ? it->second.c_str() : "";
+			printf("%s\t0x%08X\t%s\t%s\n", inputFiles[vRows[row].m_File].c_str(), vRows[row].m_Hash, szLabel, vRows[row].m_Text.c_str());
+		}
+		fflush(stdout);
+		fprintf(stderr, "%zu matches for \"%s\" (%.2f ms)\n", vFound.size(), szQuery.c_str(), elapsed.count());
+	} while (std::getline(std::cin, szQuery));
+	return 0;
+}
+
+gxt2grep& gxt2grep::GetInstance()
+{
+	static gxt2grep gxt2grep;
+	return gxt2grep;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return gxt2grep::GetInstance().Run(argc, argv);
+	}
+	catch (const std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return 1;
+	}
+	catch (...)
+	{
+		printf("Unknown error occurred!\n");
+		return 1;
+	}
+}
@@ -0,0 +1,28 @@
+//
+//	main/gxt2grep.h
+//
+
+#ifndef _GXT2GREP_H_
+#define _GXT2GREP_H_
+
+// Project
+#include "gxt/gxt2.h"
+#include "gxt/grep.h"
+
+#include "system/app.h"
+
+class gxt2grep : public CApp
+{
+private:
+	gxt2grep() = default;
+	~gxt2grep() = default;
+public:
+	int Run(int argc, char* argv[]) override;
+public:
+	static gxt2grep& GetInstance();
+private:
+	// Indexes the text of every table once and answers substring queries read from stdin
+	int RunQueries(const std::string& firstQuery, const std::vector<std::string>& inputFiles, const CFile::Map& mLabels, bool bIgnoreCase);
+};
+
+#endif // !_GXT2GREP_H_
@@ -0,0 +1,109 @@
+//
+//	main/gxt2locate.cpp
+//
+
+// Project
+#include "gxt2locate.h"
+
+#include "gxt/locator.h"
+#include "data/stringhash.h"
+
+// C/C++
+#include <chrono>
+#include <string>
+#include <vector>
+#include <stdlib.h>
+#include <string.h>
+
+int gxt2locate::Run(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: %s <index file> [/update:<text directory>] [0xHASH | LABEL ...]\n\t", argv[0]);
+		return 1;
+	}
+
+	std::string rootDir;
+	std::vector<std::string> queries;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (strncmp(argv[i], "/update:", 8) == 0)
+		{
+			rootDir = argv[i] + 8;
+		}
+		else
+		{
+			queries.push_back(argv[i]);
+		}
+	}
+
+	CHashLocator locator;
+	const bool bLoaded = locator.Load(argv[1]);
+
+	if (!rootDir.empty())
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const size_t numRead = locator.Update(rootDir);
+		const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+
+		if (!locator.Save(argv[1]))
+		{
+			printf("Error: Could not write %s!\n", argv[1]);
+			return 1;
+		}
+		printf("Indexed %zu files (%zu re-read), %zu hashes in %lld ms\n", locator.GetFiles().size(), numRead, locator.GetNumHashes(), static_cast<long long>(elapsed.count()));
+	}
+	else if (!bLoaded)
+	{
+		printf("Could not load %s, build it with /update:<text directory> first!\n", argv[1]);
+		return 1;
+	}
+
+	for (const std::string& query : queries)
+	{
+		const unsigned int uHash = query.starts_with("0x") || query.starts_with("0X") ?
+			static_cast<unsigned int>(strtoul(query.c_str() + 2, nullptr, 16)) :
+			rage::atStringHash(query.c_str());
+
+		const std::vector<uint32_t> vFiles = locator.Find(uHash);
+		printf("0x%08X %s: %zu file(s)\n", uHash, query.c_str(), vFiles.size());
+
+		for (uint32_t uFile : vFiles)
+		{
+			const CHashLocator::File& file = locator.GetFiles()[uFile];
+			const std::filesystem::path path = locator.GetRoot() / file.m_Path;
+
+			// Only the hits are checked against the tree, a stale hit is reported instead of trusted
+			std::error_code ec;
+			const bool bStale = std::filesystem::file_size(path, ec) != file.m_Size || ec ||
+				std::filesystem::last_write_time(path, ec).time_since_epoch().count() != file.m_WriteTime || ec;
+			printf("\t%s%s\n", path.string().c_str(), bStale ? " (changed since indexed)" : "");
+		}
+	}
+	return 0;
+}
+
+gxt2locate& gxt2locate::GetInstance()
+{
+	static gxt2locate gxt2locate;
+	return gxt2locate;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return gxt2locate::GetInstance().Run(argc, argv);
+	}
+	catch (const std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return 1;
+	}
+	catch (...)
+	{
+		printf("Unknown error occurred!\n");
+		return 1;
+	}
+}
@@ -0,0 +1,24 @@
+//
+//	main/gxt2locate.h
+//
+
+#ifndef _GXT2LOCATE_H_
+#define _GXT2LOCATE_H_
+
+// Project
+#include "gxt/locator.h"
+
+#include "system/app.h"
+
+class gxt2locate : public CApp
+{
+private:
+	gxt2locate() = default;
+	~gxt2locate() = default;
+public:
+	int Run(int argc, char* argv[]) override;
+public:
+	static gxt2locate& GetInstance();
+};
+
+#endif // !_GXT2LOCATE_H_
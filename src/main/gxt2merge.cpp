@@ -7,39 +7,77 @@
 
 #include "gxt/gxt2.h"
 #include "gxt/merge.h"
+#include "gxt/cache.h"
 
 // C/C++
+#include <memory>
+#include <format>
 #include <fstream>
 #include <stdlib.h>
 #include <string.h>
 
 int gxt2merge::Run(int argc, char* argv[])
 {
-	if (argc < 4 || argc > 5)
+	if (argc < 4)
 	{
-		printf("Usage: %s <file1.gxt2> <file2.gxt2> <output.gxt2>\n\t", argv[0]);
+		printf("Usage: %s <file1.gxt2> <file2.gxt2> <output.gxt2> [/le | /be] [/cache:<dir> | /nocache]\n\t", argv[0]);
 		return 1;
 	}
 
-	CMerger merger(argv[1], argv[2], argv[3]);
+	int endian = CFile::_LITTLE_ENDIAN;
+	std::string cacheDir = CConversionCache::GetDefaultDirectory();
 
-	if (argc == 5)
+	for (int i = 4; i < argc; i++)
 	{
-		if (strcmp(argv[4], "/le") == 0)
+		if (strcmp(argv[i], "/le") == 0)
 		{
-			merger.GetOutput()->SetLittleEndian();
+			endian = CFile::_LITTLE_ENDIAN;
 		}
-		if (strcmp(argv[4], "/be") == 0)
+		else if (strcmp(argv[i], "/be") == 0)
 		{
-			merger.GetOutput()->SetBigEndian();
+			endian = CFile::_BIG_ENDIAN;
+		}
+		else if (strncmp(argv[i], "/cache:", 7) == 0)
+		{
+			cacheDir = argv[i] + 7;
+		}
+		else if (strcmp(argv[i], "/nocache") == 0)
+		{
+			cacheDir.clear();
 		}
 	}
-	if (!merger.Run())
+
+	// The same pair of tables merged before is linked from the cache
+	std::unique_ptr<CConversionCache> pCache;
+	std::string key;
+	if (!cacheDir.empty())
 	{
-		printf("Merge failed!\n");
-		return 1;
+		pCache = std::make_unique<CConversionCache>(cacheDir);
+		key = CConversionCache::MakeKey({ argv[1], argv[2] }, std::format("merge {}", endian));
+
+		if (pCache->Fetch(key, argv[3]))
+		{
+			return 0;
+		}
+		CConversionCache::RemoveOutput(argv[3]);
+	}
+
+	{
+		CMerger merger(argv[1], argv[2], argv[3]);
+		merger.GetOutput()->SetEndian(endian);
+
+		if (!merger.Run())
+		{
+			printf("Merge failed!\n");
+			return 1;
+		}
 	}
 	//printf("Successfully merged!\n");
+
+	if (pCache && !pCache->Store(key, argv[3]))
+	{
+		printf("Warning: Could not add %s to the cache.\n", argv[3]);
+	}
 	return 0;
 }
 
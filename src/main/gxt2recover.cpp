@@ -0,0 +1,220 @@
+//
+//	main/gxt2recover.cpp
+//
+
+// Project
+#include "gxt2recover.h"
+
+#include "gxt/gxt2.h"
+#include "gxt/recover.h"
+
+// C/C++
+#include <set>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <stdlib.h>
+#include <string.h>
+
+int gxt2recover::Run(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		printf("Usage: %s <labels.txt> <input.gxt2 | directory> [...] [/stems:<count>] [/tokens:<count>] [/numbers:<count>] [/depth:<count>] [/threads:<count>] [/precision:<percent>] [/append]\n\t", argv[0]);
+		return 1;
+	}
+
+	size_t maxStems = CLabelRecovery::DEFAULT_MAX_STEMS;
+	size_t maxTokens = CLabelRecovery::DEFAULT_MAX_TOKENS;
+	unsigned int maxNumber = CLabelRecovery::DEFAULT_MAX_NUMBER;
+	unsigned int depth = CLabelRecovery::DEFAULT_DEPTH;
+	unsigned int numThreads = 0;
+	double minPrecision = DEFAULT_MIN_PRECISION;
+	bool bAppend = false;
+	std::vector<std::string> inputFiles;
+
+	for (int i = 2; i < argc; i++)
+	{
+		if (strncmp(argv[i], "/stems:", 7) == 0)
+		{
+			maxStems = strtoul(argv[i] + 7, nullptr, 10);
+		}
+		else if (strncmp(argv[i], "/tokens:", 8) == 0)
+		{
+			maxTokens = strtoul(argv[i] + 8, nullptr, 10);
+		}
+		else if (strncmp(argv[i], "/numbers:", 9) == 0)
+		{
+			maxNumber = static_cast<unsigned int>(strtoul(argv[i] + 9, nullptr, 10));
+		}
+		else if (strncmp(argv[i], "/depth:", 7) == 0)
+		{
+			depth = static_cast<unsigned int>(strtoul(argv[i] + 7, nullptr, 10));
+		}
+		else if (strncmp(argv[i], "/threads:", 9) == 0)
+		{
+			numThreads = static_cast<unsigned int>(strtoul(argv[i] + 9, nullptr, 10));
+		}
+		else if (strncmp(argv[i], "/precision:", 11) == 0)
+		{
+			minPrecision = strtod(argv[i] + 11, nullptr) / 100.0;
+		}
+		else if (strcmp(argv[i], "/append") == 0)
+		{
+			bAppend = true;
+		}
+		else if (std::filesystem::is_directory(argv[i]))
+		{
+			std::vector<std::string> vFound;
+			for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(argv[i]))
+			{
+				if (entry.is_regular_file() && entry.path().extension() == ".gxt2")
+				{
+					vFound.push_back(entry.path().string());
+				}
+			}
+			std::sort(vFound.begin(), vFound.end());
+			inputFiles.insert(inputFiles.end(), vFound.begin(), vFound.end());
+		}
+		else
+		{
+			inputFiles.push_back(argv[i]);
+		}
+	}
+
+	if (inputFiles.empty())
+	{
+		printf("No input files specified!\n");
+		return 1;
+	}
+
+	CHashDatabase labels(argv[1]);
+	if (!labels.ReadEntries())
+	{
+		printf("Failed to read %s!\n", argv[1]);
+		return 1;
+	}
+	const CFile::Map mLabels = labels.TakeData();
+	labels.Close();
+
+	// Only the offset tables are read, the strings do not matter here
+	std::set<unsigned int> unknown;
+	for (const std::string& inputFile : inputFiles)
+	{
+		CGxt2File input(inputFile, CFile::FLAGS_READ_COMPILED);
+		std::vector<unsigned int> vHashes;
+		if (!input.ReadHashes(vHashes))
+		{
+			printf("Error: Failed to read %s!\n", inputFile.c_str());
+			return 1;
+		}
+
+		for (unsigned int uHash : vHashes)
+		{
+			if (mLabels.find(uHash) == mLabels.end())
+			{
+				unknown.insert(uHash);
+			}
+		}
+	}
+
+	if (unknown.empty())
+	{
+		printf("Every hash in the input already has a label.\n");
+		return 0;
+	}
+
+	std::vector<std::string> vKnownLabels;
+	vKnownLabels.reserve(mLabels.size());
+	for (const auto& [uHash, szLabel] : mLabels)
+	{
+		vKnownLabels.push_back(szLabel);
+	}
+
+	CLabelRecovery recovery(vKnownLabels, maxStems, maxTokens, maxNumber, depth);
+	fprintf(stderr, "Searching %zu unknown hashes with %zu stems and %zu tokens\n", unknown.size(), recovery.GetNumStems(), recovery.GetNumTokens());
+
+	const auto start = std::chrono::steady_clock::now();
+	const CLabelRecovery::Names mNames = recovery.Search(std::vector<unsigned int>(unknown.begin(), unknown.end()), numThreads);
+	const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// Only the best name of a hash is appended, and only if it is the one likely name for it
+	std::vector<std::string> vRecovered;
+	for (const auto& [uHash, vMatches] : mNames)
+	{
+		for (const CLabelRecovery::Match& match : vMatches)
+		{
+			printf("0x%08X\t%s\t%.0f%%\n", uHash, match.m_Name.c_str(), match.m_Precision * 100.0);
+		}
+
+		if (vMatches[0].m_Precision >= minPrecision && (vMatches.size() == 1 || vMatches[1].m_Precision < minPrecision))
+		{
+			vRecovered.push_back(vMatches[0].m_Name);
+		}
+	}
+
+	const unsigned int numWorkers = numThreads ? numThreads : std::max(1u, std::thread::hardware_concurrency());
+	const double numCandidates = static_cast<double>(recovery.GetNumCandidates());
+
+	fprintf(stderr, "%zu of %zu hashes matched, %zu likely, %.0f candidates in %.2f s (%.1f M/s per thread)\n",
+		mNames.size(), unknown.size(), vRecovered.size(), numCandidates, elapsed, numCandidates / std::max(elapsed, 1e-6) / numWorkers / 1e6);
+
+	if (bAppend && !vRecovered.empty())
+	{
+		std::ifstream check(argv[1], std::ios::binary | std::ios::ate);
+		bool bNeedsNewLine = false;
+		if (check && check.tellg() > 0)
+		{
+			check.seekg(-1, std::ios::end);
+			bNeedsNewLine = check.get() != '\n';
+		}
+		check.close();
+
+		std::ofstream output(argv[1], std::ios::binary | std::ios::app);
+		if (bNeedsNewLine)
+		{
+			output << '\n';
+		}
+
+		for (const std::string& szName : vRecovered)
+		{
+			output << szName << '\n';
+		}
+
+		if (!output.good())
+		{
+			printf("Error: Could not append to %s!\n", argv[1]);
+			return 1;
+		}
+		fprintf(stderr, "Appended %zu labels to %s\n", vRecovered.size(), argv[1]);
+	}
+	return 0;
+}
+
+gxt2recover& gxt2recover::GetInstance()
+{
+	static gxt2recover gxt2recover;
+	return gxt2recover;
+}
+
+int main(int argc, char* argv[])
+{
+	try
+	{
+		return gxt2recover::GetInstance().Run(argc, argv);
+	}
+	catch (const std::exception& ex)
+	{
+		printf("Error: %s\n", ex.what());
+		return 1;
+	}
+	catch (...)
+	{
+		printf("Unknown error occurred!\n");
+		return 1;
+	}
+}
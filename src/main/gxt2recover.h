@@ -0,0 +1,26 @@
+//
+//	main/gxt2recover.h
+//
+
+#ifndef _GXT2RECOVER_H_
+#define _GXT2RECOVER_H_
+
+// Project
+#include "gxt/recover.h"
+
+#include "system/app.h"
+
+class gxt2recover : public CApp
+{
+private:
+	gxt2recover() = default;
+	~gxt2recover() = default;
+public:
+	int Run(int argc, char* argv[]) override;
+public:
+	static gxt2recover& GetInstance();
+
+	static constexpr double DEFAULT_MIN_PRECISION = 0.95;
+};
+
+#endif // !_GXT2RECOVER_H_